@@ -0,0 +1,135 @@
+// Command wasmbench runs the C++ SDK microbenchmarks under wazero
+//
+// It loads bench/sdk_bench.wasm (make bench-wasm in examples/hellofs-wasm-cpp)
+// through the server's WASM plugin loader and prints JSON lines in the same
+// format as the native build:
+//
+//   - env "wasm": the module's own bench_run suite, timed inside the guest
+//   - env "wazero-host": fs_read/fs_write driven from Go through the
+//     plugin's FileSystem, including the host/guest boundary crossing;
+//     allocations are Go-side
+package main
+
+import (
+	"encoding/json"
+	"flag"
+	"fmt"
+	"os"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/api"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/loader"
+	log "github.com/sirupsen/logrus"
+)
+
+// benchResult mirrors one line of the SDK benchmark report
+type benchResult struct {
+	Name            string  `json:"name"`
+	Env             string  `json:"env"`
+	Iterations      int     `json:"iterations"`
+	NsPerOp         float64 `json:"ns_per_op"`
+	OpsPerSec       float64 `json:"ops_per_sec"`
+	AllocsPerOp     float64 `json:"allocs_per_op"`
+	AllocBytesPerOp float64 `json:"alloc_bytes_per_op"`
+	BytesPerOp      int64   `json:"bytes_per_op"`
+}
+
+func main() {
+	testing.Init()
+	wasmPath := flag.String("wasm", "examples/hellofs-wasm-cpp/bench/sdk_bench.wasm", "benchmark module")
+	filter := flag.String("filter", "", "run benchmarks whose name contains this substring")
+	minTimeMs := flag.Uint("min-time-ms", 200, "minimum run time of each benchmark in milliseconds")
+	flag.Parse()
+	flag.Set("test.benchtime", (time.Duration(*minTimeMs) * time.Millisecond).String())
+	log.SetLevel(log.WarnLevel)
+
+	if err := run(*wasmPath, *filter, uint32(*minTimeMs)); err != nil {
+		fmt.Fprintf(os.Stderr, "wasmbench: %v\n", err)
+		os.Exit(1)
+	}
+}
+
+func run(wasmPath, filter string, minTimeMs uint32) error {
+	p, err := loader.NewWASMPluginLoader().LoadWASMPlugin(wasmPath, api.PoolConfig{MaxInstances: 1})
+	if err != nil {
+		return err
+	}
+	defer p.Shutdown()
+
+	wp, ok := p.(*api.WASMPlugin)
+	if !ok {
+		return fmt.Errorf("%s did not load as a WASM plugin", wasmPath)
+	}
+	if err := wp.Initialize(map[string]interface{}{}); err != nil {
+		return fmt.Errorf("initialize: %w", err)
+	}
+
+	report, err := wp.RunBenchmarks(filter, minTimeMs)
+	if err != nil {
+		return err
+	}
+	os.Stdout.Write(report)
+
+	out := json.NewEncoder(os.Stdout)
+	for _, b := range hostBenchmarks(wp.GetFileSystem()) {
+		if filter != "" && !strings.Contains(b.name, filter) {
+			continue
+		}
+		res := testing.Benchmark(b.fn)
+		if res.N == 0 {
+			return fmt.Errorf("%s failed", b.name)
+		}
+		nsPerOp := float64(res.T.Nanoseconds()) / float64(res.N)
+		out.Encode(benchResult{
+			Name:            b.name,
+			Env:             "wazero-host",
+			Iterations:      res.N,
+			NsPerOp:         nsPerOp,
+			OpsPerSec:       1e9 / nsPerOp,
+			AllocsPerOp:     float64(res.MemAllocs) / float64(res.N),
+			AllocBytesPerOp: float64(res.MemBytes) / float64(res.N),
+			BytesPerOp:      res.Bytes,
+		})
+	}
+	return nil
+}
+
+type hostBenchmark struct {
+	name string
+	fn   func(b *testing.B)
+}
+
+func hostBenchmarks(fs filesystem.FileSystem) []hostBenchmark {
+	read := func(size int64) func(b *testing.B) {
+		return func(b *testing.B) {
+			b.ReportAllocs()
+			b.SetBytes(size)
+			for i := 0; i < b.N; i++ {
+				if _, err := fs.Read("/data", (int64(i)*size)%(128*1024), size); err != nil {
+					b.Fatal(err)
+				}
+			}
+		}
+	}
+	write := func(size int64) func(b *testing.B) {
+		data := make([]byte, size)
+		return func(b *testing.B) {
+			b.ReportAllocs()
+			b.SetBytes(size)
+			for i := 0; i < b.N; i++ {
+				if _, err := fs.Write("/data", data, (int64(i)*size)%(128*1024), filesystem.WriteFlagNone); err != nil {
+					b.Fatal(err)
+				}
+			}
+		}
+	}
+	return []hostBenchmark{
+		{"host/fs_read/4KB", read(4096)},
+		{"host/fs_read/64KB", read(65536)},
+		{"host/fs_write/4KB", write(4096)},
+		{"host/fs_write/64KB", write(65536)},
+	}
+}
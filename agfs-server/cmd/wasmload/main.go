@@ -0,0 +1,613 @@
+// Command wasmload drives a mixed filesystem workload against WASM plugins
+//
+// It mounts the filesystems of a test-config.yaml style file (make load in
+// examples/hellofs-wasm-cpp) in a MountableFS, fills a directory with files
+// of the requested sizes, then runs stat/readdir/read/write calls from
+// several goroutines for a fixed time. Results are JSON lines:
+//
+//   - env "go": per-op latency percentiles measured around the MountableFS call
+//   - env "plugin": the plugin's own per-op metrics over the run (modules
+//     built with -DAGFS_ENABLE_METRICS only)
+//   - env "pool": instance pool counters of every WASM mount
+//
+// With -trace, every PooledWASMFileSystem call is also written as a span
+// carrying the serving instance and the plugin metrics of that call alone.
+package main
+
+import (
+	"encoding/json"
+	"flag"
+	"fmt"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/mountablefs"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/api"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/loader"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugins/memfs"
+	log "github.com/sirupsen/logrus"
+	"gopkg.in/yaml.v3"
+)
+
+// loadConfig is the test-config.yaml layout
+type loadConfig struct {
+	Filesystems []struct {
+		Name   string                 `yaml:"name"`
+		Type   string                 `yaml:"type"` // wasm or memfs
+		Mount  string                 `yaml:"mount"`
+		Config map[string]interface{} `yaml:"config"`
+	} `yaml:"filesystems"`
+}
+
+// wasmMount is a mounted WASM plugin whose metrics and pool are reported
+type wasmMount struct {
+	name   string
+	plugin *api.WASMPlugin
+	start  *api.PluginMetrics // plugin metrics when the workload began
+}
+
+type weighted struct {
+	key    string
+	weight int
+}
+
+var workloadOps = []string{"stat", "readdir", "read", "write"}
+
+func main() {
+	configPath := flag.String("config", "examples/hellofs-wasm-cpp/load-config.yaml", "filesystems to mount")
+	dir := flag.String("dir", "/hellofs-cpp/host/load", "workload directory (created)")
+	mix := flag.String("mix", "stat=40,readdir=10,read=40,write=10", "op weights")
+	sizes := flag.String("sizes", "4KB=70,64KB=25,1MB=5", "file size weights")
+	files := flag.Int("files", 64, "number of files")
+	concurrency := flag.Int("concurrency", 8, "concurrent callers")
+	duration := flag.Duration("duration", 10*time.Second, "run time")
+	seed := flag.Int64("seed", 1, "random seed")
+	poolSize := flag.Int("pool-size", 8, "WASM instances per plugin")
+	maxRequests := flag.Int64("max-requests", 0, "requests per instance before it is recycled (0 = unlimited)")
+	maxLifetime := flag.Duration("max-lifetime", 0, "instance lifetime (0 = unlimited)")
+	tracePath := flag.String("trace", "", "write a JSON line per plugin call to this file")
+	flag.Parse()
+	log.SetLevel(log.WarnLevel)
+
+	poolConfig := api.PoolConfig{
+		MaxInstances:        *poolSize,
+		InstanceMaxRequests: *maxRequests,
+		InstanceMaxLifetime: *maxLifetime,
+		EnableStatistics:    true,
+	}
+	err := run(*configPath, poolConfig, *tracePath, workload{
+		dir:         filesystem.NormalizePath(*dir),
+		files:       *files,
+		concurrency: *concurrency,
+		duration:    *duration,
+		seed:        *seed,
+	}, *mix, *sizes)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "wasmload: %v\n", err)
+		os.Exit(1)
+	}
+}
+
+func run(configPath string, poolConfig api.PoolConfig, tracePath string, w workload, mix, sizes string) error {
+	var err error
+	if w.mix, err = parseWeights(mix); err != nil {
+		return fmt.Errorf("-mix: %w", err)
+	}
+	for _, m := range w.mix {
+		if !contains(workloadOps, m.key) {
+			return fmt.Errorf("-mix: unknown op %q (want one of %s)", m.key, strings.Join(workloadOps, ", "))
+		}
+	}
+	if w.sizes, err = parseWeights(sizes); err != nil {
+		return fmt.Errorf("-sizes: %w", err)
+	}
+	for _, s := range w.sizes {
+		if _, err := parseSize(s.key); err != nil {
+			return fmt.Errorf("-sizes: %w", err)
+		}
+	}
+	if w.files < 1 || w.concurrency < 1 {
+		return fmt.Errorf("-files and -concurrency must be positive")
+	}
+
+	mfs := mountablefs.NewMountableFS(poolConfig)
+	mounts, err := mountAll(mfs, configPath, poolConfig)
+	for _, m := range mounts {
+		defer m.plugin.Shutdown()
+	}
+	if err != nil {
+		return err
+	}
+
+	if err := w.setup(mfs); err != nil {
+		return fmt.Errorf("setup: %w", err)
+	}
+	for _, m := range mounts {
+		m.start = m.plugin.PluginMetrics()
+	}
+
+	if tracePath != "" {
+		f, err := os.Create(tracePath)
+		if err != nil {
+			return err
+		}
+		defer f.Close()
+		var mu sync.Mutex
+		enc := json.NewEncoder(f)
+		for _, m := range mounts {
+			name := m.name
+			m.plugin.SetTracer(func(s api.CallSpan) {
+				rec := newSpanRecord(name, s)
+				mu.Lock()
+				enc.Encode(rec)
+				mu.Unlock()
+			})
+		}
+		defer func() {
+			for _, m := range mounts {
+				m.plugin.SetTracer(nil)
+			}
+		}()
+	}
+
+	results := w.run(mfs)
+
+	out := json.NewEncoder(os.Stdout)
+	for _, op := range workloadOps {
+		if r := results[op]; r != nil {
+			out.Encode(r.report(op, w.duration))
+		}
+	}
+	for _, m := range mounts {
+		end := m.plugin.PluginMetrics()
+		if end == nil {
+			continue
+		}
+		delta := subtractMetrics(end, m.start)
+		for _, name := range delta.Names() {
+			op := delta.Ops[name]
+			if op.Count == 0 {
+				continue
+			}
+			out.Encode(pluginReport{
+				Op:        name,
+				Env:       "plugin",
+				Mount:     m.name,
+				Count:     op.Count,
+				MeanNs:    op.Mean().Nanoseconds(),
+				P50Ns:     op.Quantile(0.5).Nanoseconds(),
+				P90Ns:     op.Quantile(0.9).Nanoseconds(),
+				P99Ns:     op.Quantile(0.99).Nanoseconds(),
+				BytesIn:   op.BytesIn,
+				BytesOut:  op.BytesOut,
+				OpsPerSec: float64(op.Count) / w.duration.Seconds(),
+			})
+		}
+	}
+	for _, m := range mounts {
+		stats := m.plugin.PoolStats()
+		out.Encode(poolReport{
+			Env:            "pool",
+			Mount:          m.name,
+			TotalCreated:   stats.TotalCreated,
+			TotalDestroyed: stats.TotalDestroyed,
+			CurrentActive:  stats.CurrentActive,
+			TotalWaits:     stats.TotalWaits,
+			TotalRequests:  stats.TotalRequests,
+			FailedRequests: stats.FailedRequests,
+		})
+	}
+	return nil
+}
+
+// mountAll mounts every filesystem of the config file
+// wasm_path is resolved relative to the config file. Mounts made before an
+// error are returned so their plugins can be shut down.
+func mountAll(mfs *mountablefs.MountableFS, configPath string, poolConfig api.PoolConfig) ([]*wasmMount, error) {
+	data, err := os.ReadFile(configPath)
+	if err != nil {
+		return nil, err
+	}
+	var cfg loadConfig
+	if err := yaml.Unmarshal(data, &cfg); err != nil {
+		return nil, fmt.Errorf("%s: %w", configPath, err)
+	}
+	if len(cfg.Filesystems) == 0 {
+		return nil, fmt.Errorf("%s: no filesystems", configPath)
+	}
+
+	var mounts []*wasmMount
+	wasmLoader := loader.NewWASMPluginLoader()
+	for _, fs := range cfg.Filesystems {
+		mountPath := filesystem.NormalizePath(fs.Mount)
+		pluginConfig := map[string]interface{}{"mount_path": mountPath}
+		for k, v := range fs.Config {
+			pluginConfig[k] = v
+		}
+
+		var p plugin.ServicePlugin
+		switch fs.Type {
+		case "memfs":
+			p = memfs.NewMemFSPlugin()
+		case "wasm":
+			wasmPath, _ := pluginConfig["wasm_path"].(string)
+			if wasmPath == "" {
+				return mounts, fmt.Errorf("%s: wasm_path is required", fs.Name)
+			}
+			delete(pluginConfig, "wasm_path")
+			if !filepath.IsAbs(wasmPath) {
+				wasmPath = filepath.Join(filepath.Dir(configPath), wasmPath)
+			}
+			loaded, err := wasmLoader.LoadWASMPlugin(wasmPath, poolConfig, mfs)
+			if err != nil {
+				return mounts, fmt.Errorf("%s: %w", fs.Name, err)
+			}
+			wp, ok := loaded.(*api.WASMPlugin)
+			if !ok {
+				loaded.Shutdown()
+				return mounts, fmt.Errorf("%s did not load as a WASM plugin", wasmPath)
+			}
+			mounts = append(mounts, &wasmMount{name: fs.Name, plugin: wp})
+			p = wp
+		default:
+			return mounts, fmt.Errorf("%s: unsupported type %q (want wasm or memfs)", fs.Name, fs.Type)
+		}
+
+		if err := p.Validate(pluginConfig); err != nil {
+			return mounts, fmt.Errorf("%s: validate: %w", fs.Name, err)
+		}
+		if err := p.Initialize(pluginConfig); err != nil {
+			return mounts, fmt.Errorf("%s: initialize: %w", fs.Name, err)
+		}
+		if err := mfs.Mount(mountPath, p); err != nil {
+			return mounts, fmt.Errorf("%s: mount %s: %w", fs.Name, mountPath, err)
+		}
+	}
+	return mounts, nil
+}
+
+// workload is one run's shape: which files exist and what is done to them
+type workload struct {
+	dir         string
+	files       int
+	concurrency int
+	duration    time.Duration
+	seed        int64
+	mix         []weighted
+	sizes       []weighted
+
+	paths     []string
+	fileSizes []int64
+}
+
+// setup creates dir and writes every file at its drawn size
+func (w *workload) setup(fs filesystem.FileSystem) error {
+	if err := fs.Mkdir(w.dir, 0755); err != nil {
+		if _, statErr := fs.Stat(w.dir); statErr != nil {
+			return err
+		}
+	}
+	rng := rand.New(rand.NewSource(w.seed))
+	var largest int64
+	for i := 0; i < w.files; i++ {
+		size, _ := parseSize(pick(rng, w.sizes))
+		w.paths = append(w.paths, fmt.Sprintf("%s/f%05d", w.dir, i))
+		w.fileSizes = append(w.fileSizes, size)
+		if size > largest {
+			largest = size
+		}
+	}
+	data := make([]byte, largest)
+	rng.Read(data)
+	for i, path := range w.paths {
+		if _, err := fs.Write(path, data[:w.fileSizes[i]], 0, filesystem.WriteFlagCreate|filesystem.WriteFlagTruncate); err != nil {
+			return fmt.Errorf("write %s: %w", path, err)
+		}
+	}
+	return nil
+}
+
+// opResult collects one op's latencies
+type opResult struct {
+	latencies []time.Duration
+	errors    int64
+	firstErr  error
+}
+
+func (r *opResult) add(other *opResult) {
+	r.latencies = append(r.latencies, other.latencies...)
+	r.errors += other.errors
+	if r.firstErr == nil {
+		r.firstErr = other.firstErr
+	}
+}
+
+// run calls fs from w.concurrency goroutines until w.duration has passed
+func (w *workload) run(fs filesystem.FileSystem) map[string]*opResult {
+	var largest int64
+	for _, size := range w.fileSizes {
+		if size > largest {
+			largest = size
+		}
+	}
+	deadline := time.Now().Add(w.duration)
+
+	perWorker := make([]map[string]*opResult, w.concurrency)
+	var wg sync.WaitGroup
+	for i := 0; i < w.concurrency; i++ {
+		wg.Add(1)
+		go func(i int) {
+			defer wg.Done()
+			rng := rand.New(rand.NewSource(w.seed + int64(i) + 1))
+			data := make([]byte, largest)
+			results := make(map[string]*opResult)
+			for time.Now().Before(deadline) {
+				op := pick(rng, w.mix)
+				file := rng.Intn(len(w.paths))
+				path, size := w.paths[file], w.fileSizes[file]
+
+				start := time.Now()
+				var err error
+				switch op {
+				case "stat":
+					_, err = fs.Stat(path)
+				case "readdir":
+					_, err = fs.ReadDir(w.dir)
+				case "read":
+					_, err = fs.Read(path, 0, size)
+				case "write":
+					_, err = fs.Write(path, data[:size], 0, filesystem.WriteFlagNone)
+				}
+				elapsed := time.Since(start)
+
+				r := results[op]
+				if r == nil {
+					r = &opResult{}
+					results[op] = r
+				}
+				r.latencies = append(r.latencies, elapsed)
+				if err != nil {
+					r.errors++
+					if r.firstErr == nil {
+						r.firstErr = fmt.Errorf("%s %s: %w", op, path, err)
+					}
+				}
+			}
+			perWorker[i] = results
+		}(i)
+	}
+	wg.Wait()
+
+	merged := make(map[string]*opResult)
+	for _, results := range perWorker {
+		for op, r := range results {
+			if merged[op] == nil {
+				merged[op] = &opResult{}
+			}
+			merged[op].add(r)
+		}
+	}
+	return merged
+}
+
+// opReport is one "go" line of the output
+type opReport struct {
+	Op        string  `json:"op"`
+	Env       string  `json:"env"`
+	Count     int     `json:"count"`
+	Errors    int64   `json:"errors"`
+	FirstErr  string  `json:"first_error,omitempty"`
+	OpsPerSec float64 `json:"ops_per_sec"`
+	MeanNs    int64   `json:"mean_ns"`
+	P50Ns     int64   `json:"p50_ns"`
+	P90Ns     int64   `json:"p90_ns"`
+	P99Ns     int64   `json:"p99_ns"`
+	P999Ns    int64   `json:"p999_ns"`
+	MaxNs     int64   `json:"max_ns"`
+}
+
+func (r *opResult) report(op string, duration time.Duration) opReport {
+	sort.Slice(r.latencies, func(i, j int) bool { return r.latencies[i] < r.latencies[j] })
+	var total time.Duration
+	for _, d := range r.latencies {
+		total += d
+	}
+	rep := opReport{
+		Op:        op,
+		Env:       "go",
+		Count:     len(r.latencies),
+		Errors:    r.errors,
+		OpsPerSec: float64(len(r.latencies)) / duration.Seconds(),
+		P50Ns:     percentile(r.latencies, 0.5).Nanoseconds(),
+		P90Ns:     percentile(r.latencies, 0.9).Nanoseconds(),
+		P99Ns:     percentile(r.latencies, 0.99).Nanoseconds(),
+		P999Ns:    percentile(r.latencies, 0.999).Nanoseconds(),
+		MaxNs:     percentile(r.latencies, 1).Nanoseconds(),
+	}
+	if len(r.latencies) > 0 {
+		rep.MeanNs = (total / time.Duration(len(r.latencies))).Nanoseconds()
+	}
+	if r.firstErr != nil {
+		rep.FirstErr = r.firstErr.Error()
+	}
+	return rep
+}
+
+// percentile returns the nearest-rank q-th value of sorted
+func percentile(sorted []time.Duration, q float64) time.Duration {
+	if len(sorted) == 0 {
+		return 0
+	}
+	return sorted[int(q*float64(len(sorted)-1))]
+}
+
+// pluginReport is one "plugin" line of the output
+type pluginReport struct {
+	Op        string  `json:"op"`
+	Env       string  `json:"env"`
+	Mount     string  `json:"mount"`
+	Count     uint64  `json:"count"`
+	OpsPerSec float64 `json:"ops_per_sec"`
+	MeanNs    int64   `json:"mean_ns"`
+	P50Ns     int64   `json:"p50_ns"`
+	P90Ns     int64   `json:"p90_ns"`
+	P99Ns     int64   `json:"p99_ns"`
+	BytesIn   uint64  `json:"bytes_in"`
+	BytesOut  uint64  `json:"bytes_out"`
+}
+
+// poolReport is one "pool" line of the output
+type poolReport struct {
+	Env            string `json:"env"`
+	Mount          string `json:"mount"`
+	TotalCreated   int64  `json:"total_created"`
+	TotalDestroyed int64  `json:"total_destroyed"`
+	CurrentActive  int64  `json:"current_active"`
+	TotalWaits     int64  `json:"total_waits"`
+	TotalRequests  int64  `json:"total_requests"`
+	FailedRequests int64  `json:"failed_requests"`
+}
+
+// spanRecord is one line of the -trace file
+type spanRecord struct {
+	Mount      string                `json:"mount"`
+	Op         string                `json:"op"`
+	Path       string                `json:"path"`
+	Instance   uint64                `json:"instance"`
+	StartNs    int64                 `json:"start_unix_ns"`
+	WaitNs     int64                 `json:"wait_ns"`
+	DurationNs int64                 `json:"duration_ns"`
+	Err        string                `json:"error,omitempty"`
+	Plugin     map[string]spanPlugin `json:"plugin,omitempty"`
+}
+
+// spanPlugin is one plugin-side operation inside a span
+type spanPlugin struct {
+	Count   uint64 `json:"count"`
+	TotalNs uint64 `json:"total_ns"`
+}
+
+func newSpanRecord(mount string, s api.CallSpan) spanRecord {
+	rec := spanRecord{
+		Mount:      mount,
+		Op:         s.Op,
+		Path:       s.Path,
+		Instance:   s.Instance,
+		StartNs:    s.Start.UnixNano(),
+		WaitNs:     s.Wait.Nanoseconds(),
+		DurationNs: s.Duration.Nanoseconds(),
+	}
+	if s.Err != nil {
+		rec.Err = s.Err.Error()
+	}
+	if s.Plugin != nil && len(s.Plugin.Ops) > 0 {
+		rec.Plugin = make(map[string]spanPlugin, len(s.Plugin.Ops))
+		for name, op := range s.Plugin.Ops {
+			rec.Plugin[name] = spanPlugin{Count: op.Count, TotalNs: op.TotalNanos}
+		}
+	}
+	return rec
+}
+
+// subtractMetrics returns end minus start, both cumulative plugin metrics
+func subtractMetrics(end, start *api.PluginMetrics) *api.PluginMetrics {
+	delta := end.Clone()
+	if start == nil {
+		return delta
+	}
+	for name, before := range start.Ops {
+		op, ok := delta.Ops[name]
+		if !ok {
+			continue
+		}
+		op.Count -= before.Count
+		op.TotalNanos -= before.TotalNanos
+		op.BytesIn -= before.BytesIn
+		op.BytesOut -= before.BytesOut
+		for i, n := range before.Buckets {
+			if i < len(op.Buckets) {
+				op.Buckets[i] -= n
+			}
+		}
+	}
+	return delta
+}
+
+// parseWeights parses "key=weight,key=weight"
+func parseWeights(s string) ([]weighted, error) {
+	var out []weighted
+	total := 0
+	for _, part := range strings.Split(s, ",") {
+		part = strings.TrimSpace(part)
+		if part == "" {
+			continue
+		}
+		key, value, ok := strings.Cut(part, "=")
+		weight, err := strconv.Atoi(value)
+		if !ok || err != nil || weight < 0 {
+			return nil, fmt.Errorf("bad entry %q (want key=weight)", part)
+		}
+		if weight > 0 {
+			out = append(out, weighted{key: strings.TrimSpace(key), weight: weight})
+			total += weight
+		}
+	}
+	if total == 0 {
+		return nil, fmt.Errorf("no positive weights in %q", s)
+	}
+	return out, nil
+}
+
+// pick draws a key with probability proportional to its weight
+func pick(rng *rand.Rand, choices []weighted) string {
+	total := 0
+	for _, c := range choices {
+		total += c.weight
+	}
+	n := rng.Intn(total)
+	for _, c := range choices {
+		if n < c.weight {
+			return c.key
+		}
+		n -= c.weight
+	}
+	return choices[len(choices)-1].key
+}
+
+// parseSize parses a byte count with an optional B/KB/MB/GB suffix (powers of 1024)
+func parseSize(s string) (int64, error) {
+	upper := strings.ToUpper(strings.TrimSpace(s))
+	mult := int64(1)
+	for _, unit := range []struct {
+		suffix string
+		mult   int64
+	}{{"GB", 1 << 30}, {"MB", 1 << 20}, {"KB", 1 << 10}, {"B", 1}} {
+		if strings.HasSuffix(upper, unit.suffix) {
+			upper = strings.TrimSuffix(upper, unit.suffix)
+			mult = unit.mult
+			break
+		}
+	}
+	n, err := strconv.ParseInt(upper, 10, 64)
+	if err != nil || n < 0 {
+		return 0, fmt.Errorf("bad size %q", s)
+	}
+	return n * mult, nil
+}
+
+func contains(list []string, s string) bool {
+	for _, v := range list {
+		if v == s {
+			return true
+		}
+	}
+	return false
+}
@@ -214,11 +214,17 @@ impl HostFS {
     }
 }
 
+/// Error pointer the host returns when it could not write the message itself
+const HOST_ERROR_NO_MESSAGE: u32 = 1;
+
 /// Read a null-terminated string from a pointer
 unsafe fn read_string_from_ptr(ptr: u32) -> String {
     if ptr == 0 {
         return String::new();
     }
+    if ptr == HOST_ERROR_NO_MESSAGE {
+        return "host error (message unavailable)".to_string();
+    }
 
     // Find the null terminator
     let mut len = 0;
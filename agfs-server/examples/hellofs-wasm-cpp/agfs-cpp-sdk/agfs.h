@@ -9,7 +9,20 @@
 // Features:
 // - Type-safe C++ API
 // - Easy-to-use FileSystem base class
-// - Host filesystem access via HostFS
+// - Host filesystem access via HostFS, with resident mapped regions via HostFS::map
+// - Optional stateful file handles via HandleFileSystem
+// - Per-call scratch arena via call_arena()
+// - Zero-copy string_view/Span arguments via FileSystemV2
+// - stat/readdir caching via MetadataCached
+// - Block cache with read-ahead via BlockCache
+// - Write-back buffering of small appends via WriteBackBuffered
+// - Multi-mount plugins routed through a path trie via RoutedFS/PathRouter
+// - Deduplicated, compressed chunk storage via ChunkedStoreFS
+// - DOM-free JSON codecs for FileInfo/Config via JsonCodec
+// - Typed config schema with plugin_get_config_params via ConfigSchema
+// - Initialization snapshots shared across instances via export_state()
+// - wasm simd128 base64 and JSON string kernels (build-em-simd/build-wasi-simd)
+// - Threaded builds over one shared memory (build-wasi-threads, AGFS_THREADS)
 // - Automatic FFI handling
 // - Simple export macro
 //
@@ -51,10 +64,28 @@
 //
 
 #include "agfs_types.h"
+#include "agfs_simd.h"
+#include "agfs_json.h"
+#include "agfs_base64.h"
 #include "agfs_ffi.h"
+#include "agfs_hostbuffer.h"
+#include "agfs_sync.h"
+#include "agfs_arena.h"
+#include "agfs_metrics.h"
+#include "agfs_state.h"
+#include "agfs_config.h"
 #include "agfs_hostfs.h"
 #include "agfs_http.h"
 #include "agfs_filesystem.h"
+#include "agfs_filesystem_v2.h"
+#include "agfs_handlefs.h"
+#include "agfs_metacache.h"
+#include "agfs_blockcache.h"
+#include "agfs_writeback.h"
+#include "agfs_router.h"
+#include "agfs_lz.h"
+#include "agfs_sha256.h"
+#include "agfs_chunkstore.h"
 #include "agfs_export.h"
 
 #endif // AGFS_H
@@ -0,0 +1,168 @@
+#ifndef AGFS_ARENA_H
+#define AGFS_ARENA_H
+
+#include "agfs_sync.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+
+namespace agfs {
+
+// CallArena is a bump allocator for scratch memory that only lives for one
+// exported call. Allocation is a pointer bump, deallocation is a no-op, and
+// reset() rewinds every chunk without returning it to malloc, so a plugin
+// that runs the same operations repeatedly settles at a fixed footprint.
+//
+// It is a std::pmr::memory_resource, so it plugs into pmr containers:
+//
+//   std::pmr::vector<agfs::FileInfo> tmp(&agfs::call_arena());
+//   std::pmr::string key(path, &agfs::call_arena());
+//
+// Anything handed back to the host must still use wasm_malloc.
+class CallArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 16384; // 16KB
+
+    explicit CallArena(size_t chunk_size = DEFAULT_CHUNK_SIZE)
+        : head_(nullptr), current_(nullptr), chunk_size_(chunk_size) {}
+
+    ~CallArena() override {
+        Chunk* chunk = head_;
+        while (chunk) {
+            Chunk* next = chunk->next;
+            std::free(chunk);
+            chunk = next;
+        }
+    }
+
+    CallArena(const CallArena&) = delete;
+    CallArena& operator=(const CallArena&) = delete;
+
+    // Rewind all chunks; memory handed out since the last reset becomes invalid
+    void reset() {
+        for (Chunk* chunk = head_; chunk; chunk = chunk->next) {
+            chunk->used = 0;
+        }
+        current_ = head_;
+    }
+
+    // Bytes currently handed out (including alignment padding)
+    size_t bytes_used() const {
+        size_t total = 0;
+        for (Chunk* chunk = head_; chunk; chunk = chunk->next) {
+            total += chunk->used;
+        }
+        return total;
+    }
+
+    // Bytes reserved from malloc across all chunks
+    size_t capacity() const {
+        size_t total = 0;
+        for (Chunk* chunk = head_; chunk; chunk = chunk->next) {
+            total += chunk->capacity;
+        }
+        return total;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // Try the current chunk, then any later chunk kept from earlier calls
+        for (Chunk* chunk = current_; chunk; chunk = chunk->next) {
+            void* ptr = chunk->take(bytes, alignment);
+            if (ptr) {
+                current_ = chunk;
+                return ptr;
+            }
+        }
+
+        size_t capacity = bytes + alignment > chunk_size_ ? bytes + alignment : chunk_size_;
+        Chunk* chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + capacity));
+        if (!chunk) {
+            // Built without exceptions, so we can't throw std::bad_alloc
+            __builtin_trap();
+        }
+        chunk->next = nullptr;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+
+        // Append so that reset() walks chunks in allocation order
+        if (!head_) {
+            head_ = chunk;
+        } else {
+            Chunk* tail = current_ ? current_ : head_;
+            while (tail->next) tail = tail->next;
+            tail->next = chunk;
+        }
+        current_ = chunk;
+        return chunk->take(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        (void)ptr; (void)bytes; (void)alignment; // released by reset()
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t capacity;
+        size_t used;
+
+        uint8_t* base() { return reinterpret_cast<uint8_t*>(this + 1); }
+
+        void* take(size_t bytes, size_t alignment) {
+            uintptr_t start = reinterpret_cast<uintptr_t>(base()) + used;
+            uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            size_t end = (aligned - reinterpret_cast<uintptr_t>(base())) + bytes;
+            if (end > capacity) {
+                return nullptr;
+            }
+            used = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+    };
+
+    Chunk* head_;
+    Chunk* current_;
+    size_t chunk_size_;
+};
+
+namespace internal {
+
+inline int& call_arena_depth() {
+    static AGFS_THREAD_LOCAL int depth = 0;
+    return depth;
+}
+
+} // namespace internal
+
+// Arena for temporaries within the current exported call
+// Reset when the outermost fs_*/handle_* export returns. Each worker of a
+// threaded build has its own.
+inline CallArena& call_arena() {
+    static AGFS_THREAD_LOCAL CallArena arena;
+    return arena;
+}
+
+// Marks the extent of an exported call (used by the export macros)
+// Scopes nest; only the outermost one resets the arena.
+class CallArenaScope {
+public:
+    CallArenaScope() { internal::call_arena_depth()++; }
+    ~CallArenaScope() {
+        if (--internal::call_arena_depth() == 0) {
+            call_arena().reset();
+        }
+    }
+
+    CallArenaScope(const CallArenaScope&) = delete;
+    CallArenaScope& operator=(const CallArenaScope&) = delete;
+};
+
+} // namespace agfs
+
+#endif // AGFS_ARENA_H
@@ -0,0 +1,208 @@
+#ifndef AGFS_BASE64_H
+#define AGFS_BASE64_H
+
+#include "agfs_types.h"
+#include "agfs_simd.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+// Standard base64 (RFC 4648, '+' and '/', '=' padding)
+// With simd128 both directions work on 16-character / 12-byte blocks and
+// fall back to the scalar loop for the tail and for anything unusual.
+class Base64 {
+public:
+    static size_t encoded_size(size_t len) {
+        return (len + 2) / 3 * 4;
+    }
+
+    static std::string encode(Span<const uint8_t> data) {
+        static const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const uint8_t* in = data.data();
+        size_t len = data.size();
+
+        std::string out;
+        out.resize(encoded_size(len));
+        char* dst = &out[0];
+        size_t i = 0;
+#ifdef AGFS_SIMD128
+        // Each block loads 16 bytes, so stop while 4 more are readable
+        for (; i + 16 <= len; i += 12, dst += 16) {
+            wasm_v128_store(dst, encode_block(wasm_v128_load(in + i)));
+        }
+#endif
+        for (; i + 3 <= len; i += 3) {
+            uint32_t v = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+            *dst++ = alphabet[v >> 18];
+            *dst++ = alphabet[(v >> 12) & 63];
+            *dst++ = alphabet[(v >> 6) & 63];
+            *dst++ = alphabet[v & 63];
+        }
+        if (i < len) {
+            uint32_t v = (uint32_t)in[i] << 16;
+            if (i + 1 < len) {
+                v |= (uint32_t)in[i + 1] << 8;
+            }
+            *dst++ = alphabet[v >> 18];
+            *dst++ = alphabet[(v >> 12) & 63];
+            *dst++ = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+            *dst++ = '=';
+        }
+        return out;
+    }
+
+    // Decoding stops at the first '=' and skips characters outside the
+    // alphabet (such as line breaks), so wrapped input decodes as well
+    static std::vector<uint8_t> decode(std::string_view input) {
+        std::vector<uint8_t> output;
+        if (input.empty()) {
+            return output;
+        }
+        // +16 leaves room for the 16-byte vector stores
+        output.resize(input.size() / 4 * 3 + 3 + 16);
+        uint8_t* dst = output.data();
+        const char* src = input.data();
+        size_t len = input.size();
+        size_t i = 0;
+#ifdef AGFS_SIMD128
+        for (; i + 16 <= len; i += 16, dst += 12) {
+            v128_t values;
+            if (!decode_values(wasm_v128_load(src + i), values)) {
+                break;
+            }
+            wasm_v128_store(dst, pack_block(values));
+        }
+#endif
+        // Whole quads of alphabet characters, then a bit-at-a-time loop for
+        // padding, skipped characters and the tail
+        const uint8_t* table = decode_table();
+        for (; i + 4 <= len; i += 4, dst += 3) {
+            uint8_t a = table[(unsigned char)src[i]];
+            uint8_t b = table[(unsigned char)src[i + 1]];
+            uint8_t c = table[(unsigned char)src[i + 2]];
+            uint8_t d = table[(unsigned char)src[i + 3]];
+            if ((a | b | c | d) & 0x80) {
+                break;
+            }
+            uint32_t v = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | d;
+            dst[0] = (uint8_t)(v >> 16);
+            dst[1] = (uint8_t)(v >> 8);
+            dst[2] = (uint8_t)v;
+        }
+        uint32_t buf = 0;
+        int bits = 0;
+        for (; i < len; i++) {
+            unsigned char c = (unsigned char)src[i];
+            if (c == '=') break;
+            uint8_t v = table[c];
+            if (v == 255) continue;
+
+            buf = (buf << 6) | v;
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                *dst++ = (uint8_t)(buf >> bits);
+                buf &= (1u << bits) - 1;
+            }
+        }
+        output.resize(dst - output.data());
+        return output;
+    }
+
+private:
+    // 6-bit value of each byte, 255 for bytes outside the alphabet
+    static const uint8_t* decode_table() {
+        static const uint8_t table[256] = {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+            52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 255, 255, 255,
+            255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+            15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+            255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+            41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        };
+        return table;
+    }
+
+#ifdef AGFS_SIMD128
+    // 12 input bytes (of 16 loaded) -> 16 ASCII characters
+    static v128_t encode_block(v128_t in) {
+        // Lane k holds bytes 3k..3k+2 as the 24-bit big-endian value s0:s1:s2
+        v128_t v = wasm_i8x16_swizzle(in, wasm_i8x16_make(
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+        const v128_t mask6 = wasm_i32x4_splat(63);
+        v128_t idx = wasm_v128_or(
+            wasm_v128_or(wasm_v128_and(wasm_u32x4_shr(v, 18), mask6),
+                         wasm_i32x4_shl(wasm_v128_and(wasm_u32x4_shr(v, 12), mask6), 8)),
+            wasm_v128_or(wasm_i32x4_shl(wasm_v128_and(wasm_u32x4_shr(v, 6), mask6), 16),
+                         wasm_i32x4_shl(wasm_v128_and(v, mask6), 24)));
+
+        // Map 0..63 to ASCII by adding a per-range offset:
+        // 0..25 -> 'A', 26..51 -> 'a', 52..61 -> '0', 62 -> '+', 63 -> '/'
+        v128_t range = wasm_u8x16_sub_sat(idx, wasm_i8x16_splat(51));
+        range = wasm_v128_bitselect(wasm_i8x16_splat(13), range,
+                                    wasm_u8x16_lt(idx, wasm_i8x16_splat(26)));
+        v128_t offsets = wasm_i8x16_make(
+            71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 65, 0, 0);
+        return wasm_i8x16_add(idx, wasm_i8x16_swizzle(offsets, range));
+    }
+
+    // Translate 16 characters to 6-bit values
+    // Returns false if any of them is outside the alphabet (including '=').
+    static bool decode_values(v128_t in, v128_t& values) {
+        const v128_t lo_mask = wasm_i8x16_splat(0x0F);
+        v128_t hi = wasm_v128_and(wasm_u8x16_shr(in, 4), lo_mask);
+        v128_t lo = wasm_v128_and(in, lo_mask);
+
+        // Invalid characters have a bit in common between the two nibble classes
+        const v128_t lut_lo = wasm_i8x16_make(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const v128_t lut_hi = wasm_i8x16_make(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        v128_t invalid = wasm_v128_and(wasm_i8x16_swizzle(lut_lo, lo), wasm_i8x16_swizzle(lut_hi, hi));
+        if (wasm_v128_any_true(invalid)) {
+            return false;
+        }
+
+        // Offset by high nibble, with '/' (0x2F) moved to its own slot
+        const v128_t lut_roll = wasm_i8x16_make(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        v128_t slot = wasm_i8x16_add(hi, wasm_i8x16_eq(in, wasm_i8x16_splat(0x2F)));
+        values = wasm_i8x16_add(in, wasm_i8x16_swizzle(lut_roll, slot));
+        return true;
+    }
+
+    // 16 six-bit values -> 12 bytes (in the low lanes)
+    static v128_t pack_block(v128_t values) {
+        // Pairs of values -> 12 bits per 16-bit lane
+        v128_t pairs = wasm_v128_or(
+            wasm_i16x8_shl(wasm_v128_and(values, wasm_i16x8_splat(0x00FF)), 6),
+            wasm_u16x8_shr(values, 8));
+        // Pairs of 12-bit lanes -> 24 bits per 32-bit lane
+        v128_t words = wasm_v128_or(
+            wasm_i32x4_shl(wasm_v128_and(pairs, wasm_i32x4_splat(0xFFFF)), 12),
+            wasm_u32x4_shr(pairs, 16));
+        return wasm_i8x16_swizzle(words, wasm_i8x16_make(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    }
+#endif
+};
+
+} // namespace agfs
+
+#endif // AGFS_BASE64_H
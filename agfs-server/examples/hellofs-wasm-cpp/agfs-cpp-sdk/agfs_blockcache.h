@@ -0,0 +1,392 @@
+#ifndef AGFS_BLOCKCACHE_H
+#define AGFS_BLOCKCACHE_H
+
+#include "agfs_types.h"
+#include "agfs_hostfs.h"
+#include "agfs_http.h"
+#include "agfs_sync.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace agfs {
+
+// BlockCache caches file contents in fixed-size, block-aligned pieces
+// Reads are served from cached blocks; misses go to a source callable
+//
+//   Result<int64_t> source(std::string_view path, int64_t offset, Span<uint8_t> buf)
+//
+// which fills buf from offset and returns the number of bytes stored (short
+// only at end of file). HostFSBlockSource and HttpRangeBlockSource cover the
+// common backends. When a file is read sequentially, a miss fetches the next
+// readahead blocks in the same source call.
+//
+// Frames are allocated on the first miss and evicted with the CLOCK policy;
+// read-ahead blocks that are never used go first. A single-block miss is read
+// straight into its frame. Read-ahead lands in a staging buffer first and is
+// copied into the frames it takes; that buffer comes out of the budget, so the
+// cache never holds more than budget bytes. In threaded builds each
+// call holds the cache lock, misses included, so workers never fetch the
+// same block twice.
+class BlockCache {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;       // 64KB
+    static constexpr size_t DEFAULT_BUDGET = 8 * 1024 * 1024;     // 8MB
+    static constexpr size_t DEFAULT_READAHEAD = 4;                // blocks
+
+    explicit BlockCache(size_t budget = DEFAULT_BUDGET, size_t block_size = DEFAULT_BLOCK_SIZE,
+                        size_t readahead = DEFAULT_READAHEAD)
+        : budget_(budget), block_size_(block_size), readahead_(readahead) {}
+
+    // Apply block_cache_size (bytes), block_cache_block_size (bytes) and
+    // block_cache_readahead (blocks) from config
+    // Drops everything cached so far.
+    void configure(const Config& config) {
+        int64_t budget = config.get_i64("block_cache_size", (int64_t)budget_);
+        int64_t block_size = config.get_i64("block_cache_block_size", (int64_t)block_size_);
+        int64_t readahead = config.get_i64("block_cache_readahead", (int64_t)readahead_);
+        budget_ = budget > 0 ? (size_t)budget : 0;
+        block_size_ = block_size > 0 ? (size_t)block_size : DEFAULT_BLOCK_SIZE;
+        readahead_ = readahead > 0 ? (size_t)readahead : 0;
+        clear();
+    }
+
+    // Cache is off when the budget is smaller than one block
+    bool enabled() const {
+        return budget_ >= block_size_;
+    }
+
+    // Read into buf starting at offset, filling misses through source
+    // Returns: Number of bytes stored in buf (short only at end of file)
+    template<typename Source>
+    Result<int64_t> read(std::string_view path, int64_t offset, Span<uint8_t> buf, Source&& source) {
+        if (offset < 0) {
+            return Error::invalid_input("negative offset");
+        }
+        if (!enabled()) {
+            return source(path, offset, buf);
+        }
+        internal::LockGuard lock(mu_);
+        if (frames_.empty()) {
+            allocate_frames();
+        }
+
+        FileState& file = file_state(path);
+        bool sequential = offset == file.next_offset && offset > 0;
+        size_t done = 0;
+        while (done < buf.size()) {
+            int64_t pos = offset + (int64_t)done;
+            int64_t block = pos / (int64_t)block_size_;
+            size_t in_block = (size_t)(pos % (int64_t)block_size_);
+
+            uint32_t frame = find(file.id, block);
+            if (frame != NONE) {
+                hits_++;
+            } else {
+                if (file.eof_block >= 0 && block > file.eof_block) {
+                    break;
+                }
+                auto fetched = fill(file, path, block, sequential ? 1 + readahead_ : 1, source);
+                if (fetched.is_err()) {
+                    if (done > 0) {
+                        break; // return what was read before the failure
+                    }
+                    return fetched.unwrap_err();
+                }
+                frame = find(file.id, block);
+                if (frame == NONE) {
+                    break; // block starts at or past end of file
+                }
+            }
+
+            Frame& f = frames_[frame];
+            f.referenced = true;
+            if (f.length <= in_block) {
+                break;
+            }
+            size_t n = f.length - in_block;
+            if (n > buf.size() - done) {
+                n = buf.size() - done;
+            }
+            std::memcpy(buf.data() + done, block_data(frame) + in_block, n);
+            done += n;
+            if (f.length < block_size_) {
+                break; // last block of the file
+            }
+        }
+
+        file.next_offset = offset + (int64_t)done;
+        return (int64_t)done;
+    }
+
+    // Drop every cached block of path (call after writing to it)
+    void invalidate(std::string_view path) {
+        internal::LockGuard lock(mu_);
+        auto it = files_.find(path);
+        if (it == files_.end()) {
+            return;
+        }
+        uint32_t id = it->second.id;
+        for (uint32_t i = 0; i < frames_.size(); i++) {
+            if (frames_[i].in_use && frames_[i].file_id == id) {
+                release(i);
+            }
+        }
+        files_.erase(it);
+    }
+
+    void clear() {
+        internal::LockGuard lock(mu_);
+        frames_.clear();
+        frames_.shrink_to_fit();
+        data_.clear();
+        data_.shrink_to_fit();
+        staging_.clear();
+        staging_.shrink_to_fit();
+        index_.clear();
+        files_.clear();
+        hand_ = 0;
+    }
+
+    size_t block_size() const { return block_size_; }
+    size_t budget() const { return budget_; }
+    size_t readahead() const { return readahead_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+    uint64_t source_calls() const { return source_calls_; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Frame {
+        uint32_t file_id = 0;
+        int64_t block = 0;
+        size_t length = 0;
+        bool in_use = false;
+        bool referenced = false;
+    };
+
+    struct FileState {
+        uint32_t id = 0;
+        int64_t next_offset = 0; // where a sequential reader would continue
+        int64_t eof_block = -1;  // last block of the file, once a short read was seen
+    };
+
+    static uint64_t block_key(uint32_t file_id, int64_t block) {
+        return ((uint64_t)file_id << 40) ^ (uint64_t)block;
+    }
+
+    // Split the budget between frames and the read-ahead staging buffer
+    // Staging gets at most a third of the blocks, and none when that is
+    // less than two (read-ahead is then off).
+    void allocate_frames() {
+        size_t total = budget_ / block_size_;
+        size_t staging = readahead_ > 0 ? 1 + readahead_ : 0;
+        if (staging > total / 3) {
+            staging = total / 3;
+        }
+        if (staging < 2) {
+            staging = 0;
+        }
+        size_t count = total - staging;
+        frames_.assign(count, Frame());
+        data_.assign(count * block_size_, 0);
+        staging_.assign(staging * block_size_, 0);
+        index_.reserve(count);
+    }
+
+    uint8_t* block_data(uint32_t frame) {
+        return data_.data() + (size_t)frame * block_size_;
+    }
+
+    FileState& file_state(std::string_view path) {
+        auto it = files_.find(path);
+        if (it == files_.end()) {
+            FileState state;
+            state.id = ++next_file_id_;
+            it = files_.emplace(std::string(path), state).first;
+        }
+        return it->second;
+    }
+
+    uint32_t find(uint32_t file_id, int64_t block) {
+        auto it = index_.find(block_key(file_id, block));
+        if (it == index_.end()) {
+            return NONE;
+        }
+        return it->second;
+    }
+
+    void release(uint32_t frame) {
+        Frame& f = frames_[frame];
+        index_.erase(block_key(f.file_id, f.block));
+        f.in_use = false;
+        f.referenced = false;
+    }
+
+    // CLOCK: sweep past referenced frames, clearing their bit, and take the
+    // first free or unreferenced one
+    uint32_t take_frame() {
+        for (;;) {
+            uint32_t frame = hand_;
+            hand_ = (hand_ + 1) % (uint32_t)frames_.size();
+            Frame& f = frames_[frame];
+            if (!f.in_use) {
+                return frame;
+            }
+            if (f.referenced) {
+                f.referenced = false;
+                continue;
+            }
+            release(frame);
+            return frame;
+        }
+    }
+
+    // Fetch up to count blocks starting at block with one source call
+    // Read-ahead is capped at half the frames so one scan cannot flush the
+    // cache, and at the staging buffer.
+    template<typename Source>
+    Result<void> fill(FileState& file, std::string_view path, int64_t block, size_t count, Source& source) {
+        // Stop before blocks that are already cached or past the end of file
+        size_t n = 1;
+        while (n < count && n < frames_.size() / 2 && (n + 1) * block_size_ <= staging_.size() &&
+               find(file.id, block + (int64_t)n) == NONE &&
+               (file.eof_block < 0 || block + (int64_t)n <= file.eof_block)) {
+            n++;
+        }
+
+        misses_++;
+        source_calls_++;
+        if (n == 1) {
+            return fill_one(file, path, block, source);
+        }
+        auto result = source(path, block * (int64_t)block_size_, Span<uint8_t>(staging_.data(), n * block_size_));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        size_t got = (size_t)result.unwrap();
+        note_length(file, block, n, got);
+
+        for (size_t i = 0; i < n && i * block_size_ < got; i++) {
+            uint32_t frame = take_frame();
+            size_t length = got - i * block_size_ < block_size_ ? got - i * block_size_ : block_size_;
+            std::memcpy(block_data(frame), staging_.data() + i * block_size_, length);
+            publish(frame, file.id, block + (int64_t)i, length, i == 0); // read-ahead stays cold until used
+        }
+        return Result<void>();
+    }
+
+    // Read one block straight into the frame it will occupy
+    template<typename Source>
+    Result<void> fill_one(FileState& file, std::string_view path, int64_t block, Source& source) {
+        uint32_t frame = take_frame();
+        auto result = source(path, block * (int64_t)block_size_, Span<uint8_t>(block_data(frame), block_size_));
+        if (result.is_err()) {
+            return result.unwrap_err(); // the frame stays free
+        }
+        size_t got = (size_t)result.unwrap();
+        note_length(file, block, 1, got);
+        if (got > 0) {
+            publish(frame, file.id, block, got, true);
+        }
+        return Result<void>();
+    }
+
+    // Remember where the file ends when n blocks from block came back short
+    void note_length(FileState& file, int64_t block, size_t n, size_t got) {
+        if (got < n * block_size_) {
+            file.eof_block = block + (int64_t)((got + block_size_ - 1) / block_size_) - 1;
+        }
+    }
+
+    void publish(uint32_t frame, uint32_t file_id, int64_t block, size_t length, bool referenced) {
+        Frame& f = frames_[frame];
+        f.file_id = file_id;
+        f.block = block;
+        f.length = length;
+        f.in_use = true;
+        f.referenced = referenced;
+        index_[block_key(file_id, block)] = frame;
+    }
+
+    size_t budget_;
+    size_t block_size_;
+    size_t readahead_;
+    std::vector<Frame> frames_;
+    std::vector<uint8_t> data_;
+    std::vector<uint8_t> staging_; // read-ahead landing area, part of the budget
+    std::unordered_map<uint64_t, uint32_t> index_;
+    std::map<std::string, FileState, std::less<>> files_;
+    uint32_t next_file_id_ = 0;
+    uint32_t hand_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t source_calls_ = 0;
+    internal::Mutex mu_;
+};
+
+// BlockCache source reading from the host filesystem
+struct HostFSBlockSource {
+    Result<int64_t> operator()(std::string_view path, int64_t offset, Span<uint8_t> buf) const {
+        auto result = HostFS::read_buffer(std::string(path), offset, (int64_t)buf.size());
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        const HostBuffer& data = result.unwrap();
+        size_t n = data.size() < buf.size() ? data.size() : buf.size();
+        if (n > 0) {
+            std::memcpy(buf.data(), data.data(), n);
+        }
+        return (int64_t)n;
+    }
+};
+
+// BlockCache source issuing HTTP range GETs for url_prefix + path
+// The body is streamed straight into the buffer BlockCache passes in.
+struct HttpRangeBlockSource {
+    std::string url_prefix;
+    std::map<std::string, std::string> headers;
+
+    explicit HttpRangeBlockSource(const std::string& prefix) : url_prefix(prefix) {}
+
+    Result<int64_t> operator()(std::string_view path, int64_t offset, Span<uint8_t> buf) const {
+        if (buf.empty()) {
+            return (int64_t)0;
+        }
+        HttpRequest req = HttpRequest::get(url_prefix + std::string(path));
+        req.headers = headers;
+        req.add_header("Range", "bytes=" + std::to_string(offset) + "-" +
+                                    std::to_string(offset + (int64_t)buf.size() - 1));
+
+        auto opened = Http::open_stream(req);
+        if (opened.is_err()) {
+            return opened.unwrap_err();
+        }
+        HttpStream& stream = opened.unwrap();
+        if (stream.status_code == 416) {
+            return (int64_t)0; // range starts past the end of the object
+        }
+        if (stream.status_code == 404) {
+            return Error::not_found();
+        }
+        if (stream.status_code != 206 && !(stream.status_code == 200 && offset == 0)) {
+            return Error::io("unexpected HTTP status " + std::to_string(stream.status_code) + " for range read");
+        }
+
+        // read_chunk fills the buffer unless the body ends first
+        auto n = stream.read_chunk(buf);
+        if (n.is_err()) {
+            return n.unwrap_err();
+        }
+        return (int64_t)n.unwrap();
+    }
+};
+
+} // namespace agfs
+
+#endif // AGFS_BLOCKCACHE_H
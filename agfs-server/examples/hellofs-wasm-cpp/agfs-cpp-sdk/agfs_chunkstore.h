@@ -0,0 +1,1091 @@
+#ifndef AGFS_CHUNKSTORE_H
+#define AGFS_CHUNKSTORE_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_hostfs.h"
+#include "agfs_blockcache.h"
+#include "agfs_state.h"
+#include "agfs_lz.h"
+#include "agfs_sha256.h"
+#include "agfs_sync.h"
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace agfs {
+namespace internal {
+
+// Random per-byte values of the Gear rolling hash (splitmix64 sequence)
+struct GearTable {
+    uint64_t v[256];
+
+    constexpr GearTable() : v() {
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        for (int i = 0; i < 256; i++) {
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            v[i] = z ^ (z >> 31);
+        }
+    }
+};
+
+inline constexpr GearTable GEAR_TABLE{};
+
+struct DigestHash {
+    size_t operator()(const Sha256::Digest& d) const {
+        size_t h;
+        std::memcpy(&h, d.data(), sizeof(h));
+        return h;
+    }
+};
+
+} // namespace internal
+
+// ContentChunker cuts data at content-defined boundaries
+// A boundary is placed where the Gear rolling hash of the preceding 64 bytes
+// has its top bits clear, so an edit only moves the boundaries next to it and
+// the chunks around it stay identical. Chunks are at least min_size bytes,
+// about avg_size on average (rounded down to a power of two) and at most
+// max_size.
+class ContentChunker {
+public:
+    static constexpr size_t DEFAULT_MIN_SIZE = 2 * 1024;
+    static constexpr size_t DEFAULT_AVG_SIZE = 8 * 1024;
+    static constexpr size_t DEFAULT_MAX_SIZE = 64 * 1024;
+    static constexpr size_t WINDOW = 64;
+    static constexpr size_t LIMIT = 16 * 1024 * 1024;
+
+    ContentChunker(size_t min_size = DEFAULT_MIN_SIZE, size_t avg_size = DEFAULT_AVG_SIZE,
+                   size_t max_size = DEFAULT_MAX_SIZE) {
+        set_sizes(min_size, avg_size, max_size);
+    }
+
+    static bool valid_sizes(int64_t min_size, int64_t avg_size, int64_t max_size) {
+        return (int64_t)WINDOW <= min_size && min_size <= avg_size && avg_size <= max_size &&
+               max_size <= (int64_t)LIMIT;
+    }
+
+    // Sizes outside valid_sizes() fall back to the defaults
+    void set_sizes(size_t min_size, size_t avg_size, size_t max_size) {
+        if (!valid_sizes((int64_t)min_size, (int64_t)avg_size, (int64_t)max_size)) {
+            min_size = DEFAULT_MIN_SIZE;
+            avg_size = DEFAULT_AVG_SIZE;
+            max_size = DEFAULT_MAX_SIZE;
+        }
+        int bits = 0;
+        while (((size_t)2 << bits) <= avg_size) {
+            bits++;
+        }
+        min_ = min_size;
+        max_ = max_size;
+        mask_ = ~0ULL << (64 - bits);
+    }
+
+    size_t min_size() const { return min_; }
+    size_t max_size() const { return max_; }
+
+    // Length of the first chunk of data
+    // final means data runs to the end of the stream. Otherwise 0 is
+    // returned when data ends before a boundary could be decided.
+    size_t cut(Span<const uint8_t> data, bool final) const {
+        size_t n = data.size();
+        size_t limit = n < max_ ? n : max_;
+        if (n > min_) {
+            const uint8_t* p = data.data();
+            uint64_t h = 0;
+            for (size_t i = min_ - WINDOW; i < limit; i++) {
+                h = (h << 1) + internal::GEAR_TABLE.v[p[i]];
+                if (i >= min_ && (h & mask_) == 0) {
+                    return i + 1;
+                }
+            }
+        }
+        if (limit == max_) {
+            return max_;
+        }
+        return final ? n : 0;
+    }
+
+private:
+    size_t min_ = DEFAULT_MIN_SIZE;
+    size_t max_ = DEFAULT_MAX_SIZE;
+    uint64_t mask_ = 0;
+};
+
+// FileSystem over a host directory, the default ChunkedStoreFS target
+// Paths resolve below the host_prefix config value.
+class HostFSTarget : public FileSystem {
+public:
+    const char* name() const override { return "hostfs"; }
+
+    Result<void> validate(const Config& config) override {
+        const char* prefix = config.get_str("host_prefix");
+        if (!prefix || !*prefix) {
+            return Error::invalid_input("host_prefix is required");
+        }
+        return Result<void>();
+    }
+
+    Result<void> initialize(const Config& config) override {
+        auto valid = validate(config);
+        if (valid.is_err()) {
+            return valid;
+        }
+        root_ = config.get_str("host_prefix");
+        while (root_.size() > 1 && root_.back() == '/') {
+            root_.pop_back();
+        }
+        return Result<void>();
+    }
+
+    const std::string& root() const { return root_; }
+
+    Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) override {
+        return HostFS::read(host_path(path), offset, size);
+    }
+
+    Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data, int64_t offset, WriteFlag flags) override {
+        return HostFS::write_at(host_path(path), data, offset, flags);
+    }
+
+    Result<void> create(const std::string& path) override { return HostFS::create(host_path(path)); }
+    Result<void> mkdir(const std::string& path, uint32_t perm) override { return HostFS::mkdir(host_path(path), perm); }
+    Result<void> remove(const std::string& path) override { return HostFS::remove(host_path(path)); }
+    Result<void> remove_all(const std::string& path) override { return HostFS::remove_all(host_path(path)); }
+    Result<FileInfo> stat(const std::string& path) override { return HostFS::stat(host_path(path)); }
+    Result<std::vector<FileInfo>> readdir(const std::string& path) override { return HostFS::readdir(host_path(path)); }
+    Result<void> chmod(const std::string& path, uint32_t mode) override { return HostFS::chmod(host_path(path), mode); }
+
+    Result<void> rename(const std::string& old_path, const std::string& new_path) override {
+        return HostFS::rename(host_path(old_path), host_path(new_path));
+    }
+
+private:
+    std::string host_path(const std::string& path) const {
+        return root_ == "/" ? path : root_ + path;
+    }
+
+    std::string root_;
+};
+
+// Counters of a ChunkedStoreFS instance
+struct ChunkStoreStats {
+    uint64_t bytes_written = 0;  // bytes passed to write()
+    uint64_t chunks_stored = 0;  // new chunks sent to the target
+    uint64_t chunks_deduped = 0; // chunks the target already held
+    uint64_t bytes_stored = 0;   // encoded size of the new chunks
+};
+
+// ChunkedStoreFS stores files as deduplicated, compressed chunks on a target
+// FileSystem (HostFSTarget by default, or any FileSystem subclass):
+//
+//   AGFS_EXPORT_PLUGIN(agfs::ChunkedStoreFS<>);
+//
+// Writes are cut into content-defined chunks (ContentChunker). Each chunk is
+// stored once under its SHA-256 at /chunks/<2 hex>/<64 hex>, compressed with
+// LzCodec when that makes it smaller, and every file becomes a manifest at
+// /files/<path> listing its chunks. A write only re-chunks from the chunk
+// holding its offset until the new boundaries line up with the old ones, so
+// appends and in-place edits touch a few chunks, not the whole file.
+//
+// Reads reassemble files through a BlockCache. Every call first re-reads the
+// manifest header, which carries a digest of the chunk list, so instances
+// sharing a target see each other's writes; chunk data never changes once
+// stored. Removing files leaves their chunks behind until collect_garbage(),
+// which bumps a generation counter on the target; every write checks it and
+// forgets which chunks it believed stored when another instance collected.
+// In threaded builds each call holds one instance lock.
+template<typename Target = HostFSTarget>
+class ChunkedStoreFS : public FileSystem {
+    static_assert(std::is_base_of<FileSystem, Target>::value, "ChunkedStoreFS targets must derive from agfs::FileSystem");
+
+public:
+    const char* name() const override { return "chunkstore"; }
+
+    const char* readme() const override {
+        return "ChunkedStoreFS - deduplicated, compressed file storage\n"
+               " - Files are stored as content-defined chunks under /chunks of the target\n"
+               " - Per-file manifests under /files list the chunks of each file\n"
+               " - Config: chunk_min_size, chunk_avg_size, chunk_max_size, chunk_compress,\n"
+               "   block_cache_size and the target's own keys (host_prefix for HostFS)";
+    }
+
+    Target& target() { return target_; }
+    BlockCache& blocks() { return blocks_; }
+    const ChunkStoreStats& stats() const { return stats_; }
+
+    Result<void> validate(const Config& config) override {
+        if (!ContentChunker::valid_sizes(config.get_i64("chunk_min_size", ContentChunker::DEFAULT_MIN_SIZE),
+                                         config.get_i64("chunk_avg_size", ContentChunker::DEFAULT_AVG_SIZE),
+                                         config.get_i64("chunk_max_size", ContentChunker::DEFAULT_MAX_SIZE))) {
+            return Error::invalid_input("chunk sizes must satisfy 64 <= chunk_min_size <= chunk_avg_size <= chunk_max_size <= 16MB");
+        }
+        return target_.validate(config);
+    }
+
+    Result<void> initialize(const Config& config) override {
+        internal::RecursiveLockGuard lock(mu_);
+        auto valid = validate(config);
+        if (valid.is_err()) {
+            return valid;
+        }
+        auto inited = target_.initialize(config);
+        if (inited.is_err()) {
+            return inited;
+        }
+        apply_config(config);
+
+        auto files = ensure_dir(FILES_DIR);
+        if (files.is_err()) {
+            return files;
+        }
+        return ensure_dir(CHUNKS_DIR);
+    }
+
+    // Snapshot: the config initialize() applied, then the target's snapshot
+    // New instances skip validation and the directory checks; a target
+    // without a snapshot of its own is initialized from the config again.
+    Result<std::vector<uint8_t>> export_state() override {
+        internal::RecursiveLockGuard lock(mu_);
+        auto target = target_.export_state();
+        if (target.is_err()) {
+            return target;
+        }
+        std::vector<uint8_t> out;
+        StateWriter w(out);
+        w.config(config_);
+        w.bytes(target.unwrap().data(), target.unwrap().size());
+        return out;
+    }
+
+    Result<void> import_state(Span<const uint8_t> state) override {
+        internal::RecursiveLockGuard lock(mu_);
+        StateReader r(state);
+        Config config = r.config();
+        std::string target_state = r.str();
+        if (!r.ok() || !r.at_end()) {
+            return Error::invalid_input("corrupt chunk store state");
+        }
+        auto restored = target_state.empty()
+            ? target_.initialize(config)
+            : target_.import_state(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(target_state.data()),
+                                                       target_state.size()));
+        if (restored.is_err()) {
+            return restored;
+        }
+        apply_config(config);
+        return Result<void>();
+    }
+
+    Result<void> shutdown() override {
+        internal::RecursiveLockGuard lock(mu_);
+        reset_caches();
+        blocks_.clear();
+        return target_.shutdown();
+    }
+
+    Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) override {
+        internal::RecursiveLockGuard lock(mu_);
+        if (offset < 0) {
+            return Error::invalid_input("negative offset");
+        }
+        auto loaded = load_manifest(path);
+        if (loaded.is_err()) {
+            return loaded.unwrap_err();
+        }
+        const Manifest& m = *loaded.unwrap();
+        int64_t avail = m.size > offset ? m.size - offset : 0;
+        std::vector<uint8_t> out((size_t)(size < 0 || size > avail ? avail : size));
+        auto result = read_cached(path, m, offset, out);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        out.resize((size_t)result.unwrap());
+        return out;
+    }
+
+    Result<int64_t> read_into(const std::string& path, int64_t offset, Span<uint8_t> buf) override {
+        internal::RecursiveLockGuard lock(mu_);
+        auto loaded = load_manifest(path);
+        if (loaded.is_err()) {
+            return loaded.unwrap_err();
+        }
+        return read_cached(path, *loaded.unwrap(), offset, buf);
+    }
+
+    Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data, int64_t offset, WriteFlag flags) override {
+        internal::RecursiveLockGuard lock(mu_);
+        Manifest current;
+        auto loaded = load_manifest(path);
+        if (loaded.is_err()) {
+            if (loaded.unwrap_err().kind != ErrorKind::NotFound || !flags.contains(WriteFlag::CREATE)) {
+                return loaded.unwrap_err();
+            }
+        } else {
+            if (flags.contains(WriteFlag::EXCLUSIVE)) {
+                return Error::already_exists();
+            }
+            if (!flags.contains(WriteFlag::TRUNCATE)) {
+                current = *loaded.unwrap();
+            }
+        }
+        if (flags.contains(WriteFlag::APPEND) || offset < 0) {
+            offset = current.size;
+        }
+
+        auto synced = sync_generation();
+        if (synced.is_err()) {
+            return synced.unwrap_err();
+        }
+        auto updated = splice(current, offset, data);
+        if (updated.is_err()) {
+            return updated.unwrap_err();
+        }
+        auto saved = save_manifest(path, updated.unwrap());
+        if (saved.is_err()) {
+            return saved.unwrap_err();
+        }
+        stats_.bytes_written += data.size();
+        return (int64_t)data.size();
+    }
+
+    Result<void> create(const std::string& path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        return save_manifest(path, Manifest());
+    }
+
+    Result<void> mkdir(const std::string& path, uint32_t perm) override {
+        internal::RecursiveLockGuard lock(mu_);
+        return target_.mkdir(manifest_path(path), perm);
+    }
+
+    Result<void> remove(const std::string& path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        forget(path);
+        return target_.remove(manifest_path(path));
+    }
+
+    Result<void> remove_all(const std::string& path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        reset_caches();
+        blocks_.clear();
+        auto removed = target_.remove_all(manifest_path(path));
+        if (removed.is_err() || manifest_path(path) != FILES_DIR) {
+            return removed;
+        }
+        return ensure_dir(FILES_DIR); // the root itself stays
+    }
+
+    Result<void> rename(const std::string& old_path, const std::string& new_path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        forget(old_path);
+        forget(new_path);
+        return target_.rename(manifest_path(old_path), manifest_path(new_path));
+    }
+
+    Result<void> chmod(const std::string& path, uint32_t mode) override {
+        internal::RecursiveLockGuard lock(mu_);
+        return target_.chmod(manifest_path(path), mode);
+    }
+
+    Result<FileInfo> stat(const std::string& path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        auto result = target_.stat(manifest_path(path));
+        if (result.is_err()) {
+            return result;
+        }
+        FileInfo info = std::move(result.unwrap());
+        if (path == "/") {
+            info.name.clear();
+        }
+        if (!info.is_dir) {
+            auto loaded = load_manifest(path);
+            if (loaded.is_err()) {
+                return loaded.unwrap_err();
+            }
+            info.size = loaded.unwrap()->size;
+        }
+        return info;
+    }
+
+    Result<std::vector<FileInfo>> readdir(const std::string& path) override {
+        internal::RecursiveLockGuard lock(mu_);
+        auto result = target_.readdir(manifest_path(path));
+        if (result.is_err()) {
+            return result;
+        }
+        std::vector<FileInfo> entries = std::move(result.unwrap());
+        for (auto& entry : entries) {
+            if (entry.is_dir) {
+                continue;
+            }
+            auto loaded = load_manifest(join(path, entry.name));
+            if (loaded.is_ok()) {
+                entry.size = loaded.unwrap()->size;
+            }
+        }
+        return entries;
+    }
+
+    // Remove chunks no manifest refers to
+    // Run it while no writes are in flight: a chunk stored by a concurrent
+    // write before its manifest lands would be collected.
+    // Returns: Number of chunks removed
+    Result<int64_t> collect_garbage() {
+        internal::RecursiveLockGuard lock(mu_);
+        std::unordered_set<Sha256::Digest, internal::DigestHash> live;
+        auto marked = mark_live("/", live);
+        if (marked.is_err()) {
+            return marked.unwrap_err();
+        }
+
+        auto dirs = target_.readdir(CHUNKS_DIR);
+        if (dirs.is_err()) {
+            return dirs.unwrap_err();
+        }
+        int64_t removed = 0;
+        for (const auto& dir : dirs.unwrap()) {
+            if (!dir.is_dir) {
+                continue;
+            }
+            std::string dir_path = std::string(CHUNKS_DIR) + "/" + dir.name;
+            auto chunks = target_.readdir(dir_path);
+            if (chunks.is_err()) {
+                return chunks.unwrap_err();
+            }
+            for (const auto& chunk : chunks.unwrap()) {
+                Sha256::Digest digest{};
+                if (parse_hex(chunk.name, digest) && live.count(digest)) {
+                    continue;
+                }
+                auto gone = target_.remove(dir_path + "/" + chunk.name);
+                if (gone.is_err()) {
+                    return gone.unwrap_err();
+                }
+                known_.erase(digest);
+                removed++;
+            }
+        }
+        cached_valid_ = false;
+        if (removed > 0) {
+            auto bumped = bump_generation();
+            if (bumped.is_err()) {
+                return bumped.unwrap_err();
+            }
+        }
+        return removed;
+    }
+
+private:
+    static constexpr const char* FILES_DIR = "/files";
+    static constexpr const char* CHUNKS_DIR = "/chunks";
+    static constexpr const char* GENERATION_PATH = "/chunks/generation"; // u64, bumped by collect_garbage()
+    static constexpr uint32_t MANIFEST_MAGIC = 0x53434741; // "AGCS"
+    static constexpr uint32_t MANIFEST_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 4 + 4 + 8 + 4 + 32;
+    static constexpr size_t ENTRY_SIZE = 32 + 4;
+    static constexpr int64_t PROBE_SIZE = 4096; // manifests this small load in one read
+    static constexpr size_t MAX_MANIFESTS = 256;
+    static constexpr uint8_t CODEC_RAW = 0;
+    static constexpr uint8_t CODEC_LZ = 1;
+
+    // Chunk list of one file; ends[i] is the file offset where chunk i ends
+    struct Manifest {
+        std::vector<uint8_t> header; // as stored, compared to detect changes
+        int64_t size = 0;
+        std::vector<Sha256::Digest> digests;
+        std::vector<int64_t> ends;
+
+        int64_t start(size_t i) const { return i == 0 ? 0 : ends[i - 1]; }
+    };
+
+    static std::string manifest_path(const std::string& path) {
+        if (path.empty() || path == "/") {
+            return FILES_DIR;
+        }
+        return FILES_DIR + path;
+    }
+
+    static std::string chunk_path(const Sha256::Digest& digest) {
+        std::string hex = Sha256::to_hex(digest);
+        return std::string(CHUNKS_DIR) + "/" + hex.substr(0, 2) + "/" + hex;
+    }
+
+    static std::string join(const std::string& dir, const std::string& name) {
+        return dir == "/" ? "/" + name : dir + "/" + name;
+    }
+
+    static bool parse_hex(const std::string& s, Sha256::Digest& out) {
+        if (s.size() != 64) {
+            return false;
+        }
+        for (size_t i = 0; i < 64; i++) {
+            char c = s[i];
+            int v = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (v < 0) {
+                return false;
+            }
+            out[i / 2] = (uint8_t)(i % 2 == 0 ? v << 4 : out[i / 2] | v);
+        }
+        return true;
+    }
+
+    static void put_digest(StateWriter& w, const Sha256::Digest& d) {
+        for (size_t i = 0; i < d.size(); i += 8) {
+            uint64_t v;
+            std::memcpy(&v, d.data() + i, sizeof(v));
+            w.u64(v);
+        }
+    }
+
+    static Sha256::Digest get_digest(StateReader& r) {
+        Sha256::Digest d;
+        for (size_t i = 0; i < d.size(); i += 8) {
+            uint64_t v = r.u64();
+            std::memcpy(d.data() + i, &v, sizeof(v));
+        }
+        return d;
+    }
+
+    // Header: magic, version, size, chunk count and the SHA-256 of the
+    // entries (digest, u32 length) that follow
+    static std::vector<uint8_t> encode_manifest(const Manifest& m) {
+        std::vector<uint8_t> out;
+        out.reserve(HEADER_SIZE + m.digests.size() * ENTRY_SIZE);
+        out.resize(HEADER_SIZE);
+        StateWriter w(out);
+        for (size_t i = 0; i < m.digests.size(); i++) {
+            put_digest(w, m.digests[i]);
+            w.u32((uint32_t)(m.ends[i] - m.start(i)));
+        }
+        Sha256::Digest body = Sha256::hash(Span<const uint8_t>(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE));
+
+        std::vector<uint8_t> header;
+        StateWriter h(header);
+        h.u32(MANIFEST_MAGIC);
+        h.u32(MANIFEST_VERSION);
+        h.i64(m.size);
+        h.u32((uint32_t)m.digests.size());
+        header.insert(header.end(), body.begin(), body.end());
+        std::memcpy(out.data(), header.data(), HEADER_SIZE);
+        return out;
+    }
+
+    static bool decode_manifest(Span<const uint8_t> data, Manifest& m) {
+        if (data.size() < HEADER_SIZE) {
+            return false;
+        }
+        StateReader r(data);
+        if (r.u32() != MANIFEST_MAGIC || r.u32() != MANIFEST_VERSION) {
+            return false;
+        }
+        m.size = r.i64();
+        uint32_t count = r.u32();
+        if ((data.size() - HEADER_SIZE) / ENTRY_SIZE != count || (data.size() - HEADER_SIZE) % ENTRY_SIZE != 0) {
+            return false;
+        }
+        Sha256::Digest body = Sha256::hash(data.subspan(HEADER_SIZE));
+        if (std::memcmp(body.data(), data.data() + HEADER_SIZE - body.size(), body.size()) != 0) {
+            return false;
+        }
+        StateReader entries(data.subspan(HEADER_SIZE));
+        m.digests.resize(count);
+        m.ends.resize(count);
+        int64_t end = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            m.digests[i] = get_digest(entries);
+            end += entries.u32();
+            m.ends[i] = end;
+        }
+        m.header.assign(data.data(), data.data() + HEADER_SIZE);
+        return entries.ok() && end == m.size;
+    }
+
+    // Current manifest of path, re-validated against the stored header
+    // The pointer is valid until the next call that modifies the manifest cache.
+    Result<const Manifest*> load_manifest(const std::string& path) {
+        std::string mpath = manifest_path(path);
+        auto probe = target_.read(mpath, 0, PROBE_SIZE);
+        if (probe.is_err()) {
+            auto info = target_.stat(mpath);
+            if (info.is_err()) {
+                return Error::not_found();
+            }
+            if (info.unwrap().is_dir) {
+                return Error::is_directory();
+            }
+            return probe.unwrap_err();
+        }
+        std::vector<uint8_t>& data = probe.unwrap();
+
+        auto it = manifests_.find(path);
+        if (it != manifests_.end() && data.size() >= HEADER_SIZE &&
+            std::memcmp(it->second.header.data(), data.data(), HEADER_SIZE) == 0) {
+            return &it->second;
+        }
+
+        if ((int64_t)data.size() == PROBE_SIZE) {
+            auto full = target_.read(mpath, 0, -1);
+            if (full.is_err()) {
+                return full.unwrap_err();
+            }
+            data = std::move(full.unwrap());
+        }
+        Manifest m;
+        if (!decode_manifest(data, m)) {
+            return Error::io("corrupt chunk manifest: " + path);
+        }
+        blocks_.invalidate(path);
+        return remember(path, std::move(m));
+    }
+
+    Result<void> save_manifest(const std::string& path, Manifest m) {
+        std::vector<uint8_t> encoded = encode_manifest(m);
+        auto written = target_.write(manifest_path(path), encoded, 0, WriteFlag::CREATE | WriteFlag::TRUNCATE);
+        if (written.is_err()) {
+            forget(path);
+            return written.unwrap_err();
+        }
+        m.header.assign(encoded.begin(), encoded.begin() + HEADER_SIZE);
+        blocks_.invalidate(path);
+        remember(path, std::move(m));
+        return Result<void>();
+    }
+
+    const Manifest* remember(const std::string& path, Manifest m) {
+        auto it = manifests_.find(path);
+        if (it == manifests_.end()) {
+            if (manifests_.size() >= MAX_MANIFESTS) {
+                manifests_.erase(manifests_.begin());
+            }
+            it = manifests_.emplace(path, Manifest()).first;
+        }
+        it->second = std::move(m);
+        return &it->second;
+    }
+
+    void forget(const std::string& path) {
+        manifests_.erase(path);
+        blocks_.invalidate(path);
+    }
+
+    void reset_caches() {
+        manifests_.clear();
+        known_.clear();
+        zero_digest_valid_ = false;
+        fanout_dirs_.reset();
+        cached_valid_ = false;
+    }
+
+    // The target's garbage collection generation, 0 before the first
+    Result<uint64_t> read_generation() {
+        auto data = target_.read(GENERATION_PATH, 0, sizeof(uint64_t));
+        if (data.is_err()) {
+            if (data.unwrap_err().kind == ErrorKind::NotFound) {
+                return (uint64_t)0;
+            }
+            return data.unwrap_err();
+        }
+        uint64_t generation = 0;
+        if (data.unwrap().size() == sizeof(generation)) {
+            std::memcpy(&generation, data.unwrap().data(), sizeof(generation));
+        }
+        return generation;
+    }
+
+    // Forget the chunks known to be stored if any instance collected garbage
+    // since this one last looked: they may be gone from the target.
+    Result<void> sync_generation() {
+        auto generation = read_generation();
+        if (generation.is_err()) {
+            return generation.unwrap_err();
+        }
+        if (generation.unwrap() != generation_) {
+            known_.clear();
+            zero_digest_valid_ = false;
+            generation_ = generation.unwrap();
+        }
+        return Result<void>();
+    }
+
+    Result<void> bump_generation() {
+        auto generation = read_generation();
+        if (generation.is_err()) {
+            return generation.unwrap_err();
+        }
+        uint64_t next = generation.unwrap() + 1;
+        std::vector<uint8_t> data(sizeof(next));
+        std::memcpy(data.data(), &next, sizeof(next));
+        auto written = target_.write(GENERATION_PATH, data, 0, WriteFlag::CREATE | WriteFlag::TRUNCATE);
+        if (written.is_err()) {
+            return written.unwrap_err();
+        }
+        generation_ = next;
+        return Result<void>();
+    }
+
+    Result<void> ensure_dir(const std::string& path) {
+        auto info = target_.stat(path);
+        if (info.is_ok()) {
+            if (!info.unwrap().is_dir) {
+                return Error::not_directory();
+            }
+            return Result<void>();
+        }
+        return target_.mkdir(path, 0755);
+    }
+
+    // Decoded contents of one chunk
+    // The view is valid until the next chunk_data() or store_chunk() call.
+    Result<Span<const uint8_t>> chunk_data(const Sha256::Digest& digest, int64_t length) {
+        if (cached_valid_ && cached_digest_ == digest) {
+            return Span<const uint8_t>(cached_chunk_);
+        }
+        cached_valid_ = false;
+        auto blob = target_.read(chunk_path(digest), 0, -1);
+        if (blob.is_err()) {
+            return blob.unwrap_err();
+        }
+        const std::vector<uint8_t>& b = blob.unwrap();
+        cached_chunk_.resize((size_t)length);
+        if (b.empty()) {
+            return Error::io("empty chunk " + Sha256::to_hex(digest));
+        }
+        Span<const uint8_t> payload(b.data() + 1, b.size() - 1);
+        if (b[0] == CODEC_RAW && payload.size() == (size_t)length) {
+            std::memcpy(cached_chunk_.data(), payload.data(), payload.size());
+        } else if (b[0] == CODEC_LZ) {
+            auto decoded = LzCodec::decompress(payload, Span<uint8_t>(cached_chunk_));
+            if (decoded.is_err()) {
+                return decoded.unwrap_err();
+            }
+        } else {
+            return Error::io("corrupt chunk " + Sha256::to_hex(digest));
+        }
+        cached_digest_ = digest;
+        cached_valid_ = true;
+        return Span<const uint8_t>(cached_chunk_);
+    }
+
+    // Store one chunk unless the target already has it
+    // New chunks are written under a temporary name unique to this instance
+    // and call, then renamed into place, so a partial write never looks like
+    // a stored chunk. Chunks are named by content, so when the rename fails
+    // because another writer stored the same chunk first, that counts as
+    // stored. The chunk also becomes the decoded one, which the next append
+    // starts from.
+    Result<Sha256::Digest> store_chunk(Span<const uint8_t> raw) {
+        Sha256::Digest digest = Sha256::hash(raw);
+        cached_chunk_.assign(raw.begin(), raw.end());
+        cached_digest_ = digest;
+        cached_valid_ = true;
+        if (known_.count(digest)) {
+            stats_.chunks_deduped++;
+            return digest;
+        }
+        std::string path = chunk_path(digest);
+        if (target_.stat(path).is_ok()) {
+            known_.insert(digest);
+            stats_.chunks_deduped++;
+            return digest;
+        }
+        if (!fanout_dirs_.test(digest[0])) {
+            auto dir = ensure_dir(path.substr(0, std::strlen(CHUNKS_DIR) + 3));
+            if (dir.is_err()) {
+                return dir.unwrap_err();
+            }
+            fanout_dirs_.set(digest[0]);
+        }
+
+        blob_.clear();
+        if (compress_) {
+            blob_.push_back(CODEC_LZ);
+            codec_.compress(raw, blob_);
+            if (blob_.size() - 1 >= raw.size()) {
+                blob_.clear();
+            }
+        }
+        if (blob_.empty()) {
+            blob_.push_back(CODEC_RAW);
+            blob_.insert(blob_.end(), raw.begin(), raw.end());
+        }
+        std::string tmp = temp_path(path);
+        auto written = target_.write(tmp, blob_, 0, WriteFlag::CREATE | WriteFlag::TRUNCATE);
+        if (written.is_err()) {
+            target_.remove(tmp);
+            return written.unwrap_err();
+        }
+        auto renamed = target_.rename(tmp, path);
+        if (renamed.is_err()) {
+            target_.remove(tmp);
+            if (target_.stat(path).is_err()) {
+                return renamed.unwrap_err();
+            }
+            known_.insert(digest);
+            stats_.chunks_deduped++;
+            return digest;
+        }
+        known_.insert(digest);
+        stats_.chunks_stored++;
+        stats_.bytes_stored += blob_.size();
+        return digest;
+    }
+
+    // path + ".tmp.<instance>.<call>"
+    // The instance part mixes the clock with this object's address, so
+    // instances sharing a target do not pick the same name.
+    std::string temp_path(const std::string& path) {
+        if (temp_tag_.empty()) {
+            uint64_t seed = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^
+                            ((uint64_t)(uintptr_t)this << 16);
+            char tag[17];
+            std::snprintf(tag, sizeof(tag), "%016llx", (unsigned long long)seed);
+            temp_tag_ = tag;
+        }
+        return path + ".tmp." + temp_tag_ + "." + std::to_string(temp_seq_++);
+    }
+
+    // Store chunk into the manifest, ending at offset end of the file
+    Result<void> append_stored(Manifest& out, Span<const uint8_t> chunk, int64_t end) {
+        auto stored = store_chunk(chunk);
+        if (stored.is_err()) {
+            return stored.unwrap_err();
+        }
+        out.digests.push_back(stored.unwrap());
+        out.ends.push_back(end);
+        return Result<void>();
+    }
+
+    // Append chunks of zeros covering [from, to) of the file to out
+    // Full-size runs share one chunk whose digest is remembered, so a write
+    // far past the end of a file neither materializes nor rehashes the gap.
+    Result<void> store_zeros(Manifest& out, int64_t from, int64_t to) {
+        size_t max = chunker_.max_size();
+        if (zeros_.size() < max) {
+            zeros_.assign(max, 0);
+        }
+        while (from < to) {
+            size_t len = (uint64_t)(to - from) < max ? (size_t)(to - from) : max;
+            if (len == max && zero_digest_valid_ && known_.count(zero_digest_)) {
+                stats_.chunks_deduped++;
+                from += (int64_t)len;
+                out.digests.push_back(zero_digest_);
+                out.ends.push_back(from);
+                continue;
+            }
+            auto stored = append_stored(out, Span<const uint8_t>(zeros_.data(), len), from + (int64_t)len);
+            if (stored.is_err()) {
+                return stored;
+            }
+            if (len == max) {
+                zero_digest_ = out.digests.back();
+                zero_digest_valid_ = true;
+            }
+            from += (int64_t)len;
+        }
+        return Result<void>();
+    }
+
+    // Append the decoded chunk i of m to out
+    Result<void> append_chunk(const Manifest& m, size_t i, std::vector<uint8_t>& out) {
+        auto data = chunk_data(m.digests[i], m.ends[i] - m.start(i));
+        if (data.is_err()) {
+            return data.unwrap_err();
+        }
+        out.insert(out.end(), data.unwrap().begin(), data.unwrap().end());
+        return Result<void>();
+    }
+
+    // Manifest of old with data written at offset
+    // Chunks before the one holding offset are kept. From there the file is
+    // re-chunked until a new boundary falls on an old one past the written
+    // range; the old chunks after that point are kept as they are.
+    Result<Manifest> splice(const Manifest& old, int64_t offset, Span<const uint8_t> data) {
+        size_t count = old.digests.size();
+        int64_t end = offset + (int64_t)data.size();
+
+        // The last chunk ends where the file did, not at a content boundary,
+        // so writes at or past the end start by re-chunking it
+        size_t first = (size_t)(std::upper_bound(old.ends.begin(), old.ends.end(), offset) - old.ends.begin());
+        if (first == count && count > 0) {
+            first = count - 1;
+        }
+
+        Manifest out;
+        out.size = old.size > end ? old.size : end;
+        out.digests.assign(old.digests.begin(), old.digests.begin() + first);
+        out.ends.assign(old.ends.begin(), old.ends.begin() + first);
+
+        // buf holds the file from region_start; while next < count, the
+        // old chunk next starts right where buf ends
+        std::vector<uint8_t>& buf = work_;
+        buf.clear();
+        int64_t region_start = first < count ? old.start(first) : 0;
+        size_t next = first;
+        while (next < count && region_start + (int64_t)buf.size() < end) {
+            auto appended = append_chunk(old, next++, buf);
+            if (appended.is_err()) {
+                return appended.unwrap_err();
+            }
+        }
+        size_t rel = (size_t)(offset - region_start);
+        if (rel > buf.size()) {
+            // The write starts past the end of the file (all old chunks are
+            // in buf): chunk what is there and cover the gap with zero chunks
+            for (size_t pos = 0; pos < buf.size();) {
+                size_t len = chunker_.cut(Span<const uint8_t>(buf.data() + pos, buf.size() - pos), true);
+                pos += len;
+                auto stored = append_stored(out, Span<const uint8_t>(buf.data() + pos - len, len), region_start + (int64_t)pos);
+                if (stored.is_err()) {
+                    return stored.unwrap_err();
+                }
+            }
+            auto zeros = store_zeros(out, region_start + (int64_t)buf.size(), offset);
+            if (zeros.is_err()) {
+                return zeros.unwrap_err();
+            }
+            buf.clear();
+            region_start = offset;
+            rel = 0;
+        }
+        if (buf.size() < rel + data.size()) {
+            buf.resize(rel + data.size(), 0);
+        }
+        if (!data.empty()) {
+            std::memcpy(buf.data() + rel, data.data(), data.size());
+        }
+
+        size_t pos = 0;
+        for (;;) {
+            size_t avail = buf.size() - pos;
+            if (avail == 0) {
+                break; // end of file, or back in step with the old chunks
+            }
+            size_t len = chunker_.cut(Span<const uint8_t>(buf.data() + pos, avail), next == count);
+            if (len == 0) {
+                buf.erase(buf.begin(), buf.begin() + (ptrdiff_t)pos);
+                region_start += (int64_t)pos;
+                pos = 0;
+                auto appended = append_chunk(old, next++, buf);
+                if (appended.is_err()) {
+                    return appended.unwrap_err();
+                }
+                continue;
+            }
+            auto stored = append_stored(out, Span<const uint8_t>(buf.data() + pos, len), region_start + (int64_t)(pos + len));
+            if (stored.is_err()) {
+                return stored.unwrap_err();
+            }
+            pos += len;
+        }
+        out.digests.insert(out.digests.end(), old.digests.begin() + next, old.digests.end());
+        out.ends.insert(out.ends.end(), old.ends.begin() + next, old.ends.end());
+        return out;
+    }
+
+    // Fill buf from the chunks of m starting at offset
+    Result<int64_t> read_chunks(const Manifest& m, int64_t offset, Span<uint8_t> buf) {
+        size_t i = (size_t)(std::upper_bound(m.ends.begin(), m.ends.end(), offset) - m.ends.begin());
+        size_t done = 0;
+        while (done < buf.size() && i < m.digests.size()) {
+            int64_t start = m.start(i);
+            auto data = chunk_data(m.digests[i], m.ends[i] - start);
+            if (data.is_err()) {
+                if (done > 0) {
+                    break;
+                }
+                return data.unwrap_err();
+            }
+            Span<const uint8_t> chunk = data.unwrap();
+            size_t in_chunk = (size_t)(offset + (int64_t)done - start);
+            size_t n = chunk.size() - in_chunk;
+            if (n > buf.size() - done) {
+                n = buf.size() - done;
+            }
+            std::memcpy(buf.data() + done, chunk.data() + in_chunk, n);
+            done += n;
+            i++;
+        }
+        return (int64_t)done;
+    }
+
+    Result<int64_t> read_cached(const std::string& path, const Manifest& m, int64_t offset, Span<uint8_t> buf) {
+        return blocks_.read(path, offset, buf, [this, &m](std::string_view, int64_t off, Span<uint8_t> out) {
+            return read_chunks(m, off, out);
+        });
+    }
+
+    // Add the chunks of every manifest below path to live
+    Result<void> mark_live(const std::string& path, std::unordered_set<Sha256::Digest, internal::DigestHash>& live) {
+        auto entries = target_.readdir(manifest_path(path));
+        if (entries.is_err()) {
+            return entries.unwrap_err();
+        }
+        for (const auto& entry : entries.unwrap()) {
+            std::string child = join(path, entry.name);
+            if (entry.is_dir) {
+                auto marked = mark_live(child, live);
+                if (marked.is_err()) {
+                    return marked;
+                }
+                continue;
+            }
+            auto loaded = load_manifest(child);
+            if (loaded.is_err()) {
+                return Error::io("cannot read manifest " + child + ": " + loaded.unwrap_err().to_string());
+            }
+            live.insert(loaded.unwrap()->digests.begin(), loaded.unwrap()->digests.end());
+        }
+        return Result<void>();
+    }
+
+    // Chunking, compression and cache settings from a validated config
+    void apply_config(const Config& config) {
+        chunker_.set_sizes((size_t)config.get_i64("chunk_min_size", ContentChunker::DEFAULT_MIN_SIZE),
+                           (size_t)config.get_i64("chunk_avg_size", ContentChunker::DEFAULT_AVG_SIZE),
+                           (size_t)config.get_i64("chunk_max_size", ContentChunker::DEFAULT_MAX_SIZE));
+        compress_ = config.get_bool("chunk_compress", true);
+        blocks_.configure(config);
+        reset_caches();
+        config_ = config;
+    }
+
+    Target target_;
+    Config config_; // for export_state()
+    ContentChunker chunker_;
+    LzCodec codec_;
+    BlockCache blocks_;
+    bool compress_ = true;
+    ChunkStoreStats stats_;
+    std::map<std::string, Manifest, std::less<>> manifests_;
+    std::unordered_set<Sha256::Digest, internal::DigestHash> known_;
+    std::bitset<256> fanout_dirs_;
+    Sha256::Digest cached_digest_{};
+    std::vector<uint8_t> cached_chunk_;
+    bool cached_valid_ = false;
+    std::vector<uint8_t> blob_;
+    std::vector<uint8_t> work_;
+    std::vector<uint8_t> zeros_;
+    Sha256::Digest zero_digest_{};
+    bool zero_digest_valid_ = false;
+    uint64_t generation_ = 0; // of the target, when known_ was last trusted
+    std::string temp_tag_;
+    uint64_t temp_seq_ = 0;
+    internal::RecursiveMutex mu_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_CHUNKSTORE_H
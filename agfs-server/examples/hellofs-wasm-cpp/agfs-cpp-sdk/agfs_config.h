@@ -0,0 +1,332 @@
+#ifndef AGFS_CONFIG_H
+#define AGFS_CONFIG_H
+
+#include "agfs_types.h"
+#include "agfs_json.h"
+#include "agfs_state.h"
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace agfs {
+
+// Typed plugin configuration
+//
+// A plugin describes its settings once, as a constexpr table binding each
+// config key to a member of a plain struct. Defaults are the struct's own
+// member initializers. The SDK then:
+//   - exports plugin_get_config_params, so the server can list the keys
+//   - checks types and required keys in plugin_validate/plugin_initialize
+//   - fills the struct once per instance, so hot paths read plain members
+//
+//   struct Settings {
+//       std::string host_prefix;
+//       int64_t cache_size = 4096;
+//       bool read_only = false;
+//   };
+//
+//   class MyFS : public agfs::FileSystem, public agfs::Configurable<Settings> {
+//   public:
+//       static agfs::ConfigSchema<Settings> config_schema() {
+//           static constexpr agfs::ConfigField<Settings> fields[] = {
+//               {"host_prefix", &Settings::host_prefix, "Host directory to serve", true},
+//               {"cache_size", &Settings::cache_size, "Cache entries"},
+//               {"read_only", &Settings::read_only, "Reject writes"},
+//           };
+//           return fields;
+//       }
+//       ... settings().cache_size ...
+//   };
+//
+// The untyped Config is still passed to validate()/initialize(), which run
+// after the typed settings have been loaded.
+
+enum class ConfigType { String, Int, Bool, Float };
+
+// Type names as used by the server's plugin.ConfigParameter
+inline const char* config_type_name(ConfigType type) {
+    switch (type) {
+        case ConfigType::String: return "string";
+        case ConfigType::Int: return "int";
+        case ConfigType::Bool: return "bool";
+        case ConfigType::Float: return "float";
+    }
+    return "string";
+}
+
+// One config key bound to a member of T
+template <typename T>
+struct ConfigField {
+    union Member {
+        std::string T::*str;
+        int64_t T::*i64;
+        bool T::*boolean;
+        double T::*f64;
+
+        constexpr Member(std::string T::*m) : str(m) {}
+        constexpr Member(int64_t T::*m) : i64(m) {}
+        constexpr Member(bool T::*m) : boolean(m) {}
+        constexpr Member(double T::*m) : f64(m) {}
+    };
+
+    const char* name;
+    ConfigType type;
+    Member member;
+    const char* description;
+    bool required;
+
+    constexpr ConfigField(const char* n, std::string T::*m, const char* desc, bool req = false)
+        : name(n), type(ConfigType::String), member(m), description(desc), required(req) {}
+    constexpr ConfigField(const char* n, int64_t T::*m, const char* desc, bool req = false)
+        : name(n), type(ConfigType::Int), member(m), description(desc), required(req) {}
+    constexpr ConfigField(const char* n, bool T::*m, const char* desc, bool req = false)
+        : name(n), type(ConfigType::Bool), member(m), description(desc), required(req) {}
+    constexpr ConfigField(const char* n, double T::*m, const char* desc, bool req = false)
+        : name(n), type(ConfigType::Float), member(m), description(desc), required(req) {}
+
+    // Parse raw into this field of out
+    bool assign(T& out, const std::string& raw) const {
+        switch (type) {
+            case ConfigType::String: out.*member.str = raw; return true;
+            case ConfigType::Int: return Config::parse_i64(raw, out.*member.i64);
+            case ConfigType::Bool: return Config::parse_bool(raw, out.*member.boolean);
+            case ConfigType::Float: return Config::parse_f64(raw, out.*member.f64);
+        }
+        return false;
+    }
+
+    // Current value of this field in value, as config text
+    std::string format(const T& value) const {
+        switch (type) {
+            case ConfigType::String: return value.*member.str;
+            case ConfigType::Int: return std::to_string(value.*member.i64);
+            case ConfigType::Bool: return value.*member.boolean ? "true" : "false";
+            case ConfigType::Float: {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%.17g", value.*member.f64);
+                return buf;
+            }
+        }
+        return std::string();
+    }
+};
+
+// A plugin's field table
+template <typename T>
+class ConfigSchema {
+public:
+    template <size_t N>
+    constexpr ConfigSchema(const ConfigField<T> (&fields)[N]) : fields_(fields), count_(N) {}
+
+    const ConfigField<T>* begin() const { return fields_; }
+    const ConfigField<T>* end() const { return fields_ + count_; }
+    size_t size() const { return count_; }
+
+    // Build settings from raw config: defaults, then every key present
+    // Returns: InvalidInput naming the first missing or mistyped key
+    Result<T> parse(const Config& raw) const {
+        T out{};
+        for (const auto& field : *this) {
+            auto it = raw.values.find(field.name);
+            if (it == raw.values.end()) {
+                if (field.required) {
+                    return Error::invalid_input(std::string("missing required config: ") + field.name);
+                }
+                continue;
+            }
+            if (!field.assign(out, it->second)) {
+                return Error::invalid_input(std::string("config ") + field.name + " must be " +
+                                            config_type_name(field.type) + ", got \"" + it->second + "\"");
+            }
+        }
+        return out;
+    }
+
+    // JSON array of the server's ConfigParameter, for plugin_get_config_params
+    std::string params_json() const {
+        const T defaults{};
+        std::string out;
+        out.reserve(128 * count_);
+        JsonWriter w(out);
+        w.begin_array();
+        for (const auto& field : *this) {
+            w.begin_object();
+            w.key("name"); w.string(field.name);
+            w.key("type"); w.string(config_type_name(field.type));
+            w.key("required"); w.boolean(field.required);
+            w.key("default"); w.string(field.required ? std::string() : field.format(defaults));
+            w.key("description"); w.string(field.description ? field.description : "");
+            w.end_object();
+        }
+        w.end_array();
+        return out;
+    }
+
+    // Settings as part of a plugin_export_state snapshot
+    void write_state(StateWriter& w, const T& value) const {
+        for (const auto& field : *this) {
+            switch (field.type) {
+                case ConfigType::String: w.str(value.*field.member.str); break;
+                case ConfigType::Int: w.i64(value.*field.member.i64); break;
+                case ConfigType::Bool: w.u8(value.*field.member.boolean ? 1 : 0); break;
+                case ConfigType::Float: w.f64(value.*field.member.f64); break;
+            }
+        }
+    }
+
+    bool read_state(StateReader& r, T& value) const {
+        for (const auto& field : *this) {
+            switch (field.type) {
+                case ConfigType::String: value.*field.member.str = r.str(); break;
+                case ConfigType::Int: value.*field.member.i64 = r.i64(); break;
+                case ConfigType::Bool: value.*field.member.boolean = r.u8() != 0; break;
+                case ConfigType::Float: value.*field.member.f64 = r.f64(); break;
+            }
+        }
+        return r.ok();
+    }
+
+private:
+    const ConfigField<T>* fields_;
+    size_t count_;
+};
+
+// Mixin holding a plugin's parsed settings
+template <typename T>
+class Configurable {
+public:
+    using Settings = T;
+
+    const T& settings() const { return settings_; }
+
+    // Called by the SDK before initialize()
+    void load_settings(T settings) { settings_ = std::move(settings); }
+
+private:
+    T settings_{};
+};
+
+namespace internal {
+
+// True when PluginType declares static config_schema()
+template <typename P, typename = void>
+struct HasConfigSchema : std::false_type {};
+
+template <typename P>
+struct HasConfigSchema<P, std::void_t<decltype(P::config_schema())>> : std::true_type {};
+
+// Typed config handling for the export macros; no-ops without a schema
+template <typename P>
+Result<void> load_plugin_settings(P* plugin, const Config& config, bool store) {
+    if constexpr (HasConfigSchema<P>::value) {
+        auto parsed = P::config_schema().parse(config);
+        if (parsed.is_err()) {
+            return parsed.unwrap_err();
+        }
+        if (store) {
+            plugin->load_settings(std::move(parsed.unwrap()));
+        }
+    }
+    (void)plugin; (void)config; (void)store;
+    return Result<void>();
+}
+
+template <typename P>
+std::string plugin_config_params() {
+    if constexpr (HasConfigSchema<P>::value) {
+        return P::config_schema().params_json();
+    }
+    return std::string();
+}
+
+template <typename P>
+void write_plugin_settings(const P* plugin, StateWriter& w) {
+    if constexpr (HasConfigSchema<P>::value) {
+        P::config_schema().write_state(w, plugin->settings());
+    }
+    (void)plugin; (void)w;
+}
+
+template <typename P>
+bool read_plugin_settings(P* plugin, StateReader& r) {
+    if constexpr (HasConfigSchema<P>::value) {
+        typename P::Settings settings{};
+        if (!P::config_schema().read_state(r, settings)) {
+            return false;
+        }
+        plugin->load_settings(std::move(settings));
+    }
+    (void)plugin; (void)r;
+    return true;
+}
+
+// Config the plugin was initialized with, kept for plugin_export_state
+inline Config& initialized_config() {
+    static Config config;
+    return config;
+}
+
+template <typename P>
+void remember_plugin_config(const Config& config) {
+    if constexpr (HasConfigSchema<P>::value) {
+        initialized_config() = config;
+    }
+    (void)config;
+}
+
+// plugin_export_state body. Layout without a schema: the plugin's own
+// snapshot, or nothing when it has none. With a schema: typed settings, u8
+// has_snapshot, then the plugin's snapshot or, when it has none, the config
+// for initialize(). Either way new instances skip parsing the settings.
+// Returns: false when there is nothing to export
+template <typename P>
+bool export_plugin_snapshot(P* plugin, std::vector<uint8_t>& out) {
+    auto result = plugin->export_state();
+    if (result.is_err()) {
+        return false;
+    }
+    const std::vector<uint8_t>& own = result.unwrap();
+    if constexpr (HasConfigSchema<P>::value) {
+        StateWriter w(out);
+        write_plugin_settings(plugin, w);
+        w.u8(own.empty() ? 0 : 1);
+        if (own.empty()) {
+            w.config(initialized_config());
+            return true;
+        }
+    } else if (own.empty()) {
+        return false;
+    }
+    out.insert(out.end(), own.begin(), own.end());
+    return true;
+}
+
+// plugin_import_state body, the reverse of export_plugin_snapshot
+template <typename P>
+Result<void> import_plugin_snapshot(P* plugin, Span<const uint8_t> state) {
+    StateReader r(state);
+    if (!read_plugin_settings(plugin, r)) {
+        return Error::invalid_input("corrupt plugin state");
+    }
+    if constexpr (HasConfigSchema<P>::value) {
+        bool has_snapshot = r.u8() != 0;
+        if (!has_snapshot) {
+            Config config = r.config();
+            if (!r.ok() || !r.at_end()) {
+                return Error::invalid_input("corrupt plugin state");
+            }
+            initialized_config() = config;
+            return plugin->initialize(config);
+        }
+        if (!r.ok()) {
+            return Error::invalid_input("corrupt plugin state");
+        }
+    }
+    return plugin->import_state(r.remaining());
+}
+
+} // namespace internal
+} // namespace agfs
+
+#endif // AGFS_CONFIG_H
@@ -4,6 +4,12 @@
 #include "agfs_types.h"
 #include "agfs_ffi.h"
 #include "agfs_filesystem.h"
+#include "agfs_handlefs.h"
+#include "agfs_filesystem_v2.h"
+#include "agfs_arena.h"
+#include "agfs_metrics.h"
+#include "agfs_sync.h"
+#include <type_traits>
 
 namespace agfs {
 namespace internal {
@@ -17,13 +23,220 @@ struct PluginInstance {
 template<typename T>
 T* PluginInstance<T>::instance = nullptr;
 
+// Execute an fs_batch request against plugin (see agfs::ffi::BatchCodec)
+// Results are appended to out after the 8-byte response header. Results that
+// exceed the batch size limits become error records, so a bad entry cannot
+// exhaust linear memory.
+// Returns: An error if the request is malformed or not even an error record fits
+template<typename T>
+Result<void> run_batch(T* plugin, const uint8_t* req, size_t req_len, ffi::BatchCodec::Response& out) {
+    using Codec = ffi::BatchCodec;
+    Codec::Reader in(req, req_len);
+    uint32_t count = in.u32();
+    if (!in.ok()) {
+        return Error::invalid_input("malformed batch request");
+    }
+
+    if (!out.resize(ffi::BinaryCodec::HEADER_SIZE)) {
+        return Error::io("out of memory");
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t op = in.u8();
+        uint32_t path_len = 0;
+        const char* path_ptr = reinterpret_cast<const char*>(in.bytes(path_len));
+        if (!in.ok()) {
+            return Error::invalid_input("malformed batch request");
+        }
+        auto path = PluginArgs<T>::path(path_ptr, path_len);
+
+        // Set when a result did not fit and became an error record
+        size_t rejected = 0;
+        bool has_rejected = false;
+        auto reject = [&](size_t len) {
+            rejected = len;
+            has_rejected = true;
+        };
+
+        switch (op) {
+            case Codec::OP_STAT: {
+                auto result = plugin->stat(path);
+                if (result.is_err()) {
+                    if (!Codec::append_error(out, op, result.unwrap_err())) {
+                        reject(0);
+                    }
+                    break;
+                }
+                size_t len = ffi::BinaryCodec::encoded_size(&result.unwrap(), 1);
+                uint8_t* dst = Codec::append_result(out, op, Codec::STATUS_OK, len);
+                if (!dst) {
+                    reject(len);
+                    break;
+                }
+                ffi::BinaryCodec::encode(&result.unwrap(), 1, dst);
+                break;
+            }
+            case Codec::OP_READDIR: {
+                auto result = plugin->readdir(path);
+                if (result.is_err()) {
+                    if (!Codec::append_error(out, op, result.unwrap_err())) {
+                        reject(0);
+                    }
+                    break;
+                }
+                const auto& entries = result.unwrap();
+                size_t len = ffi::BinaryCodec::encoded_size(entries.data(), entries.size());
+                uint8_t* dst = Codec::append_result(out, op, Codec::STATUS_OK, len);
+                if (!dst) {
+                    reject(len);
+                    break;
+                }
+                ffi::BinaryCodec::encode(entries.data(), entries.size(), dst);
+                break;
+            }
+            case Codec::OP_READ: {
+                int64_t offset = in.i64();
+                int64_t size = in.i64();
+                if (!in.ok()) {
+                    return Error::invalid_input("malformed batch request");
+                }
+                if (size >= 0) {
+                    // Check the host-supplied size before allocating anything for it
+                    if ((uint64_t)size > Codec::MAX_OP_BYTES || !Codec::fits(out, (size_t)size)) {
+                        reject((size_t)size);
+                        break;
+                    }
+                    // Read straight into the response, then trim to the bytes actually read
+                    size_t record_start = out.size();
+                    uint8_t* dst = Codec::append_result(out, op, Codec::STATUS_OK, (size_t)size);
+                    if (!dst) {
+                        reject((size_t)size);
+                        break;
+                    }
+                    auto result = plugin->read_into(path, offset, Span<uint8_t>(dst, (size_t)size));
+                    if (result.is_err()) {
+                        out.resize(record_start);
+                        if (!Codec::append_error(out, op, result.unwrap_err())) {
+                            reject(0);
+                        }
+                        break;
+                    }
+                    Codec::truncate_result(out, record_start, (size_t)result.unwrap());
+                    break;
+                }
+                auto result = plugin->read(path, offset, size);
+                if (result.is_err()) {
+                    if (!Codec::append_error(out, op, result.unwrap_err())) {
+                        reject(0);
+                    }
+                    break;
+                }
+                const auto& data = result.unwrap();
+                uint8_t* dst = Codec::append_result(out, op, Codec::STATUS_OK, data.size());
+                if (!dst) {
+                    reject(data.size());
+                    break;
+                }
+                if (!data.empty()) {
+                    std::memcpy(dst, data.data(), data.size());
+                }
+                break;
+            }
+            case Codec::OP_WRITE: {
+                int64_t offset = in.i64();
+                uint32_t flags = in.u32();
+                uint32_t data_len = 0;
+                const uint8_t* data_ptr = in.bytes(data_len);
+                if (!in.ok()) {
+                    return Error::invalid_input("malformed batch request");
+                }
+                auto data = PluginArgs<T>::data(data_ptr, data_len);
+                auto result = plugin->write(path, data, offset, WriteFlag(flags));
+                if (result.is_err()) {
+                    if (!Codec::append_error(out, op, result.unwrap_err())) {
+                        reject(0);
+                    }
+                    break;
+                }
+                int64_t written = result.unwrap();
+                uint8_t* dst = Codec::append_result(out, op, Codec::STATUS_OK, 8);
+                if (!dst) {
+                    reject(8);
+                    break;
+                }
+                std::memcpy(dst, &written, 8);
+                break;
+            }
+            default:
+                if (!Codec::append_error(out, op, Error::invalid_input("unknown batch op"))) {
+                    reject(0);
+                }
+                break;
+        }
+
+        if (has_rejected && !Codec::append_error(out, op, Codec::too_large(rejected))) {
+            return Error::invalid_input("batch response exceeds " +
+                                        std::to_string(Codec::MAX_RESPONSE_BYTES) + " bytes");
+        }
+    }
+
+    uint32_t total = (uint32_t)out.size();
+    std::memcpy(out.data(), &total, 4);
+    std::memcpy(out.data() + 4, &count, 4);
+    return Result<void>();
+}
+
 } // namespace internal
 } // namespace agfs
 
-// Export a FileSystem implementation as a WASM plugin
+// Size of each shared buffer; arguments and results that fit skip malloc
+// Override per build (-DAGFS_SHARED_BUFFER_SIZE=1048576) or per plugin with
+// AGFS_EXPORT_PLUGIN_WITH_BUFFERS.
+#ifndef AGFS_SHARED_BUFFER_SIZE
+#define AGFS_SHARED_BUFFER_SIZE 65536 /* 64KB */
+#endif
+
+// Number of input slots; each argument the host writes takes its own slot,
+// so e.g. fs_write's path and data can both use the fast path
+#ifndef AGFS_SHARED_BUFFER_SLOTS
+#define AGFS_SHARED_BUFFER_SLOTS 2
+#endif
+
+// Export a FileSystem or FileSystemV2 implementation as a WASM plugin
+// FileSystemV2 plugins receive paths and write data as views of the argument
+// memory instead of copies.
 #define AGFS_EXPORT_PLUGIN(PluginType) \
+    AGFS_EXPORT_PLUGIN_WITH_BUFFERS(PluginType, AGFS_SHARED_BUFFER_SIZE, AGFS_SHARED_BUFFER_SLOTS)
+
+// Same as AGFS_EXPORT_PLUGIN with an explicit shared buffer size and slot count
+#define AGFS_EXPORT_PLUGIN_WITH_BUFFERS(PluginType, BufferSize, BufferSlots) \
     static PluginType* g_plugin_instance = nullptr; \
     \
+    /* Shared memory buffers for zero-copy optimization */ \
+    static constexpr size_t SHARED_BUFFER_SIZE = (BufferSize); \
+    static constexpr size_t SHARED_BUFFER_SLOTS = (BufferSlots); \
+    static_assert(SHARED_BUFFER_SIZE > 0 && SHARED_BUFFER_SIZE % 8 == 0, \
+                  "shared buffer size must be a positive multiple of 8"); \
+    static_assert(SHARED_BUFFER_SLOTS >= 1 && SHARED_BUFFER_SLOTS <= 32, \
+                  "shared buffer slot count must be between 1 and 32"); \
+    /* Per worker in threaded builds, so concurrent calls never share them */ \
+    static AGFS_THREAD_LOCAL uint8_t input_buffer[SHARED_BUFFER_SIZE * SHARED_BUFFER_SLOTS]; \
+    static AGFS_THREAD_LOCAL uint8_t output_buffer[SHARED_BUFFER_SIZE]; \
+    static AGFS_THREAD_LOCAL bool output_buffer_shared = false; \
+    \
+    /* Result buffer for the host: the output buffer if it fits, else a fresh allocation */ \
+    static uint8_t* agfs_result_buffer(size_t len) { \
+        if (output_buffer_shared && len <= SHARED_BUFFER_SIZE) return output_buffer; \
+        return (uint8_t*)agfs::ffi::wasm_malloc(len); \
+    } \
+    \
+    /* nullptr when the buffer cannot be allocated */ \
+    static uint8_t* agfs_encode_fileinfo_bin(const agfs::FileInfo* infos, size_t count) { \
+        uint8_t* buf = agfs_result_buffer(agfs::ffi::BinaryCodec::encoded_size(infos, count)); \
+        if (!buf) return nullptr; \
+        agfs::ffi::BinaryCodec::encode(infos, count, buf); \
+        return buf; \
+    } \
+    \
     extern "C" { \
     \
     __attribute__((export_name("plugin_new"))) \
@@ -44,10 +257,20 @@ T* PluginInstance<T>::instance = nullptr;
         return agfs::ffi::copy_string(g_plugin_instance->readme()); \
     } \
     \
+    /* JSON array of config parameters, or null without config_schema() */ \
+    __attribute__((export_name("plugin_get_config_params"))) \
+    char* plugin_get_config_params() { \
+        return agfs::ffi::copy_string(agfs::internal::plugin_config_params<PluginType>()); \
+    } \
+    \
     __attribute__((export_name("plugin_validate"))) \
     char* plugin_validate(const char* config_ptr) { \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
         agfs::Config config = agfs::ffi::JsonParser::parse_config(config_ptr); \
+        auto typed = agfs::internal::load_plugin_settings(g_plugin_instance, config, false); \
+        if (typed.is_err()) { \
+            return agfs::ffi::copy_string(typed.unwrap_err().to_string()); \
+        } \
         auto result = g_plugin_instance->validate(config); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -55,14 +278,55 @@ T* PluginInstance<T>::instance = nullptr;
         return nullptr; \
     } \
     \
+    /* 1 if every call under this config must reach this instance (see FileSystem::single_instance) */ \
+    __attribute__((export_name("plugin_single_instance"))) \
+    int plugin_single_instance(const char* config_ptr) { \
+        if (!g_plugin_instance) return 0; \
+        agfs::Config config = agfs::ffi::JsonParser::parse_config(config_ptr); \
+        return g_plugin_instance->single_instance(config) ? 1 : 0; \
+    } \
+    \
     __attribute__((export_name("plugin_initialize"))) \
     char* plugin_initialize(const char* config_ptr) { \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
         agfs::Config config = agfs::ffi::JsonParser::parse_config(config_ptr); \
+        auto typed = agfs::internal::load_plugin_settings(g_plugin_instance, config, true); \
+        if (typed.is_err()) { \
+            return agfs::ffi::copy_string(typed.unwrap_err().to_string()); \
+        } \
         auto result = g_plugin_instance->initialize(config); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
         } \
+        agfs::internal::remember_plugin_config<PluginType>(config); \
+        return nullptr; \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = state ptr, high 32 bits = len (0 = no state) */ \
+    __attribute__((export_name("plugin_export_state"))) \
+    uint64_t plugin_export_state() { \
+        if (!g_plugin_instance) return 0; \
+        /* Typed settings (if any) go first, so import skips parsing config */ \
+        std::vector<uint8_t> state; \
+        if (!agfs::internal::export_plugin_snapshot(g_plugin_instance, state)) { \
+            return 0; \
+        } \
+        uint32_t len = state.size(); \
+        uint8_t* buf = (uint8_t*)agfs::ffi::wasm_malloc(len); \
+        /* Without memory the host sees no snapshot and calls plugin_initialize */ \
+        if (!buf) return 0; \
+        std::memcpy(buf, state.data(), len); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), len); \
+    } \
+    \
+    __attribute__((export_name("plugin_import_state"))) \
+    char* plugin_import_state(const uint8_t* state_ptr, uint32_t state_len) { \
+        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+        auto result = agfs::internal::import_plugin_snapshot( \
+            g_plugin_instance, agfs::Span<const uint8_t>(state_ptr, state_len)); \
+        if (result.is_err()) { \
+            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+        } \
         return nullptr; \
     } \
     \
@@ -78,8 +342,19 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_read"))) \
     uint64_t fs_read(const char* path_ptr, int64_t offset, int64_t size) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsRead); \
         if (!g_plugin_instance) return 0; \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        /* Reads that fit are filled straight into the shared output buffer */ \
+        if (output_buffer_shared && size >= 0 && (uint64_t)size <= SHARED_BUFFER_SIZE) { \
+            auto result = g_plugin_instance->read_into(path, offset, agfs::Span<uint8_t>(output_buffer, (size_t)size)); \
+            if (result.is_err()) { \
+                return 0; \
+            } \
+            metric_scope.bytes_out((uint64_t)result.unwrap()); \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(output_buffer), (uint32_t)result.unwrap()); \
+        } \
         auto result = g_plugin_instance->read(path, offset, size); \
         if (result.is_err()) { \
             return 0; \
@@ -88,60 +363,261 @@ T* PluginInstance<T>::instance = nullptr;
         uint32_t len = data.size(); \
         uint8_t* buf = (uint8_t*)agfs::ffi::wasm_malloc(len); \
         std::memcpy(buf, data.data(), len); \
-        return agfs::ffi::pack_u64((uint32_t)buf, len); \
+        metric_scope.bytes_out(len); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), len); \
     } \
     \
     __attribute__((export_name("fs_stat"))) \
     uint64_t fs_stat(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, (uint32_t)agfs::ffi::copy_string("not initialized")); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsStat); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->stat(path); \
         if (result.is_err()) { \
             char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
         } \
         std::string json = agfs::ffi::JsonParser::serialize_fileinfo(result.unwrap()); \
         char* json_ptr = agfs::ffi::copy_string(json); \
-        return agfs::ffi::pack_u64((uint32_t)json_ptr, 0); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(json_ptr), 0); \
     } \
     \
     __attribute__((export_name("fs_readdir"))) \
     uint64_t fs_readdir(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, (uint32_t)agfs::ffi::copy_string("not initialized")); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsReaddir); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->readdir(path); \
         if (result.is_err()) { \
             char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
         } \
         std::string json = agfs::ffi::JsonParser::serialize_fileinfo_array(result.unwrap()); \
         char* json_ptr = agfs::ffi::copy_string(json); \
-        return agfs::ffi::pack_u64((uint32_t)json_ptr, 0); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(json_ptr), 0); \
+    } \
+    \
+    /* Binary variants of fs_stat/fs_readdir, see agfs::ffi::BinaryCodec */ \
+    /* Returns packed u64: low 32 bits = buffer ptr, high 32 bits = error ptr */ \
+    __attribute__((export_name("fs_stat_bin"))) \
+    uint64_t fs_stat_bin(const char* path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsStat); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        auto result = g_plugin_instance->stat(path); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        uint8_t* buf = agfs_encode_fileinfo_bin(&result.unwrap(), 1); \
+        if (!buf) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("out of memory"))); \
+        } \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), 0); \
+    } \
+    \
+    __attribute__((export_name("fs_readdir_bin"))) \
+    uint64_t fs_readdir_bin(const char* path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsReaddir); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        auto result = g_plugin_instance->readdir(path); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        const auto& entries = result.unwrap(); \
+        uint8_t* buf = agfs_encode_fileinfo_bin(entries.data(), entries.size()); \
+        if (!buf) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("out of memory"))); \
+        } \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), 0); \
+    } \
+    \
+    /* Paginated readdir: buffer = u32 cursor_len, next cursor bytes, then a BinaryCodec buffer */ \
+    /* Returns packed u64: low 32 bits = buffer ptr, high 32 bits = error ptr */ \
+    __attribute__((export_name("fs_readdir_page"))) \
+    uint64_t fs_readdir_page(const char* path_ptr, const char* cursor_ptr, uint32_t max_entries) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsReaddir); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        auto cursor = agfs::internal::PluginArgs<PluginType>::path(cursor_ptr); \
+        auto result = g_plugin_instance->readdir_page(path, cursor, max_entries); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        const auto& page = result.unwrap(); \
+        size_t prefix = 4 + page.next_cursor.size(); \
+        uint8_t* buf = agfs_result_buffer(prefix + agfs::ffi::BinaryCodec::encoded_size(page.entries.data(), page.entries.size())); \
+        if (!buf) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("out of memory"))); \
+        } \
+        uint32_t cursor_len = (uint32_t)page.next_cursor.size(); \
+        std::memcpy(buf, &cursor_len, 4); \
+        std::memcpy(buf + 4, page.next_cursor.data(), cursor_len); \
+        agfs::ffi::BinaryCodec::encode(page.entries.data(), page.entries.size(), buf + prefix); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), 0); \
+    } \
+    \
+    /* 1 if readdir_page is the plugin's own; otherwise full listings should use fs_readdir_bin */ \
+    __attribute__((export_name("fs_readdir_page_native"))) \
+    int fs_readdir_page_native() { \
+        return agfs::internal::HasNativeReaddirPage<PluginType>::value ? 1 : 0; \
+    } \
+    \
+    /* Run several stat/read/readdir/write ops in one call, see agfs::ffi::BatchCodec */ \
+    /* Returns packed u64: low 32 bits = response ptr, high 32 bits = error ptr */ \
+    __attribute__((export_name("fs_batch"))) \
+    uint64_t fs_batch(const uint8_t* req_ptr, uint32_t req_len) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsBatch); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        metric_scope.bytes_in(req_len); \
+        agfs::ffi::BatchCodec::Response response; \
+        auto status = agfs::internal::run_batch(g_plugin_instance, req_ptr, req_len, response); \
+        if (status.is_err()) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string(status.unwrap_err().to_string()))); \
+        } \
+        metric_scope.bytes_out(response.size()); \
+        /* Small responses go through the output buffer; large ones are handed over as built */ \
+        if (output_buffer_shared && response.size() <= SHARED_BUFFER_SIZE) { \
+            std::memcpy(output_buffer, response.data(), response.size()); \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(output_buffer), 0); \
+        } \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(response.release()), 0); \
     } \
     \
     /* fs_write with offset and flags */ \
     /* Returns packed u64: high 32 bits = bytes written, low 32 bits = error ptr (0 = success) */ \
     __attribute__((export_name("fs_write"))) \
     uint64_t fs_write(const char* path_ptr, const uint8_t* data_ptr, size_t size, int64_t offset, uint32_t flags) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsWrite); \
         if (!g_plugin_instance) { \
             char* err_ptr = agfs::ffi::copy_string("not initialized"); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
         } \
-        std::string path = agfs::ffi::read_string(path_ptr); \
-        std::vector<uint8_t> data(data_ptr, data_ptr + size); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        auto data = agfs::internal::PluginArgs<PluginType>::data(data_ptr, size); \
+        metric_scope.bytes_in(size); \
         auto result = g_plugin_instance->write(path, data, offset, agfs::WriteFlag(flags)); \
         if (result.is_err()) { \
             char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
         } \
         /* Pack bytes_written in high 32 bits, 0 (success) in low 32 bits */ \
         return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
     } \
     \
+    /* Vectored read: iov = iov_count x (i64 offset, i64 size) */ \
+    /* Result: u32 total_len, u32 count, count x u32 bytes read, then the data back to back */ \
+    /* Returns packed u64: low 32 bits = result ptr, high 32 bits = error ptr */ \
+    __attribute__((export_name("fs_readv"))) \
+    uint64_t fs_readv(const char* path_ptr, const uint8_t* iov_ptr, uint32_t iov_count) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsReadv); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        if (iov_count > AGFS_READV_MAX_SEGMENTS) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string( \
+                "readv request has more than " + std::to_string(AGFS_READV_MAX_SEGMENTS) + " segments"))); \
+        } \
+        agfs::ffi::ByteReader in(iov_ptr, (size_t)iov_count * 16); \
+        std::pmr::vector<agfs::ReadSegment> segments(iov_count, &agfs::call_arena()); \
+        size_t header = 8 + 4 * (size_t)iov_count; \
+        size_t total = header; \
+        for (auto& seg : segments) { \
+            seg.offset = in.i64(); \
+            int64_t size = in.i64(); \
+            if (!in.ok() || size < 0) { \
+                return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("malformed readv request"))); \
+            } \
+            if ((uint64_t)size > AGFS_READV_MAX_BYTES - (total - header)) { \
+                return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string( \
+                    "readv request exceeds " + std::to_string(AGFS_READV_MAX_BYTES) + " bytes"))); \
+            } \
+            seg.count = size; \
+            total += (size_t)size; \
+        } \
+        /* Read every segment straight into its slot, then close the gaps left by short reads */ \
+        uint8_t* buf = agfs_result_buffer(total); \
+        if (!buf) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("out of memory"))); \
+        } \
+        size_t at = header; \
+        for (auto& seg : segments) { \
+            seg.buf = agfs::Span<uint8_t>(buf + at, (size_t)seg.count); \
+            at += (size_t)seg.count; \
+            seg.count = 0; \
+        } \
+        auto result = g_plugin_instance->readv(path, agfs::Span<agfs::ReadSegment>(segments.data(), segments.size())); \
+        if (result.is_err()) { \
+            if (buf != output_buffer) agfs::ffi::wasm_free(buf); \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        at = header; \
+        for (uint32_t i = 0; i < iov_count; i++) { \
+            const auto& seg = segments[i]; \
+            uint32_t n = (uint32_t)(seg.count < 0 ? 0 : ((size_t)seg.count < seg.buf.size() ? (size_t)seg.count : seg.buf.size())); \
+            if (n > 0 && seg.buf.data() != buf + at) std::memmove(buf + at, seg.buf.data(), n); \
+            std::memcpy(buf + 8 + 4 * (size_t)i, &n, 4); \
+            at += n; \
+        } \
+        uint32_t total_len = (uint32_t)at; \
+        std::memcpy(buf, &total_len, 4); \
+        std::memcpy(buf + 4, &iov_count, 4); \
+        metric_scope.bytes_out(at - header); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), 0); \
+    } \
+    \
+    /* Vectored write: iov = u32 count, then per segment i64 offset, u32 len, data */ \
+    /* Returns packed u64: high 32 bits = total bytes written, low 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("fs_writev"))) \
+    uint64_t fs_writev(const char* path_ptr, const uint8_t* iov_ptr, uint32_t iov_len, uint32_t flags) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsWritev); \
+        if (!g_plugin_instance) { \
+            char* err_ptr = agfs::ffi::copy_string("not initialized"); \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(err_ptr), 0); \
+        } \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
+        metric_scope.bytes_in(iov_len); \
+        agfs::ffi::ByteReader in(iov_ptr, iov_len); \
+        uint32_t count = in.u32(); \
+        if (!in.ok() || count > iov_len / 12) { \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(agfs::ffi::copy_string("malformed writev request")), 0); \
+        } \
+        std::pmr::vector<agfs::WriteSegment> segments(count, &agfs::call_arena()); \
+        for (auto& seg : segments) { \
+            seg.offset = in.i64(); \
+            uint32_t len = 0; \
+            const uint8_t* data = in.bytes(len); \
+            if (!in.ok()) { \
+                return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(agfs::ffi::copy_string("malformed writev request")), 0); \
+            } \
+            seg.data = agfs::Span<const uint8_t>(data, len); \
+        } \
+        auto result = g_plugin_instance->writev(path, agfs::Span<const agfs::WriteSegment>(segments.data(), segments.size()), agfs::WriteFlag(flags)); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(err_ptr), 0); \
+        } \
+        return agfs::ffi::pack_u64(0, (uint32_t)result.unwrap()); \
+    } \
+    \
     __attribute__((export_name("fs_create"))) \
     char* fs_create(const char* path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsCreate); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->create(path); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -151,8 +627,10 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_mkdir"))) \
     char* fs_mkdir(const char* path_ptr, uint32_t perm) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsMkdir); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->mkdir(path, perm); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -162,8 +640,10 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_remove"))) \
     char* fs_remove(const char* path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsRemove); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->remove(path); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -173,8 +653,10 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_remove_all"))) \
     char* fs_remove_all(const char* path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsRemoveAll); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->remove_all(path); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -184,9 +666,11 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_rename"))) \
     char* fs_rename(const char* old_path_ptr, const char* new_path_ptr) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsRename); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string old_path = agfs::ffi::read_string(old_path_ptr); \
-        std::string new_path = agfs::ffi::read_string(new_path_ptr); \
+        auto old_path = agfs::internal::PluginArgs<PluginType>::path(old_path_ptr); \
+        auto new_path = agfs::internal::PluginArgs<PluginType>::path(new_path_ptr); \
         auto result = g_plugin_instance->rename(old_path, new_path); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -196,8 +680,10 @@ T* PluginInstance<T>::instance = nullptr;
     \
     __attribute__((export_name("fs_chmod"))) \
     char* fs_chmod(const char* path_ptr, uint32_t mode) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::FsChmod); \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto path = agfs::internal::PluginArgs<PluginType>::path(path_ptr); \
         auto result = g_plugin_instance->chmod(path, mode); \
         if (result.is_err()) { \
             return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
@@ -205,18 +691,15 @@ T* PluginInstance<T>::instance = nullptr;
         return nullptr; \
     } \
     \
-    /* Shared memory buffers for zero-copy optimization */ \
-    static constexpr size_t SHARED_BUFFER_SIZE = 65536; /* 64KB */ \
-    static uint8_t input_buffer[SHARED_BUFFER_SIZE]; \
-    static uint8_t output_buffer[SHARED_BUFFER_SIZE]; \
-    \
     __attribute__((export_name("get_input_buffer_ptr"))) \
     uint8_t* get_input_buffer_ptr() { \
         return input_buffer; \
     } \
     \
+    /* Once the host knows this address it will not free() it */ \
     __attribute__((export_name("get_output_buffer_ptr"))) \
     uint8_t* get_output_buffer_ptr() { \
+        output_buffer_shared = true; \
         return output_buffer; \
     } \
     \
@@ -225,6 +708,177 @@ T* PluginInstance<T>::instance = nullptr;
         return SHARED_BUFFER_SIZE; \
     } \
     \
+    /* The input buffer holds this many consecutive slots of SHARED_BUFFER_SIZE bytes */ \
+    __attribute__((export_name("get_shared_buffer_slots"))) \
+    uint32_t get_shared_buffer_slots() { \
+        return SHARED_BUFFER_SLOTS; \
+    } \
+    \
+    /* Stack size the host gives each worker of a threaded build; 0 without AGFS_THREADS */ \
+    __attribute__((export_name("agfs_thread_stack_size"))) \
+    uint32_t agfs_thread_stack_size() { \
+        return agfs::internal::thread_stack_size(); \
+    } \
+    \
+    /* Drain agfs::metrics() (see MetricsRegistry::drain); 0 when built without AGFS_ENABLE_METRICS */ \
+    /* Returns packed u64: low 32 bits = buffer ptr, high 32 bits = length */ \
+    __attribute__((export_name("plugin_get_metrics"))) \
+    uint64_t plugin_get_metrics() { \
+        if (!agfs::internal::metrics_enabled()) return 0; \
+        /* Allocated before draining, so a failed allocation loses no counts */ \
+        uint8_t* buf = (uint8_t*)agfs::ffi::wasm_malloc(agfs::MetricsRegistry::max_drain_size()); \
+        if (!buf) return 0; \
+        std::vector<uint8_t> encoded = agfs::metrics().drain(); \
+        std::memcpy(buf, encoded.data(), encoded.size()); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), (uint32_t)encoded.size()); \
+    } \
+    \
+    } /* extern "C" */
+
+// Export a HandleFileSystem implementation as a WASM plugin with handle support
+// Exports everything AGFS_EXPORT_PLUGIN does plus the handle_* functions the
+// host probes for; their presence makes the host route opens through handles.
+#define AGFS_EXPORT_HANDLE_PLUGIN(PluginType) \
+    AGFS_EXPORT_HANDLE_PLUGIN_WITH_BUFFERS(PluginType, AGFS_SHARED_BUFFER_SIZE, AGFS_SHARED_BUFFER_SLOTS)
+
+// Same as AGFS_EXPORT_HANDLE_PLUGIN with an explicit shared buffer size and slot count
+#define AGFS_EXPORT_HANDLE_PLUGIN_WITH_BUFFERS(PluginType, BufferSize, BufferSlots) \
+    AGFS_EXPORT_PLUGIN_WITH_BUFFERS(PluginType, BufferSize, BufferSlots) \
+    \
+    static_assert(std::is_base_of<agfs::HandleFileSystem, PluginType>::value, \
+                  "AGFS_EXPORT_HANDLE_PLUGIN requires a class derived from agfs::HandleFileSystem"); \
+    \
+    extern "C" { \
+    \
+    /* Returns packed u64: high 32 bits = handle id, low 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_open"))) \
+    uint64_t handle_open(const char* path_ptr, uint32_t flags, uint32_t mode) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleOpen); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized")), 0); \
+        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto result = g_plugin_instance->handle_open(path, agfs::OpenFlag(flags), mode); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(err_ptr), 0); \
+        } \
+        return agfs::ffi::pack_u64(0, (uint32_t)result.unwrap()); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes read, high 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_read"))) \
+    uint64_t handle_read(int64_t id, uint8_t* buf_ptr, size_t buf_size) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleRead); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_read(id, agfs::Span<uint8_t>(buf_ptr, buf_size)); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        metric_scope.bytes_out((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes read, high 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_read_at"))) \
+    uint64_t handle_read_at(int64_t id, uint8_t* buf_ptr, size_t buf_size, int64_t offset) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleRead); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_read_at(id, agfs::Span<uint8_t>(buf_ptr, buf_size), offset); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        metric_scope.bytes_out((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes written, high 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_write"))) \
+    uint64_t handle_write(int64_t id, const uint8_t* data_ptr, size_t size) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleWrite); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_write(id, agfs::Span<const uint8_t>(data_ptr, size)); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        metric_scope.bytes_in((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes written, high 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_write_at"))) \
+    uint64_t handle_write_at(int64_t id, const uint8_t* data_ptr, size_t size, int64_t offset) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleWrite); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_write_at(id, agfs::Span<const uint8_t>(data_ptr, size), offset); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        metric_scope.bytes_in((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = new position, high 32 bits = error ptr (0 = success) */ \
+    __attribute__((export_name("handle_seek"))) \
+    uint64_t handle_seek(int64_t id, int64_t offset, int32_t whence) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleSeek); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_seek(id, offset, whence); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    __attribute__((export_name("handle_sync"))) \
+    char* handle_sync(int64_t id) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleSync); \
+        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+        auto result = g_plugin_instance->handle_sync(id); \
+        if (result.is_err()) { \
+            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+        } \
+        return nullptr; \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = json ptr, high 32 bits = error ptr */ \
+    __attribute__((export_name("handle_stat"))) \
+    uint64_t handle_stat(int64_t id) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleStat); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(agfs::ffi::copy_string("not initialized"))); \
+        auto result = g_plugin_instance->handle_stat(id); \
+        if (result.is_err()) { \
+            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::pack_u64(0, agfs::ffi::ptr_u32(err_ptr)); \
+        } \
+        std::string json = agfs::ffi::JsonParser::serialize_fileinfo(result.unwrap()); \
+        char* json_ptr = agfs::ffi::copy_string(json); \
+        return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(json_ptr), 0); \
+    } \
+    \
+    __attribute__((export_name("handle_close"))) \
+    char* handle_close(int64_t id) { \
+        agfs::CallArenaScope call_scope; \
+        agfs::MetricScope metric_scope(agfs::Metric::HandleClose); \
+        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+        auto result = g_plugin_instance->handle_close(id); \
+        if (result.is_err()) { \
+            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+        } \
+        return nullptr; \
+    } \
+    \
     } /* extern "C" */
 
 #endif // AGFS_EXPORT_H
@@ -2,11 +2,16 @@
 #define AGFS_FFI_H
 
 #include "agfs_types.h"
-#include "json.hpp"
+#include "agfs_json.h"
 #include <cstring>
 #include <cstdlib>
 
+// nlohmann/json is not used by the SDK itself; define AGFS_WITH_NLOHMANN
+// to have it included for plugins that want a general-purpose JSON library.
+#ifdef AGFS_WITH_NLOHMANN
+#include "json.hpp"
 using json = nlohmann::json;
+#endif
 
 namespace agfs {
 namespace ffi {
@@ -38,6 +43,12 @@ inline std::string read_string(const char* ptr) {
     return std::string(ptr);
 }
 
+// Address of p in the 32-bit wasm address space
+// Truncates on 64-bit hosts, which only native benchmarks ever see.
+inline uint32_t ptr_u32(const void* p) {
+    return (uint32_t)(uintptr_t)p;
+}
+
 // Pack two u32 into u64
 inline uint64_t pack_u64(uint32_t low, uint32_t high) {
     return ((uint64_t)high << 32) | (uint64_t)low;
@@ -49,104 +60,325 @@ inline void unpack_u64(uint64_t packed, uint32_t& low, uint32_t& high) {
     high = (uint32_t)((packed >> 32) & 0xFFFFFFFF);
 }
 
-// JSON parsing helpers using nlohmann/json
+// JSON helpers for the FFI boundary, built on the JsonCodec shapes in
+// agfs_json.h. Malformed input yields a default-constructed value.
 class JsonParser {
 public:
     static Config parse_config(const char* json_str) {
         Config config;
-        if (json_str == nullptr) {
-            return config;
+        if (json_str == nullptr || !from_json(json_str, config)) {
+            return Config();
         }
+        return config;
+    }
 
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_object()) {
-            return config;
-        }
+    static std::string serialize_fileinfo(const FileInfo& info) {
+        return to_json(info);
+    }
 
-        for (auto& [key, value] : j.items()) {
-            if (value.is_string()) {
-                config.values[key] = value.get<std::string>();
-            } else if (value.is_number()) {
-                config.values[key] = std::to_string(value.get<double>());
-            } else if (value.is_boolean()) {
-                config.values[key] = value.get<bool>() ? "true" : "false";
-            }
+    static std::string serialize_fileinfo_array(const std::vector<FileInfo>& infos) {
+        return to_json(infos);
+    }
+
+    static FileInfo parse_fileinfo(const std::string& json_str) {
+        FileInfo info;
+        if (!from_json(json_str, info)) {
+            return FileInfo();
         }
+        return info;
+    }
 
-        return config;
+    static std::vector<FileInfo> parse_fileinfo_array(const std::string& json_str) {
+        std::vector<FileInfo> infos;
+        if (!from_json(json_str, infos)) {
+            return {};
+        }
+        return infos;
     }
+};
 
-    static std::string serialize_fileinfo(const FileInfo& info) {
-        json j = {
-            {"Name", info.name},
-            {"Size", info.size},
-            {"Mode", info.mode},
-            {"ModTime", "0001-01-01T00:00:00Z"},
-            {"IsDir", info.is_dir}
-        };
+// Compact binary encoding of FileInfo, used by fs_stat_bin/fs_readdir_bin
+// so the host can skip JSON on large listings.
+//
+// Layout (integers are little-endian, the native wasm byte order):
+//   u32 total_len        - size of the whole buffer, including this header
+//   u32 count            - number of records
+//   record[count]:
+//     u32 record_len     - bytes that follow in this record
+//     i64 size
+//     u32 mode
+//     i64 mod_time       - unix seconds (0 = unset)
+//     u8  flags          - bit 0 = is_dir, bit 1 = has meta
+//     u32 name_len, name bytes
+//     [has meta] u32 len + meta name, u32 len + meta type, u32 len + meta content (JSON)
+class BinaryCodec {
+public:
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr uint8_t FLAG_DIR = 1 << 0;
+    static constexpr uint8_t FLAG_META = 1 << 1;
 
+    // Size of one record, excluding its record_len prefix
+    static size_t record_size(const FileInfo& info) {
+        size_t n = 8 + 4 + 8 + 1 + 4 + info.name.size();
         if (info.meta.has_value()) {
-            auto meta_content = json::parse(info.meta->content, nullptr, false);
-            j["Meta"] = {
-                {"Name", info.meta->name},
-                {"Type", info.meta->type},
-                {"Content", meta_content.is_discarded() ? json{} : meta_content}
-            };
+            n += 12 + info.meta->name.size() + info.meta->type.size() + info.meta->content.size();
         }
+        return n;
+    }
 
-        return j.dump();
+    static size_t encoded_size(const FileInfo* infos, size_t count) {
+        size_t n = HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            n += 4 + record_size(infos[i]);
+        }
+        return n;
     }
 
-    static std::string serialize_fileinfo_array(const std::vector<FileInfo>& infos) {
-        json j = json::array();
-        for (const auto& info : infos) {
-            j.push_back({
-                {"Name", info.name},
-                {"Size", info.size},
-                {"Mode", info.mode},
-                {"ModTime", "0001-01-01T00:00:00Z"},
-                {"IsDir", info.is_dir}
-            });
+    // Encode into out, which must hold encoded_size(infos, count) bytes
+    // Returns: Number of bytes written
+    static size_t encode(const FileInfo* infos, size_t count, uint8_t* out) {
+        uint8_t* p = out + HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            const FileInfo& info = infos[i];
+            p = put_u32(p, (uint32_t)record_size(info));
+            p = put_raw(p, &info.size, 8);
+            p = put_u32(p, info.mode);
+            p = put_raw(p, &info.mod_time, 8);
+            *p++ = (info.is_dir ? FLAG_DIR : 0) | (info.meta.has_value() ? FLAG_META : 0);
+            p = put_str(p, info.name);
+            if (info.meta.has_value()) {
+                p = put_str(p, info.meta->name);
+                p = put_str(p, info.meta->type);
+                p = put_str(p, info.meta->content);
+            }
         }
-        return j.dump();
+        size_t total = p - out;
+        put_u32(out, (uint32_t)total);
+        put_u32(out + 4, (uint32_t)count);
+        return total;
     }
 
-    static FileInfo parse_fileinfo(const std::string& json_str) {
-        FileInfo info;
+private:
+    static uint8_t* put_raw(uint8_t* p, const void* v, size_t n) {
+        std::memcpy(p, v, n);
+        return p + n;
+    }
+
+    static uint8_t* put_u32(uint8_t* p, uint32_t v) {
+        return put_raw(p, &v, 4);
+    }
+
+    static uint8_t* put_str(uint8_t* p, const std::string& s) {
+        p = put_u32(p, (uint32_t)s.size());
+        return put_raw(p, s.data(), s.size());
+    }
+};
+
+// Bounds-checked little-endian cursor over an encoded buffer
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : p_(data), end_(data + size), ok_(true) {}
+
+    bool ok() const { return ok_; }
+
+    uint8_t u8() {
+        uint8_t v = 0;
+        raw(&v, 1);
+        return v;
+    }
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        raw(&v, 4);
+        return v;
+    }
+
+    int64_t i64() {
+        int64_t v = 0;
+        raw(&v, 8);
+        return v;
+    }
 
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_object()) {
-            return info;
+    // Length-prefixed bytes; returns nullptr (and len 0) past the end
+    const uint8_t* bytes(uint32_t& len) {
+        len = u32();
+        if (!ok_ || (size_t)(end_ - p_) < len) {
+            ok_ = false;
+            len = 0;
+            return nullptr;
         }
+        const uint8_t* start = p_;
+        p_ += len;
+        return start;
+    }
 
-        info.name = j.value("Name", "");
-        info.size = j.value("Size", 0);
-        info.mode = j.value("Mode", 0);
-        info.is_dir = j.value("IsDir", false);
+    // Length-prefixed string
+    std::string str() {
+        uint32_t len = 0;
+        const uint8_t* p = bytes(len);
+        return p ? std::string(reinterpret_cast<const char*>(p), len) : std::string();
+    }
 
-        return info;
+private:
+    void raw(void* v, size_t n) {
+        if (!ok_ || (size_t)(end_ - p_) < n) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(v, p_, n);
+        p_ += n;
     }
 
-    static std::vector<FileInfo> parse_fileinfo_array(const std::string& json_str) {
-        std::vector<FileInfo> infos;
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_;
+};
+
+// Size limits of one fs_batch result and of the whole response
+#ifndef AGFS_BATCH_MAX_OP_BYTES
+#define AGFS_BATCH_MAX_OP_BYTES (16u << 20) /* 16MB */
+#endif
+#ifndef AGFS_BATCH_MAX_RESPONSE_BYTES
+#define AGFS_BATCH_MAX_RESPONSE_BYTES (64u << 20) /* 64MB */
+#endif
+
+// Limits of one fs_readv request: segments and bytes read over all of them
+#ifndef AGFS_READV_MAX_SEGMENTS
+#define AGFS_READV_MAX_SEGMENTS 4096u
+#endif
+#ifndef AGFS_READV_MAX_BYTES
+#define AGFS_READV_MAX_BYTES (64u << 20) /* 64MB */
+#endif
+
+// Packed request/response format of the fs_batch export
+// All integers are little-endian.
+//
+// Request:
+//   u32 count
+//   count ops:
+//     u8  opcode         - OP_STAT, OP_READ, OP_READDIR or OP_WRITE
+//     u32 path_len, path bytes
+//     [OP_READ]  i64 offset, i64 size
+//     [OP_WRITE] i64 offset, u32 flags, u32 data_len, data bytes
+//
+// Response:
+//   u32 total_len        - including this header
+//   u32 count            - same as the request
+//   count results, in request order:
+//     u8  opcode
+//     u8  status         - STATUS_OK, or 1 + ErrorKind on failure
+//     u32 payload_len, payload
+//       ok:    OP_STAT/OP_READDIR = BinaryCodec buffer, OP_READ = file bytes,
+//              OP_WRITE = i64 bytes written
+//       error: error message
+//
+// A record whose payload would exceed MAX_OP_BYTES, or push the response
+// past MAX_RESPONSE_BYTES, is replaced by an InvalidInput error record.
+class BatchCodec {
+public:
+    static constexpr uint8_t OP_STAT = 1;
+    static constexpr uint8_t OP_READ = 2;
+    static constexpr uint8_t OP_READDIR = 3;
+    static constexpr uint8_t OP_WRITE = 4;
 
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_array()) {
-            return infos;
+    static constexpr uint8_t STATUS_OK = 0;
+
+    static constexpr size_t MAX_OP_BYTES = AGFS_BATCH_MAX_OP_BYTES;
+    static constexpr size_t MAX_RESPONSE_BYTES = AGFS_BATCH_MAX_RESPONSE_BYTES;
+    static constexpr size_t RECORD_HEADER_SIZE = 6;
+
+    static uint8_t error_status(const Error& err) {
+        return (uint8_t)(1 + (uint8_t)err.kind);
+    }
+
+    using Reader = ByteReader;
+
+    // Response under construction, in wasm_malloc memory so large ones reach
+    // the host without another copy
+    class Response {
+    public:
+        Response() = default;
+        Response(const Response&) = delete;
+        Response& operator=(const Response&) = delete;
+        ~Response() { wasm_free(data_); }
+
+        uint8_t* data() { return data_; }
+        size_t size() const { return size_; }
+
+        // Returns: false if memory is exhausted (the contents are kept)
+        bool resize(size_t n) {
+            if (n > capacity_) {
+                size_t capacity = capacity_ < 256 ? 256 : capacity_;
+                while (capacity < n) {
+                    capacity *= 2;
+                }
+                void* p = std::realloc(data_, capacity);
+                if (!p) {
+                    return false;
+                }
+                data_ = static_cast<uint8_t*>(p);
+                capacity_ = capacity;
+            }
+            size_ = n;
+            return true;
+        }
+
+        // Hand the buffer over; the caller frees it with wasm_free
+        uint8_t* release() {
+            uint8_t* p = data_;
+            data_ = nullptr;
+            size_ = capacity_ = 0;
+            return p;
         }
 
-        for (const auto& item : j) {
-            if (!item.is_object()) continue;
+    private:
+        uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        size_t capacity_ = 0;
+    };
 
-            FileInfo info;
-            info.name = item.value("Name", "");
-            info.size = item.value("Size", 0);
-            info.mode = item.value("Mode", 0);
-            info.is_dir = item.value("IsDir", false);
-            infos.push_back(info);
+    // Whether a record with this payload fits the per-op and total limits
+    static bool fits(const Response& out, size_t payload_len) {
+        return payload_len <= MAX_OP_BYTES &&
+               payload_len + RECORD_HEADER_SIZE <= MAX_RESPONSE_BYTES - out.size();
+    }
+
+    // Append one result record and return a pointer to its payload
+    // Returns: nullptr if the record does not fit (see fits) or memory is exhausted
+    static uint8_t* append_result(Response& out, uint8_t opcode, uint8_t status, size_t payload_len) {
+        size_t at = out.size();
+        if (!fits(out, payload_len) || !out.resize(at + RECORD_HEADER_SIZE + payload_len)) {
+            return nullptr;
         }
+        uint32_t len = (uint32_t)payload_len;
+        out.data()[at] = opcode;
+        out.data()[at + 1] = status;
+        std::memcpy(out.data() + at + 2, &len, 4);
+        return out.data() + at + RECORD_HEADER_SIZE;
+    }
 
-        return infos;
+    // Shrink the payload of the last record appended with append_result
+    static void truncate_result(Response& out, size_t record_start, size_t payload_len) {
+        uint32_t len = (uint32_t)payload_len;
+        std::memcpy(out.data() + record_start + 2, &len, 4);
+        out.resize(record_start + RECORD_HEADER_SIZE + payload_len);
+    }
+
+    // Returns: false if not even the error record fits
+    static bool append_error(Response& out, uint8_t opcode, const Error& err) {
+        std::string msg = err.to_string();
+        uint8_t* p = append_result(out, opcode, error_status(err), msg.size());
+        if (!p) {
+            return false;
+        }
+        std::memcpy(p, msg.data(), msg.size());
+        return true;
+    }
+
+    // The error recorded for a result that does not fit
+    static Error too_large(size_t payload_len) {
+        return Error::invalid_input("batch result of " + std::to_string(payload_len) +
+                                    " bytes exceeds the batch size limits");
     }
 };
 
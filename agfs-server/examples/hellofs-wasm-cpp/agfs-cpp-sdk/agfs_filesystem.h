@@ -2,8 +2,65 @@
 #define AGFS_FILESYSTEM_H
 
 #include "agfs_types.h"
+#include <cstring>
+#include <cstdlib>
 
 namespace agfs {
+namespace internal {
+
+// Cut one page out of a full listing, using a decimal entry offset as cursor
+// Shared by the default readdir_page() implementations.
+inline DirPage slice_dir_page(std::vector<FileInfo>& all, const std::string& cursor, size_t max_entries) {
+    size_t start = cursor.empty() ? 0 : (size_t)std::strtoull(cursor.c_str(), nullptr, 10);
+    if (start > all.size()) {
+        start = all.size();
+    }
+    size_t end = (max_entries > 0 && max_entries < all.size() - start) ? start + max_entries : all.size();
+
+    DirPage page;
+    page.entries.reserve(end - start);
+    for (size_t i = start; i < end; i++) {
+        page.entries.push_back(std::move(all[i]));
+    }
+    if (end < all.size()) {
+        page.next_cursor = std::to_string(end);
+    }
+    return page;
+}
+
+// Default readv(): one read_into() per segment
+template<typename FS, typename Path>
+Result<void> readv_each(FS& fs, const Path& path, Span<ReadSegment> segments) {
+    for (auto& seg : segments) {
+        auto result = fs.read_into(path, seg.offset, seg.buf);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        seg.count = result.unwrap();
+    }
+    return Result<void>();
+}
+
+// Default writev(): one write() per segment, data converted by to_data
+template<typename FS, typename Path, typename ToData>
+Result<int64_t> writev_each(FS& fs, const Path& path, Span<const WriteSegment> segments,
+                            WriteFlag flags, ToData to_data) {
+    int64_t total = 0;
+    for (const auto& seg : segments) {
+        auto result = fs.write(path, to_data(seg.data), seg.offset, flags);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        total += result.unwrap();
+        if (result.unwrap() < (int64_t)seg.data.size()) {
+            break;
+        }
+        flags = WriteFlag(flags.value & ~WriteFlag::TRUNCATE.value);
+    }
+    return total;
+}
+
+} // namespace internal
 
 // FileSystem base class that plugin developers should implement
 class FileSystem {
@@ -35,12 +92,60 @@ public:
         return Result<void>();
     }
 
+    // True when config makes the plugin keep state that later calls must see,
+    // such as unflushed writes; the host then refuses to spread the mount
+    // over several instances that do not share memory
+    virtual bool single_instance(const Config& config) const {
+        (void)config; // unused
+        return false;
+    }
+
+    // Snapshot the state initialize() built, for import_state() on new
+    // instances (see agfs_state.h). An empty buffer, the default, makes the
+    // host re-run initialize() on each instance instead.
+    virtual Result<std::vector<uint8_t>> export_state() {
+        return std::vector<uint8_t>();
+    }
+
+    // Restore an export_state() snapshot in place of initialize()
+    virtual Result<void> import_state(Span<const uint8_t> state) {
+        (void)state; // unused
+        return Error::other("import_state not implemented");
+    }
+
     // Read data from a file
     virtual Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) {
         (void)path; (void)offset; (void)size; // unused
         return Error::read_only();
     }
 
+    // Read data from a file directly into a caller-provided buffer
+    // Reads at most buf.size() bytes starting at offset.
+    // Returns: Number of bytes stored in buf
+    // The default implementation falls back to read() and copies the result;
+    // override it to serve small reads without allocating.
+    virtual Result<int64_t> read_into(const std::string& path, int64_t offset, Span<uint8_t> buf) {
+        auto result = read(path, offset, static_cast<int64_t>(buf.size()));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        const auto& data = result.unwrap();
+        size_t n = data.size() < buf.size() ? data.size() : buf.size();
+        if (n > 0) {
+            std::memcpy(buf.data(), data.data(), n);
+        }
+        return static_cast<int64_t>(n);
+    }
+
+    // Read several ranges of one file in a single call
+    // Fills each segment's buf from its offset and sets its count.
+    // The default calls read_into() once per segment; backends that can
+    // fetch many ranges per upstream request (object stores) should
+    // override it and coalesce them.
+    virtual Result<void> readv(const std::string& path, Span<ReadSegment> segments) {
+        return internal::readv_each(*this, path, segments);
+    }
+
     // Write data to a file
     // Arguments:
     //   path - The file path
@@ -53,6 +158,17 @@ public:
         return Error::read_only();
     }
 
+    // Write several ranges of one file in a single call
+    // TRUNCATE in flags applies before the first segment only.
+    // Returns: Total bytes written; stops after the first short write. On an
+    // error, segments before the failing one may already have been written.
+    // The default calls write() once per segment.
+    virtual Result<int64_t> writev(const std::string& path, Span<const WriteSegment> segments, WriteFlag flags) {
+        return internal::writev_each(*this, path, segments, flags, [](Span<const uint8_t> data) {
+            return std::vector<uint8_t>(data.begin(), data.end());
+        });
+    }
+
     // Create a new empty file
     virtual Result<void> create(const std::string& path) {
         (void)path; // unused
@@ -83,6 +199,23 @@ public:
     // List directory contents
     virtual Result<std::vector<FileInfo>> readdir(const std::string& path) = 0;
 
+    // List one page of directory contents
+    // Arguments:
+    //   path - The directory path
+    //   cursor - Continuation token from the previous page (empty for the first page)
+    //   max_entries - Upper bound on the number of entries to return
+    // Returns: The entries and the cursor of the next page (empty when done)
+    // The default pages over readdir() using a decimal offset as the cursor;
+    // plugins with paginated backends should override it and pass their own
+    // continuation tokens through.
+    virtual Result<DirPage> readdir_page(const std::string& path, const std::string& cursor, size_t max_entries) {
+        auto result = readdir(path);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        return internal::slice_dir_page(result.unwrap(), cursor, max_entries);
+    }
+
     // Rename/move a file or directory
     virtual Result<void> rename(const std::string& old_path, const std::string& new_path) {
         (void)old_path; (void)new_path; // unused
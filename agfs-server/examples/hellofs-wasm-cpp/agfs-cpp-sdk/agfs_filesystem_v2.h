@@ -0,0 +1,219 @@
+#ifndef AGFS_FILESYSTEM_V2_H
+#define AGFS_FILESYSTEM_V2_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace agfs {
+
+// FileSystemV2 is the zero-copy variant of FileSystem
+// Paths arrive as std::string_view and write data as Span<const uint8_t>, both
+// pointing straight into the memory the host wrote the arguments to, so no
+// export copies them before the virtual call. The views are only valid for
+// the duration of the call; copy anything that has to be kept.
+//
+// The method set mirrors FileSystem and AGFS_EXPORT_PLUGIN picks the right
+// argument types automatically. FileSystemV2 is a separate root class, so it
+// cannot be combined with HandleFileSystem.
+class FileSystemV2 {
+public:
+    virtual ~FileSystemV2() = default;
+
+    // Returns the name of this filesystem plugin
+    virtual const char* name() const = 0;
+
+    // Returns the README/documentation for this plugin
+    virtual const char* readme() const {
+        return "No documentation available";
+    }
+
+    // Validate the configuration before initialization
+    virtual Result<void> validate(const Config& config) {
+        (void)config; // unused
+        return Result<void>();
+    }
+
+    // Initialize the filesystem with the given configuration
+    virtual Result<void> initialize(const Config& config) {
+        (void)config; // unused
+        return Result<void>();
+    }
+
+    // Shutdown the filesystem
+    virtual Result<void> shutdown() {
+        return Result<void>();
+    }
+
+    // True when config makes the plugin keep state that later calls must see,
+    // such as unflushed writes; the host then refuses to spread the mount
+    // over several instances that do not share memory
+    virtual bool single_instance(const Config& config) const {
+        (void)config; // unused
+        return false;
+    }
+
+    // Snapshot the state initialize() built, for import_state() on new
+    // instances (see agfs_state.h). An empty buffer, the default, makes the
+    // host re-run initialize() on each instance instead.
+    virtual Result<std::vector<uint8_t>> export_state() {
+        return std::vector<uint8_t>();
+    }
+
+    // Restore an export_state() snapshot in place of initialize()
+    virtual Result<void> import_state(Span<const uint8_t> state) {
+        (void)state; // unused
+        return Error::other("import_state not implemented");
+    }
+
+    // Read data from a file
+    virtual Result<std::vector<uint8_t>> read(std::string_view path, int64_t offset, int64_t size) {
+        (void)path; (void)offset; (void)size; // unused
+        return Error::read_only();
+    }
+
+    // Read data from a file directly into a caller-provided buffer
+    // Returns: Number of bytes stored in buf (defaults to read() plus a copy)
+    virtual Result<int64_t> read_into(std::string_view path, int64_t offset, Span<uint8_t> buf) {
+        auto result = read(path, offset, static_cast<int64_t>(buf.size()));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        const auto& data = result.unwrap();
+        size_t n = data.size() < buf.size() ? data.size() : buf.size();
+        if (n > 0) {
+            std::memcpy(buf.data(), data.data(), n);
+        }
+        return static_cast<int64_t>(n);
+    }
+
+    // Read several ranges of one file (see FileSystem::readv)
+    virtual Result<void> readv(std::string_view path, Span<ReadSegment> segments) {
+        return internal::readv_each(*this, path, segments);
+    }
+
+    // Write data to a file
+    // Arguments:
+    //   path - The file path
+    //   data - Data to write (a view of host-written memory)
+    //   offset - Position to write at (-1 for append mode behavior)
+    //   flags - Write flags (CREATE, TRUNCATE, APPEND, etc.)
+    // Returns: Number of bytes written
+    virtual Result<int64_t> write(std::string_view path, Span<const uint8_t> data, int64_t offset, WriteFlag flags) {
+        (void)path; (void)data; (void)offset; (void)flags; // unused
+        return Error::read_only();
+    }
+
+    // Write several ranges of one file (see FileSystem::writev)
+    // Segment data points into host-written memory, like write().
+    virtual Result<int64_t> writev(std::string_view path, Span<const WriteSegment> segments, WriteFlag flags) {
+        return internal::writev_each(*this, path, segments, flags, [](Span<const uint8_t> data) {
+            return data;
+        });
+    }
+
+    // Create a new empty file
+    virtual Result<void> create(std::string_view path) {
+        (void)path; // unused
+        return Error::read_only();
+    }
+
+    // Create a new directory
+    virtual Result<void> mkdir(std::string_view path, uint32_t perm) {
+        (void)path; (void)perm; // unused
+        return Error::read_only();
+    }
+
+    // Remove a file or empty directory
+    virtual Result<void> remove(std::string_view path) {
+        (void)path; // unused
+        return Error::read_only();
+    }
+
+    // Remove a file or directory and all its contents
+    virtual Result<void> remove_all(std::string_view path) {
+        (void)path; // unused
+        return Error::read_only();
+    }
+
+    // Get file information
+    virtual Result<FileInfo> stat(std::string_view path) = 0;
+
+    // List directory contents
+    virtual Result<std::vector<FileInfo>> readdir(std::string_view path) = 0;
+
+    // List one page of directory contents (see FileSystem::readdir_page)
+    virtual Result<DirPage> readdir_page(std::string_view path, std::string_view cursor, size_t max_entries) {
+        auto result = readdir(path);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        return internal::slice_dir_page(result.unwrap(), std::string(cursor), max_entries);
+    }
+
+    // Rename/move a file or directory
+    virtual Result<void> rename(std::string_view old_path, std::string_view new_path) {
+        (void)old_path; (void)new_path; // unused
+        return Error::read_only();
+    }
+
+    // Change file permissions
+    virtual Result<void> chmod(std::string_view path, uint32_t mode) {
+        (void)path; (void)mode; // unused
+        return Result<void>(); // Default: no-op
+    }
+};
+
+namespace internal {
+
+// Argument conversion for the export macros
+// FileSystem plugins get owned std::string/std::vector copies; FileSystemV2
+// plugins get views of the host-written memory.
+template<typename T, bool ZeroCopy = std::is_base_of<FileSystemV2, T>::value>
+struct PluginArgs;
+
+template<typename T>
+struct PluginArgs<T, false> {
+    static std::string path(const char* ptr) {
+        return ptr ? std::string(ptr) : std::string();
+    }
+
+    static std::string path(const char* ptr, size_t len) {
+        return std::string(ptr, len);
+    }
+
+    static std::vector<uint8_t> data(const uint8_t* ptr, size_t size) {
+        return std::vector<uint8_t>(ptr, ptr + size);
+    }
+};
+
+template<typename T>
+struct PluginArgs<T, true> {
+    static std::string_view path(const char* ptr) {
+        return ptr ? std::string_view(ptr) : std::string_view();
+    }
+
+    static std::string_view path(const char* ptr, size_t len) {
+        return std::string_view(ptr, len);
+    }
+
+    static Span<const uint8_t> data(const uint8_t* ptr, size_t size) {
+        return Span<const uint8_t>(ptr, size);
+    }
+};
+
+// True if T overrides readdir_page rather than inheriting the default, which
+// re-runs readdir() for every page
+template<typename T>
+struct HasNativeReaddirPage : std::integral_constant<bool,
+    !std::is_same<decltype(&T::readdir_page), decltype(&FileSystem::readdir_page)>::value &&
+    !std::is_same<decltype(&T::readdir_page), decltype(&FileSystemV2::readdir_page)>::value> {};
+
+} // namespace internal
+
+} // namespace agfs
+
+#endif // AGFS_FILESYSTEM_V2_H
@@ -0,0 +1,275 @@
+#ifndef AGFS_HANDLEFS_H
+#define AGFS_HANDLEFS_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_sync.h"
+#include <memory>
+#include <unordered_map>
+
+namespace agfs {
+
+// FileHandle holds the per-open state of a file opened through HandleFileSystem
+// Implementations provide positional I/O; the cursor-based read/write/seek
+// used by handle_read/handle_write/handle_seek are built on top of it.
+class FileHandle {
+public:
+    FileHandle(const std::string& path, OpenFlag flags)
+        : path_(path), flags_(flags), position_(0) {}
+    virtual ~FileHandle() = default;
+
+    const std::string& path() const { return path_; }
+    OpenFlag flags() const { return flags_; }
+    int64_t position() const { return position_; }
+
+    // Read up to buf.size() bytes from the specified offset (pread)
+    // Returns: Number of bytes read (0 at end of file)
+    virtual Result<int64_t> read_at(Span<uint8_t> buf, int64_t offset) = 0;
+
+    // Write data at the specified offset (pwrite)
+    // Returns: Number of bytes written
+    virtual Result<int64_t> write_at(Span<const uint8_t> data, int64_t offset) {
+        (void)data; (void)offset; // unused
+        return Error::read_only();
+    }
+
+    // Get file information
+    virtual Result<FileInfo> stat() = 0;
+
+    // Flush buffered data to storage
+    virtual Result<void> sync() {
+        return Result<void>();
+    }
+
+    // Release resources; called once before the handle is destroyed
+    virtual Result<void> close() {
+        return Result<void>();
+    }
+
+    // Read from the current position and advance it
+    Result<int64_t> read(Span<uint8_t> buf) {
+        auto result = read_at(buf, position_);
+        if (result.is_ok()) {
+            position_ += result.unwrap();
+        }
+        return result;
+    }
+
+    // Write at the current position (or the end of file with APPEND) and advance it
+    Result<int64_t> write(Span<const uint8_t> data) {
+        int64_t offset = position_;
+        if (flags_.contains(OpenFlag::APPEND)) {
+            auto info = stat();
+            if (info.is_err()) {
+                return info.unwrap_err();
+            }
+            offset = info.unwrap().size;
+        }
+        auto result = write_at(data, offset);
+        if (result.is_ok()) {
+            position_ = offset + result.unwrap();
+        }
+        return result;
+    }
+
+    // Move the cursor
+    // whence: 0 = SEEK_SET (from start), 1 = SEEK_CUR (from current), 2 = SEEK_END (from end)
+    Result<int64_t> seek(int64_t offset, int32_t whence) {
+        int64_t base = 0;
+        switch (whence) {
+            case 0:
+                base = 0;
+                break;
+            case 1:
+                base = position_;
+                break;
+            case 2: {
+                auto info = stat();
+                if (info.is_err()) {
+                    return info.unwrap_err();
+                }
+                base = info.unwrap().size;
+                break;
+            }
+            default:
+                return Error::invalid_input("invalid whence");
+        }
+        if (base + offset < 0) {
+            return Error::invalid_input("negative position");
+        }
+        position_ = base + offset;
+        return position_;
+    }
+
+private:
+    std::string path_;
+    OpenFlag flags_;
+    int64_t position_;
+};
+
+// PathFileHandle forwards handle I/O to the path-based FileSystem methods
+// This is the default handle type; it keeps only the cursor between calls.
+class PathFileHandle : public FileHandle {
+public:
+    PathFileHandle(FileSystem& fs, const std::string& path, OpenFlag flags)
+        : FileHandle(path, flags), fs_(fs) {}
+
+    Result<int64_t> read_at(Span<uint8_t> buf, int64_t offset) override {
+        return fs_.read_into(path(), offset, buf);
+    }
+
+    Result<int64_t> write_at(Span<const uint8_t> data, int64_t offset) override {
+        std::vector<uint8_t> buf(data.begin(), data.end());
+        return fs_.write(path(), buf, offset, WriteFlag::NONE);
+    }
+
+    Result<FileInfo> stat() override {
+        return fs_.stat(path());
+    }
+
+private:
+    FileSystem& fs_;
+};
+
+// HandleFileSystem extends FileSystem with stateful file handles
+// Export it with AGFS_EXPORT_HANDLE_PLUGIN to make the host use handle_* calls
+// (FUSE opens, large reads) instead of stateless fs_read/fs_write.
+class HandleFileSystem : public FileSystem {
+public:
+    // Open a file and return its per-open state
+    // The default honors CREATE/EXCL/TRUNC through stat()/create()/write() and
+    // returns a PathFileHandle. Override it to keep cursors, decoded blocks or
+    // upstream connections alive between calls.
+    virtual Result<std::unique_ptr<FileHandle>> open_handle(const std::string& path, OpenFlag flags, uint32_t mode) {
+        (void)mode; // unused
+        auto info = stat(path);
+        if (info.is_ok()) {
+            if (flags.contains(OpenFlag::CREATE) && flags.contains(OpenFlag::EXCL)) {
+                return Error::already_exists();
+            }
+            if (info.unwrap().is_dir) {
+                return Error::is_directory();
+            }
+        } else if (flags.contains(OpenFlag::CREATE)) {
+            auto created = create(path);
+            if (created.is_err()) {
+                return created.unwrap_err();
+            }
+        } else {
+            return info.unwrap_err();
+        }
+
+        if (flags.contains(OpenFlag::TRUNC) && flags.is_writable()) {
+            auto truncated = write(path, std::vector<uint8_t>(), 0, WriteFlag::TRUNCATE);
+            if (truncated.is_err()) {
+                return truncated.unwrap_err();
+            }
+        }
+
+        return std::unique_ptr<FileHandle>(new PathFileHandle(*this, path, flags));
+    }
+
+    // Handle table operations (used by AGFS_EXPORT_HANDLE_PLUGIN)
+    // The table is locked in threaded builds; an operation keeps its handle
+    // alive even if another worker closes it meanwhile.
+
+    Result<int64_t> handle_open(const std::string& path, OpenFlag flags, uint32_t mode) {
+        auto result = open_handle(path, flags, mode);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        internal::LockGuard lock(handles_mu_);
+        int64_t id = next_handle_id_++;
+        handles_[id] = std::shared_ptr<FileHandle>(std::move(result.unwrap()));
+        return id;
+    }
+
+    Result<int64_t> handle_read(int64_t id, Span<uint8_t> buf) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        if (!h->flags().is_readable()) return Error::permission_denied();
+        return h->read(buf);
+    }
+
+    Result<int64_t> handle_read_at(int64_t id, Span<uint8_t> buf, int64_t offset) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        if (!h->flags().is_readable()) return Error::permission_denied();
+        return h->read_at(buf, offset);
+    }
+
+    Result<int64_t> handle_write(int64_t id, Span<const uint8_t> data) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        if (!h->flags().is_writable()) return Error::permission_denied();
+        return h->write(data);
+    }
+
+    Result<int64_t> handle_write_at(int64_t id, Span<const uint8_t> data, int64_t offset) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        if (!h->flags().is_writable()) return Error::permission_denied();
+        return h->write_at(data, offset);
+    }
+
+    Result<int64_t> handle_seek(int64_t id, int64_t offset, int32_t whence) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        return h->seek(offset, whence);
+    }
+
+    Result<void> handle_sync(int64_t id) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        return h->sync();
+    }
+
+    Result<FileInfo> handle_stat(int64_t id) {
+        auto h = acquire_handle(id);
+        if (!h) return handle_not_found();
+        return h->stat();
+    }
+
+    Result<void> handle_close(int64_t id) {
+        std::shared_ptr<FileHandle> h;
+        {
+            internal::LockGuard lock(handles_mu_);
+            auto it = handles_.find(id);
+            if (it == handles_.end()) return handle_not_found();
+            h = std::move(it->second);
+            handles_.erase(it);
+        }
+        return h->close();
+    }
+
+    // Look up an open handle, or nullptr if the ID is unknown
+    // The pointer is valid until the handle is closed.
+    FileHandle* find_handle(int64_t id) {
+        return acquire_handle(id).get();
+    }
+
+    // Look up an open handle and share ownership of it
+    std::shared_ptr<FileHandle> acquire_handle(int64_t id) {
+        internal::LockGuard lock(handles_mu_);
+        auto it = handles_.find(id);
+        return it != handles_.end() ? it->second : nullptr;
+    }
+
+    size_t open_handle_count() const {
+        internal::LockGuard lock(handles_mu_);
+        return handles_.size();
+    }
+
+private:
+    static Error handle_not_found() {
+        return Error(ErrorKind::NotFound, "handle not found");
+    }
+
+    std::unordered_map<int64_t, std::shared_ptr<FileHandle>> handles_;
+    int64_t next_handle_id_ = 1;
+    mutable internal::Mutex handles_mu_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_HANDLEFS_H
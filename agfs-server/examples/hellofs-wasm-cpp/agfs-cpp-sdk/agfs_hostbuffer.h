@@ -0,0 +1,97 @@
+#ifndef AGFS_HOSTBUFFER_H
+#define AGFS_HOSTBUFFER_H
+
+#include "agfs_types.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+// HostBuffer owns a buffer the host allocated in our linear memory
+// Host functions return data through the module's exported malloc; the
+// buffer is freed when the HostBuffer goes out of scope. It is move-only and
+// can be viewed without copying through span()/view().
+class HostBuffer {
+public:
+    HostBuffer() : data_(nullptr), size_(0) {}
+    HostBuffer(uint32_t ptr, size_t size)
+        : data_(reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(ptr))), size_(size) {}
+
+    // Take ownership of a packed u64 (lower 32 bits = pointer, upper 32 bits = size)
+    static HostBuffer from_packed(uint64_t packed) {
+        return HostBuffer((uint32_t)(packed & 0xFFFFFFFF), (size_t)((packed >> 32) & 0xFFFFFFFF));
+    }
+
+    // Take ownership of a null-terminated string (size excludes the terminator)
+    static HostBuffer from_cstr(uint32_t ptr) {
+        if (ptr == 0) {
+            return HostBuffer();
+        }
+        const char* str = reinterpret_cast<const char*>(static_cast<uintptr_t>(ptr));
+        return HostBuffer(ptr, std::strlen(str));
+    }
+
+    HostBuffer(const HostBuffer&) = delete;
+    HostBuffer& operator=(const HostBuffer&) = delete;
+
+    HostBuffer(HostBuffer&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    HostBuffer& operator=(HostBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~HostBuffer() {
+        reset();
+    }
+
+    // True if the host returned a buffer (a zero-length buffer is still valid)
+    bool is_valid() const { return data_ != nullptr; }
+    bool empty() const { return size_ == 0; }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    Span<const uint8_t> span() const { return Span<const uint8_t>(data_, size_); }
+    std::string_view view() const { return std::string_view(reinterpret_cast<const char*>(data_), size_); }
+
+    std::string to_string() const { return std::string(view()); }
+    std::vector<uint8_t> to_vector() const { return std::vector<uint8_t>(data_, data_ + size_); }
+
+    // Give up ownership; the caller becomes responsible for free()
+    uint8_t* release() {
+        uint8_t* ptr = data_;
+        data_ = nullptr;
+        size_ = 0;
+        return ptr;
+    }
+
+    // Free the buffer now
+    void reset() {
+        if (data_) {
+            std::free(data_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+    }
+
+private:
+    uint8_t* data_;
+    size_t size_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_HOSTBUFFER_H
@@ -3,7 +3,18 @@
 
 #include "agfs_types.h"
 #include "agfs_ffi.h"
+#include "agfs_hostbuffer.h"
+#include "agfs_metrics.h"
+#include "agfs_sync.h"
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
+
+// Bytes HostFS::map() may keep resident at once (see HostFS::set_map_budget)
+#ifndef AGFS_HOSTFS_MAP_BUDGET
+#define AGFS_HOSTFS_MAP_BUDGET (64 * 1024 * 1024)
+#endif
 
 namespace agfs {
 
@@ -15,6 +26,9 @@ extern "C" {
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_write")))
     uint64_t host_fs_write(const char* path, const uint8_t* data, uint32_t len);
 
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_write_at")))
+    uint64_t host_fs_write_at(const char* path, const uint8_t* data, uint32_t len, int64_t offset, uint32_t flags);
+
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_stat")))
     uint64_t host_fs_stat(const char* path);
 
@@ -38,9 +52,71 @@ extern "C" {
 
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_chmod")))
     uint32_t host_fs_chmod(const char* path, uint32_t mode);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_copy")))
+    uint32_t host_fs_copy(const char* src, const char* dst, int64_t src_offset, int64_t dst_offset,
+                          int64_t len, uint32_t flags, int64_t* copied);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_map")))
+    uint64_t host_fs_map(const char* path, int64_t offset, uint32_t len, uint8_t* dst);
+}
+
+namespace internal {
+
+// Regions placed by HostFS::map(), looked up linearly: plugins map a few
+// large ranges, not many small ones
+// A region whose bytes are still being read has no data yet; its reserved
+// size already counts in mapped so concurrent maps stay within budget.
+struct HostMapTable {
+    struct Region {
+        std::string path;
+        int64_t offset;
+        int64_t len; // as requested, -1 = to end of file
+        uint8_t* data;
+        size_t size; // as placed, short at end of file
+        uint32_t refs;
+        uint64_t id;
+    };
+
+    Mutex mu;
+    std::vector<Region> regions;
+    size_t budget = AGFS_HOSTFS_MAP_BUDGET;
+    size_t mapped = 0;
+    uint64_t next_id = 0;
+
+    // A placed region for the request, or nullptr; the caller holds mu
+    Region* find(const std::string& path, int64_t offset, int64_t len) {
+        for (auto& region : regions) {
+            if (region.data != nullptr && region.offset == offset && region.len == len && region.path == path) {
+                return &region;
+            }
+        }
+        return nullptr;
+    }
+
+    // Drop the region reserved under id; the caller holds mu
+    Region take(uint64_t id) {
+        for (size_t i = 0; i < regions.size(); i++) {
+            if (regions[i].id == id) {
+                Region region = std::move(regions[i]);
+                regions[i] = std::move(regions.back());
+                regions.pop_back();
+                return region;
+            }
+        }
+        return Region{};
+    }
+};
+
+inline HostMapTable& host_map_table() {
+    static HostMapTable table;
+    return table;
 }
 
+} // namespace internal
+
 // Helper to read string from pointer
+// Does not take ownership; use take_host_string() for host-allocated strings.
 inline std::string read_string_from_ptr(uint32_t ptr) {
     if (ptr == 0) {
         return "";
@@ -56,145 +132,331 @@ inline std::string read_string_from_ptr(uint32_t ptr) {
     return std::string(start_ptr, len);
 }
 
+// Error pointer the host returns when it could not write the message itself
+constexpr uint32_t HOST_ERROR_NO_MESSAGE = 1;
+
+// Copy a host-allocated string and free the original
+inline std::string take_host_string(uint32_t ptr) {
+    if (ptr == HOST_ERROR_NO_MESSAGE) {
+        return "host error (message unavailable)";
+    }
+    return HostBuffer::from_cstr(ptr).to_string();
+}
+
 // HostFS provides access to the host filesystem from WASM
 class HostFS {
 public:
+    // Read data from a file on the host filesystem without copying
+    // The returned buffer is freed when it goes out of scope.
+    static Result<HostBuffer> read_buffer(const std::string& path, int64_t offset, int64_t size) {
+        MetricScope metric_scope(Metric::HostFsRead);
+        // Lower 32 bits = pointer, upper 32 bits = size
+        HostBuffer buf = HostBuffer::from_packed(host_fs_read(path.c_str(), offset, size));
+        if (!buf.is_valid()) {
+            return Error::io("read failed");
+        }
+        metric_scope.bytes_in(buf.size());
+        return buf;
+    }
+
     // Read data from a file on the host filesystem
     static Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) {
-        uint64_t result = host_fs_read(path.c_str(), offset, size);
-
-        // Unpack: lower 32 bits = pointer, upper 32 bits = size
-        uint32_t data_ptr = (uint32_t)(result & 0xFFFFFFFF);
-        uint32_t data_size = (uint32_t)((result >> 32) & 0xFFFFFFFF);
-
-        if (data_ptr == 0) {
-            return Error::io("read failed");
+        auto result = read_buffer(path, offset, size);
+        if (result.is_err()) {
+            return result.unwrap_err();
         }
+        return result.unwrap().to_vector();
+    }
 
-        // Read data from memory
-        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data_ptr);
-        std::vector<uint8_t> data(ptr, ptr + data_size);
-        return data;
+    // Write data to a file on the host filesystem (create or truncate)
+    // Returns: Number of bytes written
+    // Goes through host_fs_write_at: host_fs_write reports failure as a zero
+    // count, which cannot be told apart from a successful empty write.
+    static Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data) {
+        return write_at(path, Span<const uint8_t>(data.data(), data.size()), 0,
+                        WriteFlag::CREATE | WriteFlag::TRUNCATE);
     }
 
-    // Write data to a file on the host filesystem
-    static Result<std::vector<uint8_t>> write(const std::string& path, const std::vector<uint8_t>& data) {
-        uint64_t result = host_fs_write(path.c_str(), data.data(), data.size());
+    // Write data at an offset on the host filesystem
+    // Arguments:
+    //   offset - Position to write at (-1 for append mode behavior)
+    //   flags - WriteFlag::APPEND/CREATE/EXCLUSIVE/TRUNCATE/SYNC, applied by the host filesystem
+    // Returns: Number of bytes written
+    static Result<int64_t> write_at(const std::string& path, Span<const uint8_t> data, int64_t offset, WriteFlag flags) {
+        MetricScope metric_scope(Metric::HostFsWrite);
+        metric_scope.bytes_out(data.size());
+        uint64_t result = host_fs_write_at(path.c_str(), data.data(), (uint32_t)data.size(), offset, flags.value);
 
-        // Unpack: lower 32 bits = pointer, upper 32 bits = size
-        uint32_t response_ptr = (uint32_t)(result & 0xFFFFFFFF);
-        uint32_t response_size = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+        // Unpack: lower 32 bits = error pointer, upper 32 bits = bytes written
+        uint32_t err_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t written = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
-        if (response_ptr == 0) {
-            return Error::io("write failed");
+        if (err_ptr != 0) {
+            return Error::other(take_host_string(err_ptr));
         }
-
-        // Read response from memory
-        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(response_ptr);
-        std::vector<uint8_t> response(ptr, ptr + response_size);
-        return response;
+        return static_cast<int64_t>(written);
     }
 
     // Get file information
     static Result<FileInfo> stat(const std::string& path) {
+        MetricScope metric_scope(Metric::HostFsStat);
         uint64_t result = host_fs_stat(path.c_str());
 
         // Unpack: lower 32 bits = json pointer, upper 32 bits = error pointer
-        uint32_t json_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        HostBuffer json = HostBuffer::from_cstr((uint32_t)(result & 0xFFFFFFFF));
         uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
         // Check for error
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
 
-        if (json_ptr == 0) {
+        if (!json.is_valid()) {
             return Error::not_found();
         }
 
-        std::string json_str = read_string_from_ptr(json_ptr);
-        return ffi::JsonParser::parse_fileinfo(json_str);
+        return ffi::JsonParser::parse_fileinfo(json.to_string());
     }
 
     // Read directory contents
     static Result<std::vector<FileInfo>> readdir(const std::string& path) {
+        MetricScope metric_scope(Metric::HostFsReaddir);
         uint64_t result = host_fs_readdir(path.c_str());
 
         // Unpack: lower 32 bits = json pointer, upper 32 bits = error pointer
-        uint32_t json_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        HostBuffer json = HostBuffer::from_cstr((uint32_t)(result & 0xFFFFFFFF));
         uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
         // Check for error
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
 
-        if (json_ptr == 0) {
+        if (!json.is_valid()) {
             return std::vector<FileInfo>();
         }
 
-        std::string json_str = read_string_from_ptr(json_ptr);
-        return ffi::JsonParser::parse_fileinfo_array(json_str);
+        return ffi::JsonParser::parse_fileinfo_array(json.to_string());
+    }
+
+    // Copy a whole file on the host, replacing dst
+    // The data never enters wasm memory, so size is not bounded by it.
+    // Returns: Number of bytes copied
+    static Result<int64_t> copy(const std::string& src, const std::string& dst) {
+        return copy_range(src, 0, dst, 0, -1, WriteFlag::CREATE | WriteFlag::TRUNCATE);
+    }
+
+    // Copy len bytes (-1 = to end of file) of src at src_offset into dst at
+    // dst_offset, on the host (copy_file_range where the host supports it)
+    // flags - Applied when opening dst; CREATE makes it if missing
+    // Returns: Number of bytes copied, short if src ends first
+    static Result<int64_t> copy_range(const std::string& src, int64_t src_offset,
+                                      const std::string& dst, int64_t dst_offset,
+                                      int64_t len, WriteFlag flags = WriteFlag::CREATE) {
+        MetricScope metric_scope(Metric::HostFsCopy);
+        int64_t copied = 0;
+        uint32_t err_ptr = host_fs_copy(src.c_str(), dst.c_str(), src_offset, dst_offset, len, flags.value, &copied);
+        if (err_ptr != 0) {
+            return Error::other(take_host_string(err_ptr));
+        }
+        return copied;
+    }
+
+    // Place len bytes (-1 = to end of file) of path at offset in linear memory
+    // The host reads them straight into memory reserved for the region, which
+    // then stays resident: the span can be queried without further host
+    // calls and mapping the same range again returns it without one. Treat
+    // the bytes as read-only; they do not follow later changes to the file.
+    // Every map() needs a matching unmap(). Resident regions count against
+    // map_budget(), and the instance's memory goes with it when the pool
+    // recycles the instance, so regions are never handed across instances.
+    // Returns: The mapped bytes, short if the file ends first
+    static Result<Span<const uint8_t>> map(const std::string& path, int64_t offset, int64_t len) {
+        MetricScope metric_scope(Metric::HostFsMap);
+        if (offset < 0) {
+            return Error::invalid_input("negative offset");
+        }
+        if (len < 0) {
+            len = -1;
+        }
+
+        auto& table = internal::host_map_table();
+        {
+            internal::LockGuard lock(table.mu);
+            if (auto* region = table.find(path, offset, len)) {
+                region->refs++;
+                return Span<const uint8_t>(region->data, region->size);
+            }
+        }
+
+        int64_t size = len;
+        if (len < 0) {
+            auto info = stat(path);
+            if (info.is_err()) {
+                return info.unwrap_err();
+            }
+            size = info.unwrap().size > offset ? info.unwrap().size - offset : 0;
+        }
+        if (size == 0) {
+            return Span<const uint8_t>();
+        }
+
+        // Reserve the region, then read it without holding the table: the
+        // host call may be slow, and other regions stay usable meanwhile.
+        // Concurrent first maps of one range each place their own copy.
+        uint64_t id;
+        {
+            internal::LockGuard lock(table.mu);
+            if (auto* region = table.find(path, offset, len)) {
+                region->refs++;
+                return Span<const uint8_t>(region->data, region->size);
+            }
+            if (table.mapped > table.budget || (uint64_t)size > table.budget - table.mapped ||
+                (uint64_t)size > UINT32_MAX) {
+                return Error::other("host map budget exceeded");
+            }
+            id = ++table.next_id;
+            table.regions.push_back(internal::HostMapTable::Region{path, offset, len, nullptr, (size_t)size, 1, id});
+            table.mapped += (size_t)size;
+        }
+
+        uint8_t* data = static_cast<uint8_t*>(std::malloc((size_t)size));
+        uint64_t result = 0;
+        if (data != nullptr) {
+            result = host_fs_map(path.c_str(), offset, (uint32_t)size, data);
+        }
+
+        // Unpack: lower 32 bits = error pointer, upper 32 bits = bytes placed
+        uint32_t err_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        size_t placed = (size_t)(result >> 32);
+        if (data == nullptr || err_ptr != 0 || placed == 0) {
+            std::free(data);
+            {
+                internal::LockGuard lock(table.mu);
+                table.mapped -= table.take(id).size;
+            }
+            if (data == nullptr) {
+                return Error::io("cannot reserve memory for host map");
+            }
+            return err_ptr != 0 ? Error::other(take_host_string(err_ptr)) : Error::io("map failed");
+        }
+        if (placed < (size_t)size) {
+            uint8_t* shrunk = static_cast<uint8_t*>(std::realloc(data, placed));
+            data = shrunk != nullptr ? shrunk : data;
+        }
+
+        internal::LockGuard lock(table.mu);
+        for (auto& region : table.regions) {
+            if (region.id == id) {
+                table.mapped -= region.size - placed;
+                region.data = data;
+                region.size = placed;
+                break;
+            }
+        }
+        metric_scope.bytes_in(placed);
+        return Span<const uint8_t>(data, placed);
+    }
+
+    // Release one map() of region; the memory is freed with the last one
+    static Result<void> unmap(Span<const uint8_t> region) {
+        if (region.empty()) {
+            return Result<void>();
+        }
+        auto& table = internal::host_map_table();
+        internal::LockGuard lock(table.mu);
+        for (size_t i = 0; i < table.regions.size(); i++) {
+            auto& r = table.regions[i];
+            if (r.data != region.data()) {
+                continue;
+            }
+            if (--r.refs == 0) {
+                std::free(r.data);
+                table.mapped -= r.size;
+                table.regions[i] = std::move(table.regions.back());
+                table.regions.pop_back();
+            }
+            return Result<void>();
+        }
+        return Error::invalid_input("region is not mapped");
+    }
+
+    // Cap the bytes map() keeps resident (AGFS_HOSTFS_MAP_BUDGET by default)
+    // Lowering it below mapped_bytes() only blocks new regions.
+    static void set_map_budget(size_t bytes) {
+        auto& table = internal::host_map_table();
+        internal::LockGuard lock(table.mu);
+        table.budget = bytes;
+    }
+
+    static size_t map_budget() {
+        auto& table = internal::host_map_table();
+        internal::LockGuard lock(table.mu);
+        return table.budget;
+    }
+
+    static size_t mapped_bytes() {
+        auto& table = internal::host_map_table();
+        internal::LockGuard lock(table.mu);
+        return table.mapped;
     }
 
     // Create a new file
     static Result<void> create(const std::string& path) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_create(path.c_str());
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
 
     // Create a directory
     static Result<void> mkdir(const std::string& path, uint32_t perm) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_mkdir(path.c_str(), perm);
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
 
     // Remove a file or empty directory
     static Result<void> remove(const std::string& path) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_remove(path.c_str());
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
 
     // Remove a file or directory recursively
     static Result<void> remove_all(const std::string& path) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_remove_all(path.c_str());
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
 
     // Rename a file or directory
     static Result<void> rename(const std::string& old_path, const std::string& new_path) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_rename(old_path.c_str(), new_path.c_str());
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
 
     // Change file permissions
     static Result<void> chmod(const std::string& path, uint32_t mode) {
+        MetricScope metric_scope(Metric::HostFsOther);
         uint32_t err_ptr = host_fs_chmod(path.c_str(), mode);
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return Error::other(take_host_string(err_ptr));
         }
         return Result<void>();
     }
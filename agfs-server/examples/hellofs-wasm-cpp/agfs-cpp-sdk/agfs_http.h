@@ -2,6 +2,10 @@
 #define AGFS_HTTP_H
 
 #include "agfs_types.h"
+#include "agfs_ffi.h"
+#include "agfs_base64.h"
+#include "agfs_hostbuffer.h"
+#include "agfs_metrics.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -12,6 +16,37 @@ namespace agfs {
 // Forward declarations for FFI functions
 extern "C" {
     uint64_t host_http_request(const char* request_json);
+
+    // Binary request header plus raw body; see HttpRequest::encode_header()
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_request_v2")))
+    uint64_t host_http_request_v2(const uint8_t* req, uint32_t req_len, const uint8_t* body, uint32_t body_len);
+
+    // Streaming responses; see HttpStream
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_stream_open")))
+    uint64_t host_http_stream_open(const uint8_t* req, uint32_t req_len, const uint8_t* body, uint32_t body_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_stream_read")))
+    int64_t host_http_stream_read(uint32_t stream_id, uint8_t* buf, uint32_t buf_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_stream_close")))
+    uint32_t host_http_stream_close(uint32_t stream_id);
+
+    // Persistent sessions; see HttpSession
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_session_open")))
+    uint32_t host_http_session_open(const uint8_t* config, uint32_t config_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_session_request")))
+    uint64_t host_http_session_request(uint32_t session_id, const uint8_t* req, uint32_t req_len, const uint8_t* body, uint32_t body_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_session_close")))
+    uint32_t host_http_session_close(uint32_t session_id);
+
+    // Asynchronous requests; see Http::submit
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_submit")))
+    uint32_t host_http_submit(uint32_t session_id, const uint8_t* req, uint32_t req_len, const uint8_t* body, uint32_t body_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_wait")))
+    uint64_t host_http_wait(const uint32_t* tickets, uint32_t count, uint32_t wait);
 }
 
 // HTTP request builder
@@ -78,29 +113,66 @@ public:
         return *this;
     }
 
+    // Encode method, URL, timeout and headers for host_http_request_v2
+    // Layout (little-endian): u32 len + method, u32 len + url, u32 timeout,
+    // u32 header_count, then u32 len + key, u32 len + value per header.
+    // The body is passed to the host separately, without encoding.
+    std::vector<uint8_t> encode_header() const {
+        size_t size = 16 + method.size() + url.size();
+        for (const auto& [key, value] : headers) {
+            size += 8 + key.size() + value.size();
+        }
+        std::vector<uint8_t> out;
+        out.reserve(size);
+        put_str(out, method);
+        put_str(out, url);
+        put_u32(out, (uint32_t)timeout);
+        put_u32(out, (uint32_t)headers.size());
+        for (const auto& [key, value] : headers) {
+            put_str(out, key);
+            put_str(out, value);
+        }
+        return out;
+    }
+
     // Convert to JSON for FFI
     std::string to_json() const {
-        std::string json = "{";
-        json += "\"method\":\"" + method + "\",";
-        json += "\"url\":\"" + url + "\",";
-        json += "\"headers\":{";
-        bool first = true;
+        std::string json;
+        json.reserve(64 + method.size() + url.size() + body.size() * 4);
+        JsonWriter w(json);
+        w.begin_object();
+        w.key("method"); w.string(method);
+        w.key("url"); w.string(url);
+        w.key("headers");
+        w.begin_object();
         for (const auto& [key, value] : headers) {
-            if (!first) json += ",";
-            json += "\"" + key + "\":\"" + value + "\"";
-            first = false;
-        }
-        json += "},";
-        json += "\"body\":[";
-        for (size_t i = 0; i < body.size(); i++) {
-            if (i > 0) json += ",";
-            json += std::to_string(body[i]);
-        }
-        json += "],";
-        json += "\"timeout\":" + std::to_string(timeout);
-        json += "}";
+            w.dynamic_key(key);
+            w.string(value);
+        }
+        w.end_object();
+        w.key("body");
+        w.begin_array();
+        for (uint8_t byte : body) {
+            w.integer(byte);
+        }
+        w.end_array();
+        w.key("timeout"); w.integer(timeout);
+        w.end_object();
         return json;
     }
+
+private:
+    friend class HttpSessionConfig;
+
+    static void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+        out.insert(out.end(), p, p + 4);
+    }
+
+    static void put_str(std::vector<uint8_t>& out, const std::string& v) {
+        put_u32(out, (uint32_t)v.size());
+        out.insert(out.end(), v.begin(), v.end());
+    }
 };
 
 // HTTP response
@@ -123,41 +195,36 @@ public:
         return std::string(body.begin(), body.end());
     }
 
-    // Simple base64 decode
+    // Decode a base64 body (see Base64::decode)
     static std::vector<uint8_t> base64_decode(const std::string& input) {
-        static const uint8_t base64_table[128] = {
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
-            52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 0, 255, 255,
-            255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
-            15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
-            255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-            41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
-        };
-
-        std::vector<uint8_t> output;
-        if (input.empty()) return output;
-
-        output.reserve((input.size() * 3) / 4);
-        uint32_t buf = 0;
-        int bits = 0;
-
-        for (char c : input) {
-            if (c == '=') break;
-            if (c >= 128 || base64_table[c] == 255) continue;
-
-            buf = (buf << 6) | base64_table[c];
-            bits += 6;
-
-            if (bits >= 8) {
-                bits -= 8;
-                output.push_back((buf >> bits) & 0xFF);
-                buf &= (1 << bits) - 1;
-            }
+        return Base64::decode(input);
+    }
+
+    // Parse a host_http_request_v2 response
+    // Layout (little-endian): u32 status_code, u32 len + error, u32 header_count,
+    // u32 len + key / u32 len + value per header, u32 len + body.
+    static Result<HttpResponse> from_binary(const uint8_t* data, size_t size) {
+        HttpResponse resp;
+        ffi::ByteReader in(data, size);
+        resp.status_code = (int)in.u32();
+        resp.error = in.str();
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && in.ok(); i++) {
+            std::string key = in.str();
+            resp.headers[key] = in.str();
+        }
+        uint32_t body_len = 0;
+        const uint8_t* body = in.bytes(body_len);
+        if (!in.ok()) {
+            return Error::other("malformed HTTP response");
         }
+        resp.body.assign(body, body + body_len);
 
-        return output;
+        if (!resp.error.empty()) {
+            return Error::other(resp.error);
+        }
+
+        return resp;
     }
 
     // Parse from JSON response
@@ -204,27 +271,245 @@ public:
     }
 };
 
+// Streaming HTTP response
+// The status and headers are available once the stream is open; the body is
+// pulled from the host in caller-sized chunks, so memory use does not depend
+// on the response size. Streams are closed on destruction, and the host
+// closes any left open when the plugin instance is destroyed.
+class HttpStream {
+public:
+    int status_code = 0;
+    std::map<std::string, std::string> headers;
+
+    HttpStream() = default;
+    HttpStream(const HttpStream&) = delete;
+    HttpStream& operator=(const HttpStream&) = delete;
+
+    HttpStream(HttpStream&& other) noexcept
+        : status_code(other.status_code), headers(std::move(other.headers)), id_(other.id_) {
+        other.id_ = 0;
+    }
+
+    HttpStream& operator=(HttpStream&& other) noexcept {
+        if (this != &other) {
+            close();
+            status_code = other.status_code;
+            headers = std::move(other.headers);
+            id_ = other.id_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+
+    ~HttpStream() {
+        close();
+    }
+
+    bool is_open() const {
+        return id_ != 0;
+    }
+
+    bool is_success() const {
+        return status_code >= 200 && status_code < 300;
+    }
+
+    // Read the next part of the body into buf
+    // Fills buf completely unless the body ends first.
+    // Returns: Number of bytes stored in buf, 0 at end of body
+    Result<size_t> read_chunk(Span<uint8_t> buf) {
+        if (id_ == 0) {
+            return Error::other("HTTP stream is closed");
+        }
+        if (buf.empty()) {
+            return size_t(0);
+        }
+        MetricScope metric_scope(Metric::HttpStreamRead);
+        int64_t n = host_http_stream_read(id_, buf.data(), (uint32_t)buf.size());
+        if (n < 0) {
+            return Error::other("HTTP stream read failed");
+        }
+        metric_scope.bytes_in((uint64_t)n);
+        return (size_t)n;
+    }
+
+    // Release the stream on the host; further reads fail
+    void close() {
+        if (id_ != 0) {
+            host_http_stream_close(id_);
+            id_ = 0;
+        }
+    }
+
+    // Parse a host_http_stream_open response: u32 stream_id followed by a
+    // host_http_request_v2 response with an empty body
+    static Result<HttpStream> from_binary(const uint8_t* data, size_t size) {
+        ffi::ByteReader in(data, size);
+        uint32_t id = in.u32();
+        if (!in.ok()) {
+            return Error::other("malformed HTTP stream response");
+        }
+
+        HttpStream stream;
+        stream.id_ = id;  // owned from here on, so failures below still close it
+        auto head = HttpResponse::from_binary(data + 4, size - 4);
+        if (head.is_err()) {
+            return head.unwrap_err();
+        }
+        if (id == 0) {
+            return Error::other("HTTP stream open failed");
+        }
+        stream.status_code = head.unwrap().status_code;
+        stream.headers = std::move(head.unwrap().headers);
+        return stream;
+    }
+
+private:
+    uint32_t id_ = 0;
+};
+
+// Handle for a request started with Http::submit or HttpSession::submit
+using HttpTicket = uint32_t;
+
+// Outcome of one submitted request
+struct HttpResult {
+    HttpTicket ticket;
+    Result<HttpResponse> response;
+};
+
+namespace internal {
+
+inline Result<HttpTicket> submit_http(uint32_t session_id, const HttpRequest& req) {
+    std::vector<uint8_t> header = req.encode_header();
+    HttpTicket ticket = host_http_submit(
+        session_id, header.data(), (uint32_t)header.size(), req.body.data(), (uint32_t)req.body.size());
+    if (ticket == 0) {
+        return Error::other("failed to submit HTTP request");
+    }
+    return ticket;
+}
+
+// Most tickets the host accepts in one host_http_wait call
+constexpr size_t MAX_HTTP_WAIT_TICKETS = 1u << 16;
+
+// Collect results from host_http_wait
+// Layout (little-endian): u32 result_count, then per result u32 ticket and
+// u32 len + host_http_request_v2 response.
+inline Result<std::vector<HttpResult>> collect_http(const std::vector<HttpTicket>& tickets, bool wait) {
+    std::vector<HttpResult> results;
+    if (tickets.empty()) {
+        return results;
+    }
+    if (tickets.size() > MAX_HTTP_WAIT_TICKETS) {
+        return Error::invalid_input("too many HTTP tickets in one wait");
+    }
+
+    MetricScope metric_scope(Metric::HttpWait);
+    // Lower 32 bits = pointer, upper 32 bits = size; freed on return
+    HostBuffer buffer = HostBuffer::from_packed(
+        host_http_wait(tickets.data(), (uint32_t)tickets.size(), wait ? 1 : 0));
+    if (!buffer.is_valid()) {
+        return Error::other("failed to collect HTTP results");
+    }
+    metric_scope.bytes_in(buffer.size());
+
+    ffi::ByteReader in(buffer.data(), buffer.size());
+    uint32_t count = in.u32();
+    results.reserve(count);
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+        HttpTicket ticket = in.u32();
+        uint32_t len = 0;
+        const uint8_t* data = in.bytes(len);
+        if (!in.ok()) {
+            break;
+        }
+        results.push_back(HttpResult{ticket, HttpResponse::from_binary(data, len)});
+    }
+    if (!in.ok()) {
+        return Error::other("malformed HTTP results");
+    }
+    return results;
+}
+
+} // namespace internal
+
 // HTTP client
 class Http {
 public:
+    // Perform a request through the binary host_http_request_v2 ABI
+    // Define AGFS_HTTP_JSON_ABI to build against hosts that only provide
+    // the JSON host_http_request import.
     static Result<HttpResponse> request(const HttpRequest& req) {
+#ifdef AGFS_HTTP_JSON_ABI
+        return request_json(req);
+#else
+        std::vector<uint8_t> header = req.encode_header();
+
+        MetricScope metric_scope(Metric::HttpRequest);
+        metric_scope.bytes_out(req.body.size());
+        // Lower 32 bits = pointer, upper 32 bits = size; freed on return
+        HostBuffer response = HostBuffer::from_packed(host_http_request_v2(
+            header.data(), (uint32_t)header.size(), req.body.data(), (uint32_t)req.body.size()));
+        if (!response.is_valid()) {
+            return Error::other("HTTP request failed");
+        }
+        metric_scope.bytes_in(response.size());
+
+        return HttpResponse::from_binary(response.data(), response.size());
+#endif
+    }
+
+    // Perform a request through the JSON host_http_request ABI
+    static Result<HttpResponse> request_json(const HttpRequest& req) {
+        MetricScope metric_scope(Metric::HttpRequest);
+        metric_scope.bytes_out(req.body.size());
         std::string request_json = req.to_json();
 
-        uint64_t result = host_http_request(request_json.c_str());
+        // Lower 32 bits = pointer, upper 32 bits = size; freed on return
+        HostBuffer response = HostBuffer::from_packed(host_http_request(request_json.c_str()));
+        if (!response.is_valid()) {
+            return Error::other("HTTP request failed");
+        }
+        metric_scope.bytes_in(response.size());
 
-        // Unpack: lower 32 bits = pointer, upper 32 bits = size
-        uint32_t response_ptr = result & 0xFFFFFFFF;
-        uint32_t response_size = (result >> 32) & 0xFFFFFFFF;
+        return HttpResponse::from_json(response.to_string());
+    }
 
-        if (response_ptr == 0) {
+    // Send a request and return as soon as the response headers arrive
+    // The request timeout applies to the headers only; the body is read with
+    // HttpStream::read_chunk.
+    static Result<HttpStream> open_stream(const HttpRequest& req) {
+        std::vector<uint8_t> header = req.encode_header();
+
+        MetricScope metric_scope(Metric::HttpStreamOpen);
+        metric_scope.bytes_out(req.body.size());
+        // Lower 32 bits = pointer, upper 32 bits = size; freed on return
+        HostBuffer response = HostBuffer::from_packed(host_http_stream_open(
+            header.data(), (uint32_t)header.size(), req.body.data(), (uint32_t)req.body.size()));
+        if (!response.is_valid()) {
             return Error::other("HTTP request failed");
         }
+        metric_scope.bytes_in(response.size());
 
-        // Read response from memory
-        const char* response_data = reinterpret_cast<const char*>(response_ptr);
-        std::string response_json(response_data, response_size);
+        return HttpStream::from_binary(response.data(), response.size());
+    }
+
+    // Start a request on the host without waiting for it
+    // The host runs submitted requests concurrently, so N independent requests
+    // collected with wait_all take about one round trip instead of N.
+    static Result<HttpTicket> submit(const HttpRequest& req) {
+        return internal::submit_http(0, req);
+    }
+
+    // Block until every ticket has completed
+    // Returns: One result per ticket, in the order given
+    static Result<std::vector<HttpResult>> wait_all(const std::vector<HttpTicket>& tickets) {
+        return internal::collect_http(tickets, true);
+    }
 
-        return HttpResponse::from_json(response_json);
+    // Collect the tickets that have already completed, without blocking
+    // Collected tickets are released; pass the remaining ones to a later call.
+    static Result<std::vector<HttpResult>> poll(const std::vector<HttpTicket>& tickets) {
+        return internal::collect_http(tickets, false);
     }
 
     static Result<HttpResponse> get(const std::string& url) {
@@ -248,6 +533,146 @@ public:
     }
 };
 
+// Settings shared by every request of an HttpSession
+class HttpSessionConfig {
+public:
+    std::string base_url;
+    std::map<std::string, std::string> headers;
+    int timeout = 30; // seconds
+
+    explicit HttpSessionConfig(const std::string& base) : base_url(base) {}
+
+    HttpSessionConfig& add_header(const std::string& key, const std::string& value) {
+        headers[key] = value;
+        return *this;
+    }
+
+    HttpSessionConfig& set_timeout(int seconds) {
+        timeout = seconds;
+        return *this;
+    }
+
+    // Encode for host_http_session_open
+    // Layout (little-endian): u32 len + base_url, u32 timeout, u32 header_count,
+    // then u32 len + key, u32 len + value per header.
+    std::vector<uint8_t> encode() const {
+        std::vector<uint8_t> out;
+        HttpRequest::put_str(out, base_url);
+        HttpRequest::put_u32(out, (uint32_t)timeout);
+        HttpRequest::put_u32(out, (uint32_t)headers.size());
+        for (const auto& [key, value] : headers) {
+            HttpRequest::put_str(out, key);
+            HttpRequest::put_str(out, value);
+        }
+        return out;
+    }
+};
+
+// Persistent HTTP session for many requests to one origin
+// The host keeps a pooled connection per origin, so repeat requests reuse
+// established (TLS) connections, and the default headers are sent to the host
+// once when the session opens instead of with every request.
+//
+// Request URLs without a scheme are appended to the base URL; request headers
+// override the session defaults. A request timeout of 0 uses the session
+// timeout, which is what the helpers below send.
+class HttpSession {
+public:
+    HttpSession() = default;
+    HttpSession(const HttpSession&) = delete;
+    HttpSession& operator=(const HttpSession&) = delete;
+
+    HttpSession(HttpSession&& other) noexcept : id_(other.id_) {
+        other.id_ = 0;
+    }
+
+    HttpSession& operator=(HttpSession&& other) noexcept {
+        if (this != &other) {
+            close();
+            id_ = other.id_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+
+    ~HttpSession() {
+        close();
+    }
+
+    static Result<HttpSession> open(const HttpSessionConfig& config) {
+        std::vector<uint8_t> encoded = config.encode();
+        uint32_t id = host_http_session_open(encoded.data(), (uint32_t)encoded.size());
+        if (id == 0) {
+            return Error::other("failed to open HTTP session for " + config.base_url);
+        }
+        HttpSession session;
+        session.id_ = id;
+        return session;
+    }
+
+    bool is_open() const {
+        return id_ != 0;
+    }
+
+    Result<HttpResponse> request(const HttpRequest& req) const {
+        if (id_ == 0) {
+            return Error::other("HTTP session is closed");
+        }
+        std::vector<uint8_t> header = req.encode_header();
+
+        MetricScope metric_scope(Metric::HttpRequest);
+        metric_scope.bytes_out(req.body.size());
+        // Lower 32 bits = pointer, upper 32 bits = size; freed on return
+        HostBuffer response = HostBuffer::from_packed(host_http_session_request(
+            id_, header.data(), (uint32_t)header.size(), req.body.data(), (uint32_t)req.body.size()));
+        if (!response.is_valid()) {
+            return Error::other("HTTP request failed");
+        }
+        metric_scope.bytes_in(response.size());
+
+        return HttpResponse::from_binary(response.data(), response.size());
+    }
+
+    Result<HttpResponse> get(const std::string& path) const {
+        return request(HttpRequest::get(path).set_timeout(0));
+    }
+
+    Result<HttpResponse> post(const std::string& path, const std::vector<uint8_t>& body) const {
+        return request(HttpRequest::post(path).set_body(body).set_timeout(0));
+    }
+
+    Result<HttpResponse> post(const std::string& path, const std::string& body) const {
+        return request(HttpRequest::post(path).set_body(body).set_timeout(0));
+    }
+
+    Result<HttpResponse> put(const std::string& path, const std::vector<uint8_t>& body) const {
+        return request(HttpRequest::put(path).set_body(body).set_timeout(0));
+    }
+
+    Result<HttpResponse> del(const std::string& path) const {
+        return request(HttpRequest::del(path).set_timeout(0));
+    }
+
+    // Start a request through this session; collect it with Http::wait_all or Http::poll
+    Result<HttpTicket> submit(const HttpRequest& req) const {
+        if (id_ == 0) {
+            return Error::other("HTTP session is closed");
+        }
+        return internal::submit_http(id_, req);
+    }
+
+    // Release the session on the host; the pooled connections stay available
+    void close() {
+        if (id_ != 0) {
+            host_http_session_close(id_);
+            id_ = 0;
+        }
+    }
+
+private:
+    uint32_t id_ = 0;
+};
+
 } // namespace agfs
 
 #endif // AGFS_HTTP_H
@@ -0,0 +1,650 @@
+#ifndef AGFS_JSON_H
+#define AGFS_JSON_H
+
+#include "agfs_types.h"
+#include "agfs_simd.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+// JsonWriter appends compact JSON to a caller-owned string
+// There is no DOM: values go straight into the output, comma placement is
+// tracked with a single flag, and object keys are string literals whose
+// length is known at compile time. Keys are written verbatim, so they must
+// not need escaping.
+//
+//   std::string out;
+//   agfs::JsonWriter w(out);
+//   w.begin_object();
+//   w.key("Name"); w.string(name);
+//   w.key("Size"); w.integer(size);
+//   w.end_object();
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out), need_comma_(false) {}
+
+    void begin_object() { value_prefix(); out_ += '{'; need_comma_ = false; }
+    void end_object() { out_ += '}'; need_comma_ = true; }
+    void begin_array() { value_prefix(); out_ += '['; need_comma_ = false; }
+    void end_array() { out_ += ']'; need_comma_ = true; }
+
+    template <size_t N>
+    void key(const char (&k)[N]) {
+        value_prefix();
+        out_ += '"';
+        out_.append(k, N - 1);
+        out_ += "\":";
+        need_comma_ = false;
+    }
+
+    // Key only known at run time, escaped like a string value
+    void dynamic_key(std::string_view k) {
+        string(k);
+        out_ += ':';
+        need_comma_ = false;
+    }
+
+    void string(std::string_view s) {
+        value_prefix();
+        out_ += '"';
+        append_escaped(out_, s);
+        out_ += '"';
+        need_comma_ = true;
+    }
+
+    void integer(int64_t v) {
+        value_prefix();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out_.append(buf, res.ptr - buf);
+        need_comma_ = true;
+    }
+
+    void boolean(bool v) {
+        value_prefix();
+        out_ += v ? "true" : "false";
+        need_comma_ = true;
+    }
+
+    void null() {
+        value_prefix();
+        out_ += "null";
+        need_comma_ = true;
+    }
+
+    // Already-encoded JSON value, copied as is
+    void raw(std::string_view json) {
+        value_prefix();
+        out_.append(json.data(), json.size());
+        need_comma_ = true;
+    }
+
+    // Append s with JSON string escaping (no surrounding quotes)
+    // Bytes >= 0x80 pass through, so UTF-8 stays UTF-8.
+    static void append_escaped(std::string& out, std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        size_t pos = 0;
+        while (pos < s.size()) {
+            size_t run = internal::find_json_special(s.data() + pos, s.size() - pos);
+            out.append(s.data() + pos, run);
+            pos += run;
+            if (pos == s.size()) {
+                break;
+            }
+            unsigned char c = (unsigned char)s[pos++];
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out.append(esc, sizeof(esc));
+                }
+            }
+        }
+    }
+
+private:
+    void value_prefix() {
+        if (need_comma_) {
+            out_ += ',';
+        }
+    }
+
+    std::string& out_;
+    bool need_comma_;
+};
+
+// JsonReader is a pull parser over a JSON text
+// Callers walk the structure they expect and skip_value() anything else.
+// Any syntax error latches ok() to false and makes later calls fail, so a
+// decoder can check once at the end.
+//
+//   agfs::JsonReader r(text);
+//   std::string key;
+//   bool first = true;
+//   if (r.begin_object()) {
+//       while (r.next_key(first, key)) {
+//           if (key == "Size") r.read_i64(info.size);
+//           else r.skip_value();
+//       }
+//   }
+class JsonReader {
+public:
+    enum class Type { Object, Array, String, Number, Bool, Null, Invalid };
+
+    // Nesting limit for skip_value(), which recurses
+    static constexpr int MAX_DEPTH = 64;
+
+    explicit JsonReader(std::string_view in) : in_(in), pos_(0), ok_(true) {}
+
+    bool ok() const { return ok_; }
+
+    // True once only whitespace is left
+    bool at_end() {
+        skip_ws();
+        return ok_ && pos_ == in_.size();
+    }
+
+    Type peek() {
+        skip_ws();
+        if (!ok_ || pos_ >= in_.size()) {
+            return Type::Invalid;
+        }
+        switch (in_[pos_]) {
+            case '{': return Type::Object;
+            case '[': return Type::Array;
+            case '"': return Type::String;
+            case 't': case 'f': return Type::Bool;
+            case 'n': return Type::Null;
+            default:
+                return (in_[pos_] == '-' || (in_[pos_] >= '0' && in_[pos_] <= '9'))
+                    ? Type::Number : Type::Invalid;
+        }
+    }
+
+    bool begin_object() { return expect('{'); }
+    bool begin_array() { return expect('['); }
+
+    // Advance to the next member of the current object and read its key
+    // first must start as true for each object. Returns false after the
+    // closing brace (or on error).
+    bool next_key(bool& first, std::string& key) {
+        if (!next_item(first, '}')) {
+            return false;
+        }
+        return read_string(key) && expect(':');
+    }
+
+    // Advance to the next element of the current array
+    bool next_element(bool& first) {
+        return next_item(first, ']');
+    }
+
+    bool read_string(std::string& out) {
+        out.clear();
+        if (!expect('"')) {
+            return false;
+        }
+        while (pos_ < in_.size()) {
+            size_t run = internal::find_json_special(in_.data() + pos_, in_.size() - pos_);
+            out.append(in_.data() + pos_, run);
+            pos_ += run;
+            if (pos_ >= in_.size()) {
+                break;
+            }
+            unsigned char c = (unsigned char)in_[pos_];
+            if (c == '"') {
+                pos_++;
+                return true;
+            }
+            if (c < 0x20) {
+                return fail();
+            }
+            if (++pos_ >= in_.size()) {
+                return fail();
+            }
+            char e = in_[pos_++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                    if (!read_unicode_escape(out)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return fail();
+            }
+        }
+        return fail();
+    }
+
+    // Number token as written in the input
+    bool read_number(std::string_view& text) {
+        if (peek() != Type::Number) {
+            return fail();
+        }
+        size_t start = pos_;
+        if (in_[pos_] == '-') pos_++;
+        if (!digits()) return fail();
+        if (pos_ < in_.size() && in_[pos_] == '.') {
+            pos_++;
+            if (!digits()) return fail();
+        }
+        if (pos_ < in_.size() && (in_[pos_] == 'e' || in_[pos_] == 'E')) {
+            pos_++;
+            if (pos_ < in_.size() && (in_[pos_] == '+' || in_[pos_] == '-')) pos_++;
+            if (!digits()) return fail();
+        }
+        text = in_.substr(start, pos_ - start);
+        return true;
+    }
+
+    bool read_double(double& out) {
+        std::string_view text;
+        if (!read_number(text)) {
+            return false;
+        }
+        char buf[64];
+        if (text.size() >= sizeof(buf)) {
+            return fail();
+        }
+        std::memcpy(buf, text.data(), text.size());
+        buf[text.size()] = '\0';
+        out = std::strtod(buf, nullptr);
+        return true;
+    }
+
+    // Integers parse exactly; fractional or exponent forms are truncated
+    bool read_i64(int64_t& out) {
+        std::string_view text;
+        size_t start = pos_;
+        if (!read_number(text)) {
+            return false;
+        }
+        auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+        if (res.ec == std::errc() && res.ptr == text.data() + text.size()) {
+            return true;
+        }
+        pos_ = start;
+        double d = 0;
+        if (!read_double(d)) {
+            return false;
+        }
+        out = (int64_t)d;
+        return true;
+    }
+
+    bool read_u32(uint32_t& out) {
+        int64_t v = 0;
+        if (!read_i64(v)) {
+            return false;
+        }
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool read_bool(bool& out) {
+        skip_ws();
+        if (literal("true")) {
+            out = true;
+            return true;
+        }
+        if (literal("false")) {
+            out = false;
+            return true;
+        }
+        return fail();
+    }
+
+    bool read_null() {
+        skip_ws();
+        return literal("null") || fail();
+    }
+
+    // Consume one value of any type, validating it
+    bool skip_value(int depth = 0) {
+        if (depth > MAX_DEPTH) {
+            return fail();
+        }
+        std::string scratch;
+        std::string_view num;
+        bool b = false;
+        bool first = true;
+        switch (peek()) {
+            case Type::Object:
+                begin_object();
+                while (next_key(first, scratch)) {
+                    if (!skip_value(depth + 1)) return false;
+                }
+                return ok_;
+            case Type::Array:
+                begin_array();
+                while (next_element(first)) {
+                    if (!skip_value(depth + 1)) return false;
+                }
+                return ok_;
+            case Type::String: return read_string(scratch);
+            case Type::Number: return read_number(num);
+            case Type::Bool: return read_bool(b);
+            case Type::Null: return read_null();
+            default: return fail();
+        }
+    }
+
+    // True if text is exactly one well-formed JSON value
+    static bool is_valid(std::string_view text) {
+        JsonReader r(text);
+        return r.skip_value() && r.at_end();
+    }
+
+private:
+    bool fail() {
+        ok_ = false;
+        return false;
+    }
+
+    void skip_ws() {
+        while (pos_ < in_.size() &&
+               (in_[pos_] == ' ' || in_[pos_] == '\t' || in_[pos_] == '\n' || in_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool expect(char c) {
+        skip_ws();
+        if (!ok_ || pos_ >= in_.size() || in_[pos_] != c) {
+            return fail();
+        }
+        pos_++;
+        return true;
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::strlen(word);
+        if (ok_ && in_.compare(pos_, n, word) == 0) {
+            pos_ += n;
+            return true;
+        }
+        return false;
+    }
+
+    bool digits() {
+        size_t start = pos_;
+        while (pos_ < in_.size() && in_[pos_] >= '0' && in_[pos_] <= '9') {
+            pos_++;
+        }
+        return pos_ > start;
+    }
+
+    bool next_item(bool& first, char close) {
+        skip_ws();
+        if (!ok_ || pos_ >= in_.size()) {
+            return fail();
+        }
+        if (in_[pos_] == close) {
+            pos_++;
+            return false;
+        }
+        if (!first && !expect(',')) {
+            return false;
+        }
+        first = false;
+        return true;
+    }
+
+    bool hex4(uint32_t& out) {
+        if (pos_ + 4 > in_.size()) {
+            return fail();
+        }
+        out = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = in_[pos_++];
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= (uint32_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') out |= (uint32_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') out |= (uint32_t)(c - 'A' + 10);
+            else return fail();
+        }
+        return true;
+    }
+
+    // Decode \uXXXX (already past the 'u'), joining surrogate pairs, as UTF-8
+    bool read_unicode_escape(std::string& out) {
+        uint32_t cp = 0;
+        if (!hex4(cp)) {
+            return false;
+        }
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            uint32_t lo = 0;
+            if (in_.compare(pos_, 2, "\\u") != 0) {
+                return fail();
+            }
+            pos_ += 2;
+            if (!hex4(lo) || lo < 0xDC00 || lo > 0xDFFF) {
+                return fail();
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            return fail();
+        }
+
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+        return true;
+    }
+
+    std::string_view in_;
+    size_t pos_;
+    bool ok_;
+};
+
+// JsonCodec<T> is the fixed JSON shape of an SDK type
+// Specializations provide size_hint() (bytes to reserve up front) plus
+// write() and/or read(). Keys match the Go structs the host marshals.
+template <typename T>
+struct JsonCodec;
+
+template <>
+struct JsonCodec<MetaData> {
+    static size_t size_hint(const MetaData& meta) {
+        return 32 + meta.name.size() + meta.type.size() + meta.content.size();
+    }
+
+    // content is embedded as JSON when it parses, null otherwise
+    static void write(JsonWriter& w, const MetaData& meta) {
+        w.begin_object();
+        w.key("Name"); w.string(meta.name);
+        w.key("Type"); w.string(meta.type);
+        w.key("Content");
+        if (JsonReader::is_valid(meta.content)) {
+            w.raw(meta.content);
+        } else {
+            w.null();
+        }
+        w.end_object();
+    }
+};
+
+template <>
+struct JsonCodec<FileInfo> {
+    static size_t size_hint(const FileInfo& info) {
+        size_t n = 96 + info.name.size();
+        if (info.meta.has_value()) {
+            n += 8 + JsonCodec<MetaData>::size_hint(*info.meta);
+        }
+        return n;
+    }
+
+    static void write(JsonWriter& w, const FileInfo& info) {
+        w.begin_object();
+        w.key("Name"); w.string(info.name);
+        w.key("Size"); w.integer(info.size);
+        w.key("Mode"); w.integer(info.mode);
+        w.key("ModTime"); w.raw("\"0001-01-01T00:00:00Z\"");
+        w.key("IsDir"); w.boolean(info.is_dir);
+        if (info.meta.has_value()) {
+            w.key("Meta");
+            JsonCodec<MetaData>::write(w, *info.meta);
+        }
+        w.end_object();
+    }
+
+    // Reads Name/Size/Mode/IsDir; other members are skipped
+    static bool read(JsonReader& r, FileInfo& info) {
+        std::string key;
+        bool first = true;
+        if (!r.begin_object()) {
+            return false;
+        }
+        while (r.next_key(first, key)) {
+            bool ok;
+            if (key == "Name" && r.peek() == JsonReader::Type::String) {
+                ok = r.read_string(info.name);
+            } else if (key == "Size" && r.peek() == JsonReader::Type::Number) {
+                ok = r.read_i64(info.size);
+            } else if (key == "Mode" && r.peek() == JsonReader::Type::Number) {
+                ok = r.read_u32(info.mode);
+            } else if (key == "IsDir" && r.peek() == JsonReader::Type::Bool) {
+                ok = r.read_bool(info.is_dir);
+            } else {
+                ok = r.skip_value();
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return r.ok();
+    }
+};
+
+template <typename T>
+struct JsonCodec<std::vector<T>> {
+    static size_t size_hint(const std::vector<T>& items) {
+        size_t n = 2;
+        for (const auto& item : items) {
+            n += 1 + JsonCodec<T>::size_hint(item);
+        }
+        return n;
+    }
+
+    static void write(JsonWriter& w, const std::vector<T>& items) {
+        w.begin_array();
+        for (const auto& item : items) {
+            JsonCodec<T>::write(w, item);
+        }
+        w.end_array();
+    }
+
+    // Elements of the wrong type are skipped
+    static bool read(JsonReader& r, std::vector<T>& items) {
+        bool first = true;
+        if (!r.begin_array()) {
+            return false;
+        }
+        while (r.next_element(first)) {
+            if (r.peek() != JsonReader::Type::Object) {
+                if (!r.skip_value()) return false;
+                continue;
+            }
+            T item;
+            if (!JsonCodec<T>::read(r, item)) {
+                return false;
+            }
+            items.push_back(std::move(item));
+        }
+        return r.ok();
+    }
+};
+
+template <>
+struct JsonCodec<Config> {
+    // Flat object of scalars; numbers keep their literal text, booleans
+    // become "true"/"false". Nested values and nulls are skipped.
+    static bool read(JsonReader& r, Config& config) {
+        std::string key;
+        std::string value;
+        bool first = true;
+        if (!r.begin_object()) {
+            return false;
+        }
+        while (r.next_key(first, key)) {
+            bool ok;
+            switch (r.peek()) {
+                case JsonReader::Type::String:
+                    ok = r.read_string(value);
+                    if (ok) config.values[key] = value;
+                    break;
+                case JsonReader::Type::Number: {
+                    std::string_view text;
+                    ok = r.read_number(text);
+                    if (ok) config.values[key] = std::string(text);
+                    break;
+                }
+                case JsonReader::Type::Bool: {
+                    bool b = false;
+                    ok = r.read_bool(b);
+                    if (ok) config.values[key] = b ? "true" : "false";
+                    break;
+                }
+                default:
+                    ok = r.skip_value();
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return r.ok();
+    }
+};
+
+// Encode value with its JsonCodec into one pre-sized string
+template <typename T>
+std::string to_json(const T& value) {
+    std::string out;
+    out.reserve(JsonCodec<T>::size_hint(value));
+    JsonWriter w(out);
+    JsonCodec<T>::write(w, value);
+    return out;
+}
+
+// Decode text with T's JsonCodec
+// Returns: false if text is not JSON of the expected shape
+template <typename T>
+bool from_json(std::string_view text, T& out) {
+    JsonReader r(text);
+    return JsonCodec<T>::read(r, out) && r.at_end();
+}
+
+} // namespace agfs
+
+#endif // AGFS_JSON_H
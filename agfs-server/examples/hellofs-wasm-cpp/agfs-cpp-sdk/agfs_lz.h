@@ -0,0 +1,199 @@
+#ifndef AGFS_LZ_H
+#define AGFS_LZ_H
+
+#include "agfs_types.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace agfs {
+
+// LzCodec is a small byte-oriented LZ77 compressor built into the module
+// It uses the LZ4 block layout: each sequence is a token (literal length in
+// the high nibble, match length - 4 in the low nibble, 15 meaning more length
+// bytes follow), the literals, a 2-byte little-endian match offset and the
+// extra match length bytes. The last sequence has literals only.
+//
+// Matches are found through one 4-byte hash table and never overlap the end
+// of the input, which keeps compression fast and the format trivial to
+// decode. The raw size is not stored; callers keep it next to the payload.
+class LzCodec {
+public:
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t MAX_OFFSET = 65535;
+
+    // Upper bound of compress() output for n input bytes
+    static size_t max_compressed_size(size_t n) {
+        return n + n / 255 + 16;
+    }
+
+    // Append the compressed form of in to out
+    // Returns: Number of bytes appended
+    size_t compress(Span<const uint8_t> in, std::vector<uint8_t>& out) {
+        size_t start = out.size();
+        out.resize(start + max_compressed_size(in.size()));
+        uint8_t* op = out.data() + start;
+        const uint8_t* src = in.data();
+        size_t n = in.size();
+
+        table_.assign(TABLE_SIZE, 0);
+        size_t anchor = 0;
+        size_t pos = 0;
+        while (pos + MIN_MATCH <= n) {
+            uint32_t v = load32(src + pos);
+            uint32_t h = hash(v);
+            size_t ref = table_[h]; // position + 1, 0 when empty
+            table_[h] = (uint32_t)(pos + 1);
+            if (ref == 0 || pos - (ref - 1) > MAX_OFFSET || load32(src + ref - 1) != v) {
+                pos += 1 + ((pos - anchor) >> 6); // skip faster through incompressible data
+                continue;
+            }
+            ref--;
+            size_t len = MIN_MATCH;
+            while (pos + len < n && src[ref + len] == src[pos + len]) {
+                len++;
+            }
+            op = emit(op, src + anchor, pos - anchor, pos - ref, len);
+            pos += len;
+            anchor = pos;
+        }
+        op = emit(op, src + anchor, n - anchor, 0, 0);
+
+        size_t written = (size_t)(op - (out.data() + start));
+        out.resize(start + written);
+        return written;
+    }
+
+    // Decode in into out, which must be exactly the raw size
+    static Result<void> decompress(Span<const uint8_t> in, Span<uint8_t> out) {
+        const uint8_t* ip = in.data();
+        const uint8_t* iend = ip + in.size();
+        uint8_t* op = out.data();
+        uint8_t* oend = op + out.size();
+
+        while (ip < iend) {
+            uint8_t token = *ip++;
+            size_t lit = token >> 4;
+            if (lit == 15 && !read_length(ip, iend, lit)) {
+                return corrupt();
+            }
+            if (lit > (size_t)(iend - ip) || lit > (size_t)(oend - op)) {
+                return corrupt();
+            }
+            if (lit > 0) {
+                std::memcpy(op, ip, lit);
+            }
+            ip += lit;
+            op += lit;
+            if (ip == iend) {
+                break; // last sequence
+            }
+
+            if (iend - ip < 2) {
+                return corrupt();
+            }
+            size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            ip += 2;
+            size_t len = (token & 15);
+            if (len == 15 && !read_length(ip, iend, len)) {
+                return corrupt();
+            }
+            len += MIN_MATCH;
+            if (offset == 0 || offset > (size_t)(op - out.data()) || len > (size_t)(oend - op)) {
+                return corrupt();
+            }
+            const uint8_t* match = op - offset;
+            if (offset >= len) {
+                std::memcpy(op, match, len);
+                op += len;
+            } else if (offset >= 8) {
+                // Overlapping, but each 8-byte step only reads bytes already written
+                size_t i = 0;
+                for (; i + 8 <= len; i += 8) {
+                    std::memcpy(op + i, match + i, 8);
+                }
+                for (; i < len; i++) {
+                    op[i] = match[i];
+                }
+                op += len;
+            } else {
+                for (size_t i = 0; i < len; i++) {
+                    *op++ = match[i]; // short period: repeat the pattern byte by byte
+                }
+            }
+        }
+        if (op != oend) {
+            return corrupt();
+        }
+        return Result<void>();
+    }
+
+private:
+    static constexpr uint32_t HASH_BITS = 12;
+    static constexpr size_t TABLE_SIZE = (size_t)1 << HASH_BITS;
+
+    static uint32_t load32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(uint32_t v) {
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    static uint8_t* put_length(uint8_t* op, size_t len) {
+        while (len >= 255) {
+            *op++ = 255;
+            len -= 255;
+        }
+        *op++ = (uint8_t)len;
+        return op;
+    }
+
+    static bool read_length(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+        uint8_t b;
+        do {
+            if (ip == iend) {
+                return false;
+            }
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    }
+
+    // One sequence; match_len 0 emits the final, literal-only one
+    static uint8_t* emit(uint8_t* op, const uint8_t* lit, size_t lit_len, size_t offset, size_t match_len) {
+        uint8_t* token = op++;
+        *token = (uint8_t)((lit_len < 15 ? lit_len : 15) << 4);
+        if (lit_len >= 15) {
+            op = put_length(op, lit_len - 15);
+        }
+        if (lit_len > 0) {
+            std::memcpy(op, lit, lit_len); // lit may be null for an empty input
+        }
+        op += lit_len;
+        if (match_len == 0) {
+            return op;
+        }
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        size_t ml = match_len - MIN_MATCH;
+        *token |= (uint8_t)(ml < 15 ? ml : 15);
+        if (ml >= 15) {
+            op = put_length(op, ml - 15);
+        }
+        return op;
+    }
+
+    static Error corrupt() {
+        return Error::io("corrupt compressed data");
+    }
+
+    std::vector<uint32_t> table_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_LZ_H
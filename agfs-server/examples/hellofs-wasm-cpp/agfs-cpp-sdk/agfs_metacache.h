@@ -0,0 +1,540 @@
+#ifndef AGFS_METACACHE_H
+#define AGFS_METACACHE_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_filesystem_v2.h"
+#include "agfs_state.h"
+#include "agfs_sync.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace agfs {
+
+// MetadataCache is an LRU cache of stat() and readdir() results with a TTL
+// Entries live in a fixed slab indexed by an open-addressing (linear probing)
+// hash table keyed by path, so lookups do not allocate and eviction reuses
+// slots in place. Storage is allocated on the first insert.
+//
+// A capacity or TTL of 0 disables caching. Listings also seed stat entries for
+// their children, so the stat() that usually follows readdir() is a hit.
+// Every method locks in threaded builds; there, use the overloads that copy
+// results out instead of the ones returning pointers.
+class MetadataCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr int64_t DEFAULT_TTL_MS = 1000;
+
+    explicit MetadataCache(size_t capacity = DEFAULT_CAPACITY, int64_t ttl_ms = DEFAULT_TTL_MS)
+        : capacity_(capacity), ttl_ms_(ttl_ms) {}
+
+    // Apply metadata_cache_size (entries) and metadata_cache_ttl_ms from config
+    // Drops everything cached so far.
+    void configure(const Config& config) {
+        internal::LockGuard lock(mu_);
+        int64_t capacity = config.get_i64("metadata_cache_size", (int64_t)capacity_);
+        ttl_ms_ = config.get_i64("metadata_cache_ttl_ms", ttl_ms_);
+        capacity_ = capacity > 0 ? (size_t)capacity : 0;
+        reset_storage();
+    }
+
+    bool enabled() const {
+        return capacity_ > 0 && ttl_ms_ > 0;
+    }
+
+    // Cached stat() result, or nullptr on a miss
+    // The pointer is valid until the next call that modifies the cache.
+    const FileInfo* get_stat(std::string_view path) {
+        internal::LockGuard lock(mu_);
+        return find_stat(path);
+    }
+
+    // Copy the cached stat() result into out
+    // Returns: false on a miss
+    bool get_stat(std::string_view path, FileInfo& out) {
+        internal::LockGuard lock(mu_);
+        const FileInfo* info = find_stat(path);
+        if (info) {
+            out = *info;
+        }
+        return info != nullptr;
+    }
+
+    void put_stat(std::string_view path, const FileInfo& info) {
+        internal::LockGuard lock(mu_);
+        Node* node = upsert(path);
+        if (node) {
+            node->info = info;
+            node->stat_expires = now_ms() + ttl_ms_;
+        }
+    }
+
+    // Cached readdir() result, or nullptr on a miss
+    // The pointer is valid until the next call that modifies the cache.
+    const std::vector<FileInfo>* get_readdir(std::string_view path) {
+        internal::LockGuard lock(mu_);
+        return find_readdir(path);
+    }
+
+    // Copy the cached readdir() result into out
+    // Returns: false on a miss
+    bool get_readdir(std::string_view path, std::vector<FileInfo>& out) {
+        internal::LockGuard lock(mu_);
+        const std::vector<FileInfo>* entries = find_readdir(path);
+        if (entries) {
+            out = *entries;
+        }
+        return entries != nullptr;
+    }
+
+    void put_readdir(std::string_view path, const std::vector<FileInfo>& entries) {
+        internal::LockGuard lock(mu_);
+        if (!enabled()) {
+            return;
+        }
+        int64_t expires = now_ms() + ttl_ms_;
+        std::string child;
+        for (const auto& entry : entries) {
+            join_path(path, entry.name, child);
+            Node* node = upsert(child);
+            node->info = entry;
+            node->stat_expires = expires;
+        }
+        // Insert the listing last so filling in children cannot evict it
+        Node* node = upsert(path);
+        node->entries = entries;
+        node->dir_expires = expires;
+    }
+
+    // Drop path and its parent's listing
+    void invalidate(std::string_view path) {
+        internal::LockGuard lock(mu_);
+        invalidate_locked(path);
+    }
+
+    // Drop path, everything below it and its parent's listing
+    void invalidate_tree(std::string_view path) {
+        internal::LockGuard lock(mu_);
+        invalidate_locked(path);
+        if (live_ == 0) {
+            return;
+        }
+        for (uint32_t i = head_; i != NONE;) {
+            uint32_t next = nodes_[i].next;
+            if (is_below(nodes_[i].path, path)) {
+                erase_node(i);
+            }
+            i = next;
+        }
+    }
+
+    void clear() {
+        internal::LockGuard lock(mu_);
+        reset_storage();
+    }
+
+    size_t size() const {
+        internal::LockGuard lock(mu_);
+        return live_;
+    }
+    size_t capacity() const { return capacity_; }
+    int64_t ttl_ms() const { return ttl_ms_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+    // Parent directory of an absolute path ("/a/b" -> "/a", "/a" -> "/", "/" -> "")
+    static std::string_view parent_path(std::string_view path) {
+        if (path.size() <= 1) {
+            return std::string_view();
+        }
+        size_t slash = path.rfind('/', path.size() - 2);
+        if (slash == std::string_view::npos) {
+            return std::string_view();
+        }
+        return slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        std::string path;
+        uint64_t hash = 0;
+        int64_t stat_expires = 0;
+        int64_t dir_expires = 0;
+        FileInfo info;
+        std::vector<FileInfo> entries;
+        uint32_t prev = NONE; // LRU neighbours; next doubles as the free list link
+        uint32_t next = NONE;
+    };
+
+    const FileInfo* find_stat(std::string_view path) {
+        Node* node = lookup(path);
+        if (node && node->stat_expires > now_ms()) {
+            hits_++;
+            return &node->info;
+        }
+        misses_++;
+        return nullptr;
+    }
+
+    const std::vector<FileInfo>* find_readdir(std::string_view path) {
+        Node* node = lookup(path);
+        if (node && node->dir_expires > now_ms()) {
+            hits_++;
+            return &node->entries;
+        }
+        misses_++;
+        return nullptr;
+    }
+
+    void invalidate_locked(std::string_view path) {
+        erase(path);
+        std::string_view parent = parent_path(path);
+        if (!parent.empty()) {
+            if (Node* node = lookup(parent)) {
+                node->dir_expires = 0;
+                node->entries.clear();
+            }
+        }
+    }
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // FNV-1a
+    static uint64_t hash_path(std::string_view path) {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : path) {
+            h ^= (uint8_t)c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    static void join_path(std::string_view dir, const std::string& name, std::string& out) {
+        out.assign(dir.data(), dir.size());
+        if (out.empty() || out.back() != '/') {
+            out += '/';
+        }
+        out += name;
+    }
+
+    static bool is_below(const std::string& path, std::string_view dir) {
+        if (dir == "/") {
+            return true;
+        }
+        return path.size() > dir.size() && path.compare(0, dir.size(), dir.data(), dir.size()) == 0 &&
+               path[dir.size()] == '/';
+    }
+
+    void reset_storage() {
+        nodes_.clear();
+        nodes_.shrink_to_fit();
+        slots_.clear();
+        slots_.shrink_to_fit();
+        head_ = tail_ = free_ = NONE;
+        live_ = 0;
+    }
+
+    void allocate_storage() {
+        size_t slot_count = 1;
+        while (slot_count < capacity_ * 2) {
+            slot_count <<= 1; // load factor stays at or below 0.5
+        }
+        slots_.assign(slot_count, NONE);
+        mask_ = slot_count - 1;
+        nodes_.resize(capacity_);
+        for (size_t i = 0; i < capacity_; i++) {
+            nodes_[i].next = (i + 1 < capacity_) ? (uint32_t)(i + 1) : NONE;
+        }
+        free_ = 0;
+    }
+
+    // Slot holding path, or the empty slot where it would go
+    size_t probe(std::string_view path, uint64_t hash) const {
+        size_t i = hash & mask_;
+        while (slots_[i] != NONE) {
+            const Node& node = nodes_[slots_[i]];
+            if (node.hash == hash && node.path == path) {
+                break;
+            }
+            i = (i + 1) & mask_;
+        }
+        return i;
+    }
+
+    Node* lookup(std::string_view path) {
+        if (live_ == 0) {
+            return nullptr;
+        }
+        uint32_t idx = slots_[probe(path, hash_path(path))];
+        if (idx == NONE) {
+            return nullptr;
+        }
+        touch(idx);
+        return &nodes_[idx];
+    }
+
+    // Find or insert path, evicting the least recently used entry when full
+    Node* upsert(std::string_view path) {
+        if (!enabled()) {
+            return nullptr;
+        }
+        if (slots_.empty()) {
+            allocate_storage();
+        }
+        uint64_t hash = hash_path(path);
+        size_t slot = probe(path, hash);
+        if (slots_[slot] != NONE) {
+            touch(slots_[slot]);
+            return &nodes_[slots_[slot]];
+        }
+
+        if (free_ == NONE) {
+            erase_node(tail_);
+            slot = probe(path, hash); // eviction may have shifted the probe chain
+        }
+        uint32_t idx = free_;
+        free_ = nodes_[idx].next;
+
+        Node& node = nodes_[idx];
+        node.path.assign(path.data(), path.size());
+        node.hash = hash;
+        node.stat_expires = 0;
+        node.dir_expires = 0;
+        node.entries.clear();
+        slots_[slot] = idx;
+        link_front(idx);
+        live_++;
+        return &node;
+    }
+
+    void erase(std::string_view path) {
+        if (live_ == 0) {
+            return;
+        }
+        uint32_t idx = slots_[probe(path, hash_path(path))];
+        if (idx != NONE) {
+            erase_node(idx);
+        }
+    }
+
+    // Remove a node with backward-shift deletion, so probing needs no tombstones
+    void erase_node(uint32_t idx) {
+        Node& node = nodes_[idx];
+        size_t i = probe(node.path, node.hash);
+        for (size_t j = (i + 1) & mask_; slots_[j] != NONE; j = (j + 1) & mask_) {
+            size_t home = nodes_[slots_[j]].hash & mask_;
+            bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (!stays) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = NONE;
+
+        unlink(idx);
+        node.entries.clear();
+        node.next = free_;
+        free_ = idx;
+        live_--;
+    }
+
+    void link_front(uint32_t idx) {
+        nodes_[idx].prev = NONE;
+        nodes_[idx].next = head_;
+        if (head_ != NONE) {
+            nodes_[head_].prev = idx;
+        }
+        head_ = idx;
+        if (tail_ == NONE) {
+            tail_ = idx;
+        }
+    }
+
+    void unlink(uint32_t idx) {
+        Node& node = nodes_[idx];
+        if (node.prev != NONE) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            head_ = node.next;
+        }
+        if (node.next != NONE) {
+            nodes_[node.next].prev = node.prev;
+        } else {
+            tail_ = node.prev;
+        }
+        node.prev = node.next = NONE;
+    }
+
+    void touch(uint32_t idx) {
+        if (idx != head_) {
+            unlink(idx);
+            link_front(idx);
+        }
+    }
+
+    size_t capacity_;
+    int64_t ttl_ms_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> slots_;
+    size_t mask_ = 0;
+    uint32_t head_ = NONE; // most recently used
+    uint32_t tail_ = NONE; // least recently used
+    uint32_t free_ = NONE;
+    size_t live_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    mutable internal::Mutex mu_;
+};
+
+namespace internal {
+
+// Path and write data argument types of FileSystem / FileSystemV2 methods
+template<typename Base, bool V2 = std::is_base_of<FileSystemV2, Base>::value>
+struct FsArgTypes {
+    using Path = const std::string&;
+    using Data = const std::vector<uint8_t>&;
+};
+
+template<typename Base>
+struct FsArgTypes<Base, true> {
+    using Path = std::string_view;
+    using Data = Span<const uint8_t>;
+};
+
+} // namespace internal
+
+// MetadataCached puts a MetadataCache in front of a plugin's stat()/readdir()
+// and invalidates it after the plugin's own write/writev/create/mkdir/remove/rename/chmod:
+//
+//   AGFS_EXPORT_PLUGIN(agfs::MetadataCached<MyProxyFS>);
+//
+// The cache is configured from metadata_cache_size / metadata_cache_ttl_ms in
+// initialize(), and export_state() carries that config ahead of the plugin's
+// own snapshot. Writes made through custom FileHandles bypass these methods;
+// call cache().invalidate() from them, or for changes made outside the plugin.
+template<typename Base>
+class MetadataCached : public Base {
+    using Path = typename internal::FsArgTypes<Base>::Path;
+    using Data = typename internal::FsArgTypes<Base>::Data;
+
+public:
+    using Base::Base;
+
+    MetadataCache& cache() { return cache_; }
+
+    Result<void> initialize(const Config& config) override {
+        cache_.configure(config);
+        config_ = config;
+        return Base::initialize(config);
+    }
+
+    Result<std::vector<uint8_t>> export_state() override {
+        return internal::prepend_config_state(Base::export_state(), config_);
+    }
+
+    Result<void> import_state(Span<const uint8_t> state) override {
+        StateReader r(state);
+        Config config = r.config();
+        if (!r.ok()) {
+            return Error::invalid_input("corrupt metadata cache state");
+        }
+        cache_.configure(config);
+        config_ = std::move(config);
+        return Base::import_state(r.remaining());
+    }
+
+    Result<void> shutdown() override {
+        cache_.clear();
+        return Base::shutdown();
+    }
+
+    Result<FileInfo> stat(Path path) override {
+        FileInfo cached;
+        if (cache_.get_stat(path, cached)) {
+            return cached;
+        }
+        auto result = Base::stat(path);
+        if (result.is_ok()) {
+            cache_.put_stat(path, result.unwrap());
+        }
+        return result;
+    }
+
+    Result<std::vector<FileInfo>> readdir(Path path) override {
+        std::vector<FileInfo> cached;
+        if (cache_.get_readdir(path, cached)) {
+            return cached;
+        }
+        auto result = Base::readdir(path);
+        if (result.is_ok()) {
+            cache_.put_readdir(path, result.unwrap());
+        }
+        return result;
+    }
+
+    Result<int64_t> write(Path path, Data data, int64_t offset, WriteFlag flags) override {
+        Result<int64_t> result = Base::write(path, data, offset, flags);
+        cache_.invalidate(path);
+        return result;
+    }
+
+    Result<int64_t> writev(Path path, Span<const WriteSegment> segments, WriteFlag flags) override {
+        Result<int64_t> result = Base::writev(path, segments, flags);
+        cache_.invalidate(path);
+        return result;
+    }
+
+    Result<void> create(Path path) override {
+        Result<void> result = Base::create(path);
+        cache_.invalidate(path);
+        return result;
+    }
+
+    Result<void> mkdir(Path path, uint32_t perm) override {
+        Result<void> result = Base::mkdir(path, perm);
+        cache_.invalidate(path);
+        return result;
+    }
+
+    Result<void> remove(Path path) override {
+        Result<void> result = Base::remove(path);
+        cache_.invalidate(path);
+        return result;
+    }
+
+    Result<void> remove_all(Path path) override {
+        Result<void> result = Base::remove_all(path);
+        cache_.invalidate_tree(path);
+        return result;
+    }
+
+    Result<void> rename(Path old_path, Path new_path) override {
+        Result<void> result = Base::rename(old_path, new_path);
+        cache_.invalidate_tree(old_path);
+        cache_.invalidate_tree(new_path);
+        return result;
+    }
+
+    Result<void> chmod(Path path, uint32_t mode) override {
+        Result<void> result = Base::chmod(path, mode);
+        cache_.invalidate(path);
+        return result;
+    }
+
+private:
+    MetadataCache cache_;
+    Config config_; // for export_state()
+};
+
+} // namespace agfs
+
+#endif // AGFS_METACACHE_H
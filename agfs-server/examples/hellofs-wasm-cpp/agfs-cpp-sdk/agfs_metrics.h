@@ -0,0 +1,188 @@
+#ifndef AGFS_METRICS_H
+#define AGFS_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace agfs {
+
+// Operations timed when the SDK is built with -DAGFS_ENABLE_METRICS
+// fs_* / handle_* are the plugin's exported entry points (variants such as
+// fs_stat_bin count as fs_stat); hostfs_* and http_* are calls into the host.
+enum class Metric : uint32_t {
+    FsRead, FsWrite, FsStat, FsReaddir, FsCreate, FsMkdir, FsRemove, FsRemoveAll,
+    FsRename, FsChmod, FsBatch, FsReadv, FsWritev,
+    HandleOpen, HandleRead, HandleWrite, HandleSeek, HandleSync, HandleStat, HandleClose,
+    HostFsRead, HostFsWrite, HostFsStat, HostFsReaddir, HostFsCopy, HostFsMap, HostFsOther,
+    HttpRequest, HttpStreamOpen, HttpStreamRead, HttpWait,
+    Count
+};
+
+inline const char* metric_name(Metric m) {
+    static const char* const names[] = {
+        "fs_read", "fs_write", "fs_stat", "fs_readdir", "fs_create", "fs_mkdir", "fs_remove", "fs_remove_all",
+        "fs_rename", "fs_chmod", "fs_batch", "fs_readv", "fs_writev",
+        "handle_open", "handle_read", "handle_write", "handle_seek", "handle_sync", "handle_stat", "handle_close",
+        "hostfs_read", "hostfs_write", "hostfs_stat", "hostfs_readdir", "hostfs_copy", "hostfs_map", "hostfs_other",
+        "http_request", "http_stream_open", "http_stream_read", "http_wait",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)Metric::Count, "metric name table out of sync");
+    return names[(uint32_t)m];
+}
+
+// Lock-free per-operation counters and log2 latency histograms
+// Bucket i counts calls that took [2^i, 2^(i+1)) nanoseconds (bucket 0 also
+// takes 0ns). Bytes "in" enter the plugin (write data, host read results,
+// HTTP response bodies); bytes "out" leave it (read results, host writes,
+// HTTP request bodies).
+class MetricsRegistry {
+public:
+    static constexpr uint32_t BUCKETS = 40; // up to ~18 minutes
+
+    void record(Metric m, uint64_t nanos, uint64_t bytes_in, uint64_t bytes_out) {
+        Op& op = ops_[(uint32_t)m];
+        op.count.fetch_add(1, std::memory_order_relaxed);
+        op.total_ns.fetch_add(nanos, std::memory_order_relaxed);
+        if (bytes_in) op.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+        if (bytes_out) op.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+        op.buckets[bucket_for(nanos)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Encode every operation recorded since the last drain and reset it
+    // Layout (little-endian): u32 version (1), u32 op_count, then per op:
+    // u32 len + name, u64 count, u64 total_ns, u64 bytes_in, u64 bytes_out,
+    // u32 bucket_count, bucket_count × (u32 index, u64 calls) for the
+    // non-empty buckets only.
+    std::vector<uint8_t> drain() {
+        std::vector<uint8_t> out;
+        put(out, (uint32_t)1);
+        put(out, (uint32_t)0); // op_count, patched below
+        uint32_t op_count = 0;
+        for (uint32_t i = 0; i < (uint32_t)Metric::Count; i++) {
+            Op& op = ops_[i];
+            uint64_t count = op.count.exchange(0, std::memory_order_relaxed);
+            if (count == 0) {
+                continue;
+            }
+            uint64_t buckets[BUCKETS];
+            uint32_t used = 0;
+            for (uint32_t b = 0; b < BUCKETS; b++) {
+                buckets[b] = op.buckets[b].exchange(0, std::memory_order_relaxed);
+                if (buckets[b]) used++;
+            }
+
+            const char* name = metric_name((Metric)i);
+            uint32_t name_len = (uint32_t)std::strlen(name);
+            put(out, name_len);
+            out.insert(out.end(), name, name + name_len);
+            put(out, count);
+            put(out, op.total_ns.exchange(0, std::memory_order_relaxed));
+            put(out, op.bytes_in.exchange(0, std::memory_order_relaxed));
+            put(out, op.bytes_out.exchange(0, std::memory_order_relaxed));
+            put(out, used);
+            for (uint32_t b = 0; b < BUCKETS; b++) {
+                if (buckets[b]) {
+                    put(out, b);
+                    put(out, buckets[b]);
+                }
+            }
+            op_count++;
+        }
+        std::memcpy(out.data() + 4, &op_count, 4);
+        return out;
+    }
+
+    // Upper bound on the size of a drain() result
+    static size_t max_drain_size() {
+        size_t size = 8;
+        for (uint32_t i = 0; i < (uint32_t)Metric::Count; i++) {
+            size += 4 + std::strlen(metric_name((Metric)i)) + 4 * 8 + 4 + BUCKETS * (4 + 8);
+        }
+        return size;
+    }
+
+    static uint32_t bucket_for(uint64_t nanos) {
+        if (nanos == 0) {
+            return 0;
+        }
+        uint32_t b = 63 - (uint32_t)__builtin_clzll(nanos);
+        return b < BUCKETS ? b : BUCKETS - 1;
+    }
+
+private:
+    struct Op {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> bytes_in{0};
+        std::atomic<uint64_t> bytes_out{0};
+        std::atomic<uint64_t> buckets[BUCKETS] = {};
+    };
+
+    template<typename T>
+    static void put(std::vector<uint8_t>& out, T v) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    Op ops_[(uint32_t)Metric::Count];
+};
+
+// Module-wide registry drained by the plugin_get_metrics export
+inline MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+namespace internal {
+
+constexpr bool metrics_enabled() {
+#ifdef AGFS_ENABLE_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace internal
+
+// Times the enclosing block into metrics() when AGFS_ENABLE_METRICS is
+// defined; otherwise it is empty and compiles away
+class MetricScope {
+public:
+#ifdef AGFS_ENABLE_METRICS
+    explicit MetricScope(Metric m) : metric_(m), start_(now_ns()) {}
+
+    ~MetricScope() {
+        metrics().record(metric_, now_ns() - start_, in_, out_);
+    }
+
+    void bytes_in(uint64_t n) { in_ += n; }
+    void bytes_out(uint64_t n) { out_ += n; }
+
+private:
+    static uint64_t now_ns() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Metric metric_;
+    uint64_t start_;
+    uint64_t in_ = 0;
+    uint64_t out_ = 0;
+#else
+    explicit MetricScope(Metric) {}
+
+    void bytes_in(uint64_t) {}
+    void bytes_out(uint64_t) {}
+#endif
+
+    MetricScope(const MetricScope&) = delete;
+    MetricScope& operator=(const MetricScope&) = delete;
+};
+
+} // namespace agfs
+
+#endif // AGFS_METRICS_H
@@ -0,0 +1,613 @@
+#ifndef AGFS_ROUTER_H
+#define AGFS_ROUTER_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_sync.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+// PathComponents splits a path into its non-empty components in place
+// Repeated and trailing slashes are skipped; nothing is allocated.
+class PathComponents {
+public:
+    explicit PathComponents(std::string_view path) : path_(path), pos_(0) {}
+
+    // Store the next component in out
+    // Returns: false when there are no more components
+    bool next(std::string_view& out) {
+        while (pos_ < path_.size() && path_[pos_] == '/') {
+            pos_++;
+        }
+        if (pos_ >= path_.size()) {
+            return false;
+        }
+        size_t end = path_.find('/', pos_);
+        if (end == std::string_view::npos) {
+            end = path_.size();
+        }
+        out = path_.substr(pos_, end - pos_);
+        pos_ = end;
+        return true;
+    }
+
+    // Offset just past the last component returned
+    size_t position() const {
+        return pos_;
+    }
+
+private:
+    std::string_view path_;
+    size_t pos_;
+};
+
+// PathInterner maps path component names to dense ids
+// Names are packed into one string and indexed by an open-addressing
+// (linear probing) table, so find() hashes once and never allocates.
+class PathInterner {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Id of name, adding it if it is new
+    uint32_t intern(std::string_view name) {
+        if ((spans_.size() + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        uint64_t hash = hash_name(name);
+        size_t slot = probe(name, hash);
+        if (slots_[slot] != NONE) {
+            return slots_[slot];
+        }
+        uint32_t id = (uint32_t)spans_.size();
+        spans_.push_back(Entry{(uint32_t)names_.size(), (uint32_t)name.size(), hash});
+        names_.append(name.data(), name.size());
+        slots_[slot] = id;
+        return id;
+    }
+
+    // Id of name, or NONE if it was never interned
+    uint32_t find(std::string_view name) const {
+        if (spans_.empty()) {
+            return NONE;
+        }
+        return slots_[probe(name, hash_name(name))];
+    }
+
+    std::string_view name(uint32_t id) const {
+        const Entry& e = spans_[id];
+        return std::string_view(names_.data() + e.offset, e.size);
+    }
+
+    size_t size() const {
+        return spans_.size();
+    }
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t size;
+        uint64_t hash;
+    };
+
+    // FNV-1a
+    static uint64_t hash_name(std::string_view name) {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : name) {
+            h ^= (uint8_t)c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Slot holding name, or the empty slot where it would go
+    size_t probe(std::string_view name, uint64_t hash) const {
+        size_t mask = slots_.size() - 1;
+        size_t i = hash & mask;
+        while (slots_[i] != NONE) {
+            const Entry& e = spans_[slots_[i]];
+            if (e.hash == hash && this->name(slots_[i]) == name) {
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        size_t count = slots_.empty() ? 16 : slots_.size() * 2;
+        slots_.assign(count, NONE);
+        for (uint32_t id = 0; id < spans_.size(); id++) {
+            size_t i = spans_[id].hash & (count - 1);
+            while (slots_[i] != NONE) {
+                i = (i + 1) & (count - 1);
+            }
+            slots_[i] = id;
+        }
+    }
+
+    std::string names_;
+    std::vector<Entry> spans_;
+    std::vector<uint32_t> slots_;
+};
+
+// PathRouter maps path prefixes to handlers with a radix trie
+// Edges are labelled with runs of interned component ids, so a chain of
+// single-child directories is one edge and matching a path costs one hash
+// per component plus a binary search per trie node: O(path length) however
+// many prefixes are mapped. A prefix covers itself and everything below it
+// on component boundaries ("/a" matches "/a/b" but not "/ab"); "/" maps the
+// root and is the fallback for paths no longer prefix matches.
+template<typename Handler>
+class PathRouter {
+public:
+    struct Match {
+        Handler* handler = nullptr;  // nullptr when no prefix matches
+        std::string_view prefix;     // the part of the path that matched
+        std::string_view rest;       // the remainder, "" or starting with '/'
+    };
+
+    PathRouter() : nodes_(1) {}
+
+    // Map prefix and everything below it to handler, replacing any previous mapping
+    void add(std::string_view prefix, Handler handler) {
+        uint32_t node = 0;
+        size_t depth = 0;
+        PathComponents parts(prefix);
+        std::string_view comp;
+        while (parts.next(comp)) {
+            uint32_t id = interner_.intern(comp);
+            if (depth < nodes_[node].label.size()) {
+                if (nodes_[node].label[depth] == id) {
+                    depth++;
+                    continue;
+                }
+                split(node, depth);
+            }
+            uint32_t child = find_child(node, id);
+            if (child == NONE) {
+                // New leaf holding the whole remaining run
+                Node leaf;
+                leaf.label.push_back(id);
+                while (parts.next(comp)) {
+                    leaf.label.push_back(interner_.intern(comp));
+                }
+                child = (uint32_t)nodes_.size();
+                nodes_.push_back(std::move(leaf));
+                link_child(node, child);
+                node = child;
+                depth = nodes_[node].label.size();
+                break;
+            }
+            node = child;
+            depth = 1;
+        }
+        if (depth < nodes_[node].label.size()) {
+            split(node, depth);
+        }
+
+        Node& target = nodes_[node];
+        if (target.handler == NONE) {
+            target.handler = (uint32_t)handlers_.size();
+            handlers_.push_back(std::move(handler));
+            live_.push_back(true);
+        } else {
+            handlers_[target.handler] = std::move(handler);
+        }
+    }
+
+    // Drop the mapping of exactly prefix
+    // Returns: false if prefix was not mapped
+    bool remove(std::string_view prefix) {
+        uint32_t node = 0;
+        size_t depth = 0;
+        if (!walk(prefix, node, depth, [](uint32_t, size_t) {}) || depth != nodes_[node].label.size() ||
+            nodes_[node].handler == NONE) {
+            return false;
+        }
+        live_[nodes_[node].handler] = false;
+        nodes_[node].handler = NONE;
+        return true;
+    }
+
+    // Longest mapped prefix of path
+    Match match(std::string_view path) {
+        Match m;
+        uint32_t node = 0;
+        size_t depth = 0;
+        size_t end = 0;
+        if (nodes_[0].handler != NONE) {
+            m.handler = &handlers_[nodes_[0].handler];
+        }
+        walk(path, node, depth, [&](uint32_t at, size_t pos) {
+            m.handler = &handlers_[nodes_[at].handler];
+            end = pos;
+        });
+        if (m.handler != nullptr) {
+            m.prefix = path.substr(0, end);
+            m.rest = path.substr(end);
+        }
+        return m;
+    }
+
+    // Call fn(name) for each component one level below path that leads
+    // towards a mapped prefix
+    // Returns: false if no mapped prefix lies at or below path
+    template<typename Fn>
+    bool for_each_child(std::string_view path, Fn fn) const {
+        uint32_t node = 0;
+        size_t depth = 0;
+        if (!walk(path, node, depth, [](uint32_t, size_t) {})) {
+            return false;
+        }
+        const Node& n = nodes_[node];
+        if (depth < n.label.size()) {
+            fn(interner_.name(n.label[depth]));
+        } else {
+            for (uint32_t child : n.children) {
+                fn(interner_.name(nodes_[child].label[0]));
+            }
+        }
+        return true;
+    }
+
+    // Call fn(handler) for every mapped handler
+    template<typename Fn>
+    void for_each(Fn fn) {
+        for (size_t i = 0; i < handlers_.size(); i++) {
+            if (live_[i]) {
+                fn(handlers_[i]);
+            }
+        }
+    }
+
+    const PathInterner& interner() const {
+        return interner_;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        std::vector<uint32_t> label;     // component ids on the edge into this node
+        std::vector<uint32_t> children;  // node indices, sorted by their first label id
+        uint32_t handler = NONE;
+    };
+
+    // Follow path down the trie, calling on_handler(node, end offset) at each
+    // mapped node passed. Leaves node/depth at the deepest position reached.
+    // Returns: true if every component of path was matched
+    template<typename OnHandler>
+    bool walk(std::string_view path, uint32_t& node, size_t& depth, OnHandler on_handler) const {
+        PathComponents parts(path);
+        std::string_view comp;
+        while (parts.next(comp)) {
+            uint32_t id = interner_.find(comp);
+            if (id == PathInterner::NONE) {
+                return false;
+            }
+            if (depth < nodes_[node].label.size()) {
+                if (nodes_[node].label[depth] != id) {
+                    return false;
+                }
+                depth++;
+            } else {
+                uint32_t child = find_child(node, id);
+                if (child == NONE) {
+                    return false;
+                }
+                node = child;
+                depth = 1;
+            }
+            if (depth == nodes_[node].label.size() && nodes_[node].handler != NONE) {
+                on_handler(node, parts.position());
+            }
+        }
+        return true;
+    }
+
+    uint32_t find_child(uint32_t node, uint32_t id) const {
+        const std::vector<uint32_t>& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), id, [this](uint32_t child, uint32_t key) {
+            return nodes_[child].label[0] < key;
+        });
+        if (it != children.end() && nodes_[*it].label[0] == id) {
+            return *it;
+        }
+        return NONE;
+    }
+
+    void link_child(uint32_t node, uint32_t child) {
+        uint32_t id = nodes_[child].label[0];
+        std::vector<uint32_t>& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), id, [this](uint32_t c, uint32_t key) {
+            return nodes_[c].label[0] < key;
+        });
+        children.insert(it, child);
+    }
+
+    // Cut node's edge after depth components; the tail becomes its only child
+    void split(uint32_t node, size_t depth) {
+        Node tail;
+        tail.label.assign(nodes_[node].label.begin() + depth, nodes_[node].label.end());
+        tail.children = std::move(nodes_[node].children);
+        tail.handler = nodes_[node].handler;
+        uint32_t index = (uint32_t)nodes_.size();
+        nodes_.push_back(std::move(tail));
+
+        Node& head = nodes_[node];
+        head.label.resize(depth);
+        head.children.assign(1, index);
+        head.handler = NONE;
+    }
+
+    PathInterner interner_;
+    std::vector<Node> nodes_;   // nodes_[0] is the root, with an empty label
+    std::vector<Handler> handlers_;
+    std::vector<bool> live_;
+};
+
+// RoutedFS serves sub-filesystems mounted at path prefixes
+// Each call is routed through a PathRouter to the longest matching mount
+// and reaches it with the path relative to the mount ("/" for the mount
+// point itself). Directories leading to mounts are listed and stat'ed as
+// directories even when no mount covers them. Rename works within one mount
+// only. Sub-filesystems are called through the plain FileSystem interface,
+// so handle-based mounts go through their stateless methods.
+// Mount during initialize(): routing itself takes no lock, so threaded
+// builds must not change the mounts while calls are in flight.
+//
+//   class MyFS : public agfs::RoutedFS {
+//       agfs::Result<void> initialize(const agfs::Config& config) override {
+//           mount("/logs", std::make_unique<LogFS>());
+//           mount("/tenants/acme/data", data_);
+//           return agfs::Result<void>();
+//       }
+//   };
+class RoutedFS : public FileSystem {
+public:
+    const char* name() const override {
+        return "routedfs";
+    }
+
+    // Serve fs at prefix; fs is not owned and must outlive the mount
+    void mount(std::string_view prefix, FileSystem& fs) {
+        router_.add(prefix, &fs);
+    }
+
+    // Serve fs at prefix; the router keeps it alive
+    void mount(std::string_view prefix, std::unique_ptr<FileSystem> fs) {
+        router_.add(prefix, fs.get());
+        owned_.push_back(std::move(fs));
+    }
+
+    // Returns: false if nothing was mounted at exactly prefix
+    bool unmount(std::string_view prefix) {
+        return router_.remove(prefix);
+    }
+
+    PathRouter<FileSystem*>& router() {
+        return router_;
+    }
+
+    // Shuts every mounted filesystem down once; returns the first error
+    Result<void> shutdown() override {
+        Result<void> first;
+        std::vector<FileSystem*> done;
+        router_.for_each([&](FileSystem* fs) {
+            if (std::find(done.begin(), done.end(), fs) != done.end()) {
+                return;
+            }
+            done.push_back(fs);
+            auto result = fs->shutdown();
+            if (result.is_err() && first.is_ok()) {
+                first = result;
+            }
+        });
+        return first;
+    }
+
+    Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->read(local(m, scratch_), offset, size);
+    }
+
+    Result<int64_t> read_into(const std::string& path, int64_t offset, Span<uint8_t> buf) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->read_into(local(m, scratch_), offset, buf);
+    }
+
+    Result<void> readv(const std::string& path, Span<ReadSegment> segments) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->readv(local(m, scratch_), segments);
+    }
+
+    Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data, int64_t offset,
+                          WriteFlag flags) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->write(local(m, scratch_), data, offset, flags);
+    }
+
+    Result<int64_t> writev(const std::string& path, Span<const WriteSegment> segments, WriteFlag flags) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->writev(local(m, scratch_), segments, flags);
+    }
+
+    Result<void> create(const std::string& path) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->create(local(m, scratch_));
+    }
+
+    Result<void> mkdir(const std::string& path, uint32_t perm) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->mkdir(local(m, scratch_), perm);
+    }
+
+    Result<void> remove(const std::string& path) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->remove(local(m, scratch_));
+    }
+
+    Result<void> remove_all(const std::string& path) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->remove_all(local(m, scratch_));
+    }
+
+    Result<void> chmod(const std::string& path, uint32_t mode) override {
+        auto m = router_.match(path);
+        if (m.handler == nullptr) {
+            return Error::not_found();
+        }
+        return (*m.handler)->chmod(local(m, scratch_), mode);
+    }
+
+    Result<void> rename(const std::string& old_path, const std::string& new_path) override {
+        auto from = router_.match(old_path);
+        auto to = router_.match(new_path);
+        if (from.handler == nullptr || to.handler == nullptr) {
+            return Error::not_found();
+        }
+        if (from.handler != to.handler) {
+            return Error::other("cannot rename across different mounts");
+        }
+        return (*from.handler)->rename(local(from, scratch_), local(to, scratch2_));
+    }
+
+    Result<FileInfo> stat(const std::string& path) override {
+        auto m = router_.match(path);
+        if (m.handler != nullptr) {
+            auto result = (*m.handler)->stat(local(m, scratch_));
+            if (result.is_ok()) {
+                FileInfo info = result.unwrap();
+                if (at_mount_point(m)) {
+                    info.name = std::string(base_name(path)); // the mount's root has no name of its own
+                }
+                return info;
+            }
+            if (result.unwrap_err().kind != ErrorKind::NotFound) {
+                return result.unwrap_err();
+            }
+        }
+        if (router_.for_each_child(path, [](std::string_view) {})) {
+            return FileInfo::dir(std::string(base_name(path)), 0755);
+        }
+        return Error::not_found();
+    }
+
+    Result<std::vector<FileInfo>> readdir(const std::string& path) override {
+        std::vector<FileInfo> entries;
+        bool found = false;
+        auto m = router_.match(path);
+        if (m.handler != nullptr) {
+            auto result = (*m.handler)->readdir(local(m, scratch_));
+            if (result.is_ok()) {
+                entries = std::move(result.unwrap());
+                found = true;
+            } else if (result.unwrap_err().kind != ErrorKind::NotFound) {
+                return result.unwrap_err();
+            }
+        }
+        size_t listed = entries.size();
+        bool leads_to_mounts = router_.for_each_child(path, [&](std::string_view child) {
+            for (size_t i = 0; i < listed; i++) {
+                if (entries[i].name == child) {
+                    return;
+                }
+            }
+            entries.push_back(FileInfo::dir(std::string(child), 0755));
+        });
+        if (!found && !leads_to_mounts) {
+            return Error::not_found();
+        }
+        return entries;
+    }
+
+    // Pages come from the mount itself unless mounts below path have to be merged in
+    Result<DirPage> readdir_page(const std::string& path, const std::string& cursor, size_t max_entries) override {
+        auto m = router_.match(path);
+        bool mounts_below = false;
+        router_.for_each_child(path, [&](std::string_view) { mounts_below = true; });
+        if (m.handler != nullptr && !mounts_below) {
+            return (*m.handler)->readdir_page(local(m, scratch_), cursor, max_entries);
+        }
+        return FileSystem::readdir_page(path, cursor, max_entries);
+    }
+
+private:
+#ifdef AGFS_THREADS
+    using LocalPath = std::string; // calls run concurrently, so each builds its own
+#else
+    using LocalPath = const std::string&;
+#endif
+
+    // The path as the mount sees it, built in scratch so steady-state calls reuse its capacity
+    static LocalPath local(const PathRouter<FileSystem*>::Match& m, std::string& scratch) {
+#ifdef AGFS_THREADS
+        (void)scratch;
+        std::string path;
+#else
+        std::string& path = scratch;
+#endif
+        if (at_mount_point(m)) {
+            path.assign(1, '/');
+        } else {
+            path.assign(m.rest.data(), m.rest.size());
+        }
+        return path;
+    }
+
+    static bool at_mount_point(const PathRouter<FileSystem*>::Match& m) {
+        return m.rest.find_first_not_of('/') == std::string_view::npos;
+    }
+
+    static std::string_view base_name(std::string_view path) {
+        size_t end = path.find_last_not_of('/');
+        if (end == std::string_view::npos) {
+            return std::string_view();
+        }
+        size_t slash = path.rfind('/', end);
+        size_t start = slash == std::string_view::npos ? 0 : slash + 1;
+        return path.substr(start, end + 1 - start);
+    }
+
+    PathRouter<FileSystem*> router_;
+    std::vector<std::unique_ptr<FileSystem>> owned_;
+    std::string scratch_;
+    std::string scratch2_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_ROUTER_H
@@ -0,0 +1,53 @@
+#ifndef AGFS_SIMD_H
+#define AGFS_SIMD_H
+
+// Compile-time selection of the SDK's wasm simd128 kernels
+//
+// Building with -msimd128 (make build-em-simd / build-wasi-simd) defines
+// __wasm_simd128__ and turns on the vector paths in agfs_base64.h and
+// agfs_json.h. Every kernel has a scalar fallback that produces identical
+// output, used for plain wasm builds, native builds, and when
+// AGFS_NO_SIMD is defined.
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__wasm_simd128__) && !defined(AGFS_NO_SIMD)
+#define AGFS_SIMD128 1
+#include <wasm_simd128.h>
+#endif
+
+namespace agfs {
+namespace internal {
+
+// Offset of the first byte in [p, p + n) that a JSON string cannot hold
+// unescaped ('"', '\\' or a control character), or n if there is none
+inline size_t find_json_special(const char* p, size_t n) {
+    size_t i = 0;
+#ifdef AGFS_SIMD128
+    const v128_t quote = wasm_i8x16_splat('"');
+    const v128_t backslash = wasm_i8x16_splat('\\');
+    const v128_t space = wasm_i8x16_splat(0x20);
+    for (; i + 16 <= n; i += 16) {
+        v128_t v = wasm_v128_load(p + i);
+        v128_t special = wasm_v128_or(
+            wasm_v128_or(wasm_i8x16_eq(v, quote), wasm_i8x16_eq(v, backslash)),
+            wasm_u8x16_lt(v, space));
+        if (wasm_v128_any_true(special)) {
+            return i + (size_t)__builtin_ctz(wasm_i8x16_bitmask(special));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        unsigned char c = (unsigned char)p[i];
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return i;
+        }
+    }
+    return n;
+}
+
+} // namespace internal
+} // namespace agfs
+
+#endif // AGFS_SIMD_H
@@ -0,0 +1,152 @@
+#ifndef AGFS_STATE_H
+#define AGFS_STATE_H
+
+#include "agfs_types.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace agfs {
+
+// Plugin state snapshots
+//
+// The host runs plugin_initialize on one instance only. If the plugin
+// overrides export_state(), the host keeps the returned bytes and hands them
+// to import_state() on every instance the pool creates later, so expensive
+// setup (scanning a host directory, building an index) happens once per
+// mount instead of once per instance. Without an override, new instances
+// simply re-run initialize() with the same config.
+//
+// StateWriter and StateReader are a minimal little-endian encoding for
+// those snapshots:
+//
+//   Result<std::vector<uint8_t>> export_state() override {
+//       std::vector<uint8_t> out;
+//       agfs::StateWriter w(out);
+//       w.str(prefix_);
+//       w.u32((uint32_t)index_.size());
+//       for (const auto& [name, size] : index_) { w.str(name); w.i64(size); }
+//       return out;
+//   }
+//
+//   Result<void> import_state(Span<const uint8_t> state) override {
+//       agfs::StateReader r(state);
+//       prefix_ = r.str();
+//       for (uint32_t n = r.u32(); n > 0 && r.ok(); n--) {
+//           std::string name = r.str();
+//           index_[name] = r.i64();
+//       }
+//       if (!r.ok()) return agfs::Error::invalid_input("corrupt state");
+//       return Result<void>();
+//   }
+
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back(v); }
+    void u32(uint32_t v) { put(&v, sizeof(v)); }
+    void u64(uint64_t v) { put(&v, sizeof(v)); }
+    void i64(int64_t v) { put(&v, sizeof(v)); }
+    void f64(double v) { put(&v, sizeof(v)); }
+
+    // u32 length prefix, then the bytes
+    void str(const std::string& s) { bytes(s.data(), s.size()); }
+    void bytes(const void* data, size_t len) {
+        u32((uint32_t)len);
+        put(data, len);
+    }
+
+    // u32 entry count, then key/value strings
+    void config(const Config& c) {
+        u32((uint32_t)c.values.size());
+        for (const auto& kv : c.values) {
+            str(kv.first);
+            str(kv.second);
+        }
+    }
+
+private:
+    void put(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out_.insert(out_.end(), p, p + len);
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+// Bounds-checked reader for StateWriter output
+// Reading past the end returns zero values and latches ok() to false.
+class StateReader {
+public:
+    explicit StateReader(Span<const uint8_t> data) : data_(data), pos_(0), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    bool at_end() const { return pos_ == data_.size(); }
+
+    // Bytes not read yet
+    Span<const uint8_t> remaining() const {
+        return Span<const uint8_t>(data_.data() + pos_, data_.size() - pos_);
+    }
+
+    uint8_t u8() { uint8_t v = 0; get(&v, sizeof(v)); return v; }
+    uint32_t u32() { uint32_t v = 0; get(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; get(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; get(&v, sizeof(v)); return v; }
+    double f64() { double v = 0; get(&v, sizeof(v)); return v; }
+
+    std::string str() {
+        uint32_t len = u32();
+        if (!ok_ || len > data_.size() - pos_) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string s(reinterpret_cast<const char*>(data_.data() + pos_), len);
+        pos_ += len;
+        return s;
+    }
+
+    Config config() {
+        Config c;
+        for (uint32_t n = u32(); n > 0 && ok_; n--) {
+            std::string key = str();
+            c.values[std::move(key)] = str();
+        }
+        return c;
+    }
+
+private:
+    void get(void* out, size_t len) {
+        if (!ok_ || len > data_.size() - pos_) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(out, data_.data() + pos_, len);
+        pos_ += len;
+    }
+
+    Span<const uint8_t> data_;
+    size_t pos_;
+    bool ok_;
+};
+
+namespace internal {
+
+// Snapshot for decorators that configure themselves in initialize(): config
+// goes ahead of the wrapped plugin's snapshot. An empty inner snapshot stays
+// empty, so the host re-runs initialize() through the whole chain instead.
+inline Result<std::vector<uint8_t>> prepend_config_state(Result<std::vector<uint8_t>> inner, const Config& config) {
+    if (inner.is_err() || inner.unwrap().empty()) {
+        return inner;
+    }
+    std::vector<uint8_t> out;
+    StateWriter w(out);
+    w.config(config);
+    out.insert(out.end(), inner.unwrap().begin(), inner.unwrap().end());
+    return out;
+}
+
+} // namespace internal
+} // namespace agfs
+
+#endif // AGFS_STATE_H
@@ -0,0 +1,59 @@
+#ifndef AGFS_SYNC_H
+#define AGFS_SYNC_H
+
+// Threaded builds (make build-wasi-threads) define AGFS_THREADS. The host
+// then runs several workers over one shared linear memory, so the plugin
+// object and everything it owns are reached from concurrent calls, while
+// per-call state (shared buffers, the call arena) lives in each worker's TLS.
+// Without AGFS_THREADS every primitive here compiles to nothing.
+
+#include <cstdint>
+
+#ifdef AGFS_THREADS
+#include <mutex>
+#define AGFS_THREAD_LOCAL thread_local
+#else
+#define AGFS_THREAD_LOCAL
+#endif
+
+// Stack the host reserves for each worker of a threaded build
+#ifndef AGFS_THREAD_STACK_SIZE
+#define AGFS_THREAD_STACK_SIZE (64 * 1024)
+#endif
+
+namespace agfs {
+namespace internal {
+
+#ifdef AGFS_THREADS
+using Mutex = std::mutex;
+using LockGuard = std::lock_guard<Mutex>;
+// For decorators whose locked sections call back into the plugin
+using RecursiveMutex = std::recursive_mutex;
+using RecursiveLockGuard = std::lock_guard<RecursiveMutex>;
+#else
+// Single-threaded builds keep the same call sites without locking
+struct Mutex {
+    void lock() {}
+    void unlock() {}
+};
+
+struct LockGuard {
+    explicit LockGuard(Mutex&) {}
+};
+
+using RecursiveMutex = Mutex;
+using RecursiveLockGuard = LockGuard;
+#endif
+
+constexpr uint32_t thread_stack_size() {
+#ifdef AGFS_THREADS
+    return AGFS_THREAD_STACK_SIZE;
+#else
+    return 0;
+#endif
+}
+
+} // namespace internal
+} // namespace agfs
+
+#endif // AGFS_SYNC_H
@@ -6,7 +6,11 @@
 #include <map>
 #include <optional>
 #include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <charconv>
 #include <stdexcept>
+#include <type_traits>
 
 namespace agfs {
 
@@ -168,6 +172,43 @@ public:
     }
 };
 
+// Non-owning view over a contiguous range of T (the SDK targets C++17, so
+// this stands in for std::span)
+template<typename T>
+class Span {
+private:
+    T* data_;
+    size_t size_;
+
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+    Span(std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<const U(*)[], T(*)[]>::value>::type>
+    Span(const std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+    Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t i) const { return data_[i]; }
+
+    // Sub-view starting at offset, clamped to the end of this view
+    Span subspan(size_t offset, size_t count = SIZE_MAX) const {
+        if (offset > size_) offset = size_;
+        size_t remaining = size_ - offset;
+        return Span(data_ + offset, count < remaining ? count : remaining);
+    }
+};
+
 // Metadata structure
 class MetaData {
 public:
@@ -224,7 +265,36 @@ public:
     }
 };
 
+// One page of a directory listing returned by FileSystem::readdir_page
+class DirPage {
+public:
+    std::vector<FileInfo> entries;
+    std::string next_cursor; // Opaque continuation token, empty when the listing is complete
+
+    bool has_more() const {
+        return !next_cursor.empty();
+    }
+};
+
+// One range of a vectored read (FileSystem::readv)
+// The plugin fills up to buf.size() bytes read at offset and stores how many
+// it read in count; a count short of buf.size() means end of file.
+struct ReadSegment {
+    int64_t offset = 0;
+    Span<uint8_t> buf;
+    int64_t count = 0;
+};
+
+// One range of a vectored write (FileSystem::writev)
+struct WriteSegment {
+    int64_t offset = 0;
+    Span<const uint8_t> data;
+};
+
 // Configuration class
+// Values keep the text of the JSON scalar they came from: strings as-is,
+// numbers as written ("64", "1.5e3") and booleans as "true"/"false".
+// For typed, pre-validated settings see ConfigSchema in agfs_config.h.
 class Config {
 public:
     std::map<std::string, std::string> values;
@@ -237,18 +307,31 @@ public:
         return nullptr;
     }
 
+    // Integral values, including ones written as 64.0 or 6.4e1
+    // Returns default_value if the key is missing or not an integer.
     int64_t get_i64(const char* key, int64_t default_value = 0) const {
         auto it = values.find(key);
-        if (it != values.end()) {
-            return std::stoll(it->second);
+        int64_t v = 0;
+        if (it != values.end() && parse_i64(it->second, v)) {
+            return v;
+        }
+        return default_value;
+    }
+
+    double get_f64(const char* key, double default_value = 0) const {
+        auto it = values.find(key);
+        double v = 0;
+        if (it != values.end() && parse_f64(it->second, v)) {
+            return v;
         }
         return default_value;
     }
 
     bool get_bool(const char* key, bool default_value = false) const {
         auto it = values.find(key);
-        if (it != values.end()) {
-            return it->second == "true" || it->second == "1";
+        bool v = false;
+        if (it != values.end() && parse_bool(it->second, v)) {
+            return v;
         }
         return default_value;
     }
@@ -256,6 +339,50 @@ public:
     bool contains(const char* key) const {
         return values.find(key) != values.end();
     }
+
+    static bool parse_f64(const std::string& s, double& out) {
+        if (s.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        double v = std::strtod(s.c_str(), &end);
+        if (end != s.c_str() + s.size() || v != v) {
+            return false;
+        }
+        out = v;
+        return true;
+    }
+
+    static bool parse_i64(const std::string& s, int64_t& out) {
+        if (s.empty()) {
+            return false;
+        }
+        int64_t v = 0;
+        auto res = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (res.ec == std::errc() && res.ptr == s.data() + s.size()) {
+            out = v;
+            return true;
+        }
+        // 2^63 bounds the doubles that convert to int64_t without overflow
+        double d = 0;
+        if (!parse_f64(s, d) || d < -9223372036854775808.0 || d >= 9223372036854775808.0 ||
+            d != (double)(int64_t)d) {
+            return false;
+        }
+        out = (int64_t)d;
+        return true;
+    }
+
+    static bool parse_bool(const std::string& s, bool& out) {
+        if (s == "true" || s == "1") {
+            out = true;
+        } else if (s == "false" || s == "0") {
+            out = false;
+        } else {
+            return false;
+        }
+        return true;
+    }
 };
 
 /// Write flags for file operations (matches Go filesystem.WriteFlag)
@@ -302,6 +429,64 @@ inline const WriteFlag WriteFlag::EXCLUSIVE = WriteFlag(1 << 2);
 inline const WriteFlag WriteFlag::TRUNCATE = WriteFlag(1 << 3);
 inline const WriteFlag WriteFlag::SYNC = WriteFlag(1 << 4);
 
+/// Open flags for file handle operations (matches Go filesystem.OpenFlag)
+class OpenFlag {
+public:
+    uint32_t value;
+
+    OpenFlag() : value(0) {}
+    explicit OpenFlag(uint32_t v) : value(v) {}
+
+    /// Open for reading only
+    static const OpenFlag RDONLY;
+    /// Open for writing only
+    static const OpenFlag WRONLY;
+    /// Open for reading and writing
+    static const OpenFlag RDWR;
+    /// Append mode - writes go to the end of the file
+    static const OpenFlag APPEND;
+    /// Create file if it doesn't exist
+    static const OpenFlag CREATE;
+    /// Fail if file already exists (used with CREATE)
+    static const OpenFlag EXCL;
+    /// Truncate file to zero length
+    static const OpenFlag TRUNC;
+
+    /// Check if a flag is set
+    bool contains(OpenFlag flag) const {
+        return (value & flag.value) != 0;
+    }
+
+    /// Get the access mode (RDONLY, WRONLY or RDWR)
+    OpenFlag access_mode() const {
+        return OpenFlag(value & 3);
+    }
+
+    /// Check if readable
+    bool is_readable() const {
+        uint32_t mode = value & 3;
+        return mode == 0 || mode == 2;
+    }
+
+    /// Check if writable
+    bool is_writable() const {
+        uint32_t mode = value & 3;
+        return mode == 1 || mode == 2;
+    }
+
+    OpenFlag operator|(OpenFlag other) const {
+        return OpenFlag(value | other.value);
+    }
+};
+
+inline const OpenFlag OpenFlag::RDONLY = OpenFlag(0);
+inline const OpenFlag OpenFlag::WRONLY = OpenFlag(1);
+inline const OpenFlag OpenFlag::RDWR = OpenFlag(2);
+inline const OpenFlag OpenFlag::APPEND = OpenFlag(1 << 3);
+inline const OpenFlag OpenFlag::CREATE = OpenFlag(1 << 4);
+inline const OpenFlag OpenFlag::EXCL = OpenFlag(1 << 5);
+inline const OpenFlag OpenFlag::TRUNC = OpenFlag(1 << 6);
+
 } // namespace agfs
 
 #endif // AGFS_TYPES_H
@@ -0,0 +1,591 @@
+#ifndef AGFS_WRITEBACK_H
+#define AGFS_WRITEBACK_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_filesystem_v2.h"
+#include "agfs_handlefs.h"
+#include "agfs_metacache.h"
+#include "agfs_state.h"
+#include "agfs_sync.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+// WriteBackBuffer collects small writes per path and hands them to a sink as
+// one coalesced write
+// Only paths below an enabled prefix are buffered. A path's buffer holds
+// either appends (APPEND or offset -1) or one run of back-to-back positional
+// writes; a write that does not continue it has to be preceded by a flush.
+// Flushes go through a sink callable
+//
+//   Result<int64_t> sink(const std::string& path, const std::vector<uint8_t>& data,
+//                        int64_t offset, WriteFlag flags)
+//
+// which receives offset -1 with APPEND for append buffers. There are no
+// timers in a WASM module, so max_age is checked by flush_due() whenever the
+// plugin is called. The buffer itself is not synchronized; WriteBackBuffered
+// locks around it.
+class WriteBackBuffer {
+public:
+    static constexpr size_t DEFAULT_MAX_SIZE = 64 * 1024;      // per path
+    static constexpr int64_t DEFAULT_MAX_AGE_MS = 1000;
+    static constexpr size_t DEFAULT_BUDGET = 1024 * 1024;      // all paths
+
+    explicit WriteBackBuffer(size_t max_size = DEFAULT_MAX_SIZE, int64_t max_age_ms = DEFAULT_MAX_AGE_MS,
+                             size_t budget = DEFAULT_BUDGET)
+        : max_size_(max_size), max_age_ms_(max_age_ms), budget_(budget) {}
+
+    // Apply write_back_paths (comma-separated path prefixes, "/" for all),
+    // write_back_size (bytes per path), write_back_max_age_ms and
+    // write_back_budget (bytes over all paths) from config
+    // Call it before anything is buffered.
+    void configure(const Config& config) {
+        int64_t max_size = config.get_i64("write_back_size", (int64_t)max_size_);
+        int64_t budget = config.get_i64("write_back_budget", (int64_t)budget_);
+        max_age_ms_ = config.get_i64("write_back_max_age_ms", max_age_ms_);
+        max_size_ = max_size > 0 ? (size_t)max_size : 0;
+        budget_ = budget > 0 ? (size_t)budget : 0;
+        prefixes_.clear();
+        if (const char* paths = config.get_str("write_back_paths")) {
+            std::string_view list(paths);
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                std::string_view item = list.substr(0, comma);
+                while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+                while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+                if (!item.empty()) {
+                    enable(item);
+                }
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        }
+    }
+
+    // Buffer writes to prefix and everything below it
+    void enable(std::string_view prefix) {
+        while (prefix.size() > 1 && prefix.back() == '/') {
+            prefix.remove_suffix(1);
+        }
+        prefixes_.emplace_back(prefix);
+    }
+
+    bool enabled(std::string_view path) const {
+        if (max_size_ == 0) {
+            return false;
+        }
+        for (const auto& prefix : prefixes_) {
+            if (is_below(path, prefix)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether a write with these flags may be deferred
+    static bool bufferable(WriteFlag flags) {
+        return !flags.contains(WriteFlag::TRUNCATE) && !flags.contains(WriteFlag::EXCLUSIVE);
+    }
+
+    // Add a write to path's buffer
+    // Returns false, taking nothing, when the write does not continue what
+    // is buffered; flush the path and try again.
+    bool append(std::string_view path, Span<const uint8_t> data, int64_t offset, WriteFlag flags) {
+        bool appending = flags.contains(WriteFlag::APPEND) || offset < 0;
+        uint32_t keep = flags.value & WriteFlag::CREATE.value;
+        auto it = pending_.find(path);
+        if (it == pending_.end()) {
+            Pending p;
+            p.offset = appending ? -1 : offset;
+            p.since_ms = now_ms();
+            it = pending_.emplace(std::string(path), std::move(p)).first;
+        } else {
+            Pending& p = it->second;
+            bool continues = appending ? p.offset < 0
+                                       : p.offset >= 0 && offset == p.offset + (int64_t)p.data.size();
+            if (!continues) {
+                return false;
+            }
+        }
+        Pending& p = it->second;
+        p.flags |= keep;
+        p.data.insert(p.data.end(), data.begin(), data.end());
+        total_ += data.size();
+        return true;
+    }
+
+    bool has(std::string_view path) const {
+        return pending_.find(path) != pending_.end();
+    }
+
+    // File size as seen with path's buffer applied on top of base_size
+    int64_t size_with_pending(std::string_view path, int64_t base_size) const {
+        auto it = pending_.find(path);
+        if (it == pending_.end()) {
+            return base_size;
+        }
+        const Pending& p = it->second;
+        if (p.offset < 0) {
+            return base_size + (int64_t)p.data.size();
+        }
+        int64_t end = p.offset + (int64_t)p.data.size();
+        return end > base_size ? end : base_size;
+    }
+
+    // Whether path's buffer reached write_back_size
+    bool full(std::string_view path) const {
+        auto it = pending_.find(path);
+        return it != pending_.end() && it->second.data.size() >= max_size_;
+    }
+
+    // Error left by a background flush of path, cleared once returned
+    Result<void> take_error(std::string_view path) {
+        auto it = errors_.find(path);
+        if (it == errors_.end()) {
+            return Result<void>();
+        }
+        Error e = std::move(it->second);
+        errors_.erase(it);
+        return e;
+    }
+
+    // Write out path's buffer, adding extra flags (e.g. SYNC)
+    // An error left by a background flush is returned first; data buffered
+    // since then stays for the next flush.
+    template<typename Sink>
+    Result<void> flush(std::string_view path, Sink&& sink, WriteFlag extra = WriteFlag::NONE) {
+        auto failed = take_error(path);
+        if (failed.is_err()) {
+            return failed;
+        }
+        auto it = pending_.find(path);
+        if (it == pending_.end()) {
+            return Result<void>();
+        }
+        return write_out(it, sink, extra);
+    }
+
+    // Write out every buffer of path or a path below it
+    // Returns: The first error; the remaining buffers are still written.
+    template<typename Sink>
+    Result<void> flush_below(std::string_view dir, Sink&& sink) {
+        Result<void> first;
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            auto next = std::next(it);
+            if (is_below(it->first, dir)) {
+                auto result = write_out(it, sink, WriteFlag::NONE);
+                if (result.is_err() && first.is_ok()) {
+                    first = result;
+                }
+            }
+            it = next;
+        }
+        return first;
+    }
+
+    template<typename Sink>
+    Result<void> flush_all(Sink&& sink) {
+        return flush_below("/", sink);
+    }
+
+    // Write out buffers older than write_back_max_age_ms, or everything
+    // once write_back_budget is exceeded
+    // Errors are kept and reported by the next flush() of their path.
+    template<typename Sink>
+    void flush_due(Sink&& sink) {
+        if (pending_.empty()) {
+            return;
+        }
+        bool over_budget = total_ > budget_;
+        int64_t now = now_ms();
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            auto next = std::next(it);
+            if (over_budget || now - it->second.since_ms >= max_age_ms_) {
+                std::string path = it->first;
+                auto result = write_out(it, sink, WriteFlag::NONE);
+                if (result.is_err()) {
+                    errors_.insert_or_assign(path, result.unwrap_err());
+                }
+            }
+            it = next;
+        }
+    }
+
+    // Drop the buffers and errors of path and everything below it without
+    // writing them (the files are being removed)
+    void discard(std::string_view path) {
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            if (is_below(it->first, path)) {
+                total_ -= it->second.data.size();
+                it = pending_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto it = errors_.begin(); it != errors_.end();) {
+            it = is_below(it->first, path) ? errors_.erase(it) : std::next(it);
+        }
+    }
+
+    void clear() {
+        pending_.clear();
+        errors_.clear();
+        total_ = 0;
+    }
+
+    bool empty() const { return pending_.empty(); }
+    size_t pending_bytes() const { return total_; }
+    size_t max_size() const { return max_size_; }
+    int64_t max_age_ms() const { return max_age_ms_; }
+    uint64_t flushes() const { return flushes_; }
+
+private:
+    struct Pending {
+        int64_t offset = -1; // -1: appends
+        uint32_t flags = 0;
+        int64_t since_ms = 0;
+        std::vector<uint8_t> data;
+    };
+
+    using Map = std::map<std::string, Pending, std::less<>>;
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool is_below(std::string_view path, std::string_view dir) {
+        if (dir == "/") {
+            return true;
+        }
+        return path.size() >= dir.size() && path.compare(0, dir.size(), dir) == 0 &&
+               (path.size() == dir.size() || path[dir.size()] == '/');
+    }
+
+    // The buffer is dropped whether or not the sink succeeds, so a failed
+    // flush is reported once instead of being retried into a partial write
+    template<typename Sink>
+    Result<void> write_out(Map::iterator it, Sink& sink, WriteFlag extra) {
+        Pending p = std::move(it->second);
+        std::string path = it->first;
+        total_ -= p.data.size();
+        pending_.erase(it);
+        flushes_++;
+
+        WriteFlag flags(p.flags | extra.value);
+        auto result = p.offset < 0 ? sink(path, p.data, (int64_t)-1, flags | WriteFlag::APPEND)
+                                   : sink(path, p.data, p.offset, flags);
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        if (result.unwrap() < (int64_t)p.data.size()) {
+            return Error::io("short write-back flush: " + std::to_string(result.unwrap()) + " of " +
+                             std::to_string(p.data.size()) + " bytes");
+        }
+        return Result<void>();
+    }
+
+    size_t max_size_;
+    int64_t max_age_ms_;
+    size_t budget_;
+    std::vector<std::string> prefixes_;
+    Map pending_;
+    std::map<std::string, Error, std::less<>> errors_;
+    size_t total_ = 0;
+    uint64_t flushes_ = 0;
+};
+
+// WriteBackBuffered puts a WriteBackBuffer in front of a plugin's write():
+//
+//   AGFS_EXPORT_PLUGIN(agfs::WriteBackBuffered<MyProxyFS>);
+//
+// Writes to enabled paths return once they are buffered. A buffer is
+// flushed as one write to the plugin when it reaches write_back_size, when
+// a write carries SYNC, before any other operation on its path, on
+// handle_sync/handle_close and in shutdown(). An error from a deferred flush
+// is returned by the call that flushed the path, or by the next one after a
+// background (age or budget) flush. stat() includes buffered data.
+//
+// Buffers live in the plugin instance that took the write, and a read that
+// the pool sends to another instance would miss them. Unthreaded builds
+// with write_back_paths set therefore report single_instance(), and the host
+// only mounts them with an instance pool size of 1. Threaded builds
+// (AGFS_THREADS) share one plugin between all workers and have no limit.
+template<typename Base>
+class WriteBackBuffered : public Base {
+    using Path = typename internal::FsArgTypes<Base>::Path;
+    using Data = typename internal::FsArgTypes<Base>::Data;
+
+public:
+    using Base::Base;
+
+    // Unsynchronized access, e.g. to read counters or add prefixes before serving
+    WriteBackBuffer& write_back() { return buffer_; }
+
+    // Write out path's buffer now
+    Result<void> flush(std::string_view path, WriteFlag extra = WriteFlag::NONE) {
+        internal::RecursiveLockGuard lock(mu_);
+        return buffer_.flush(path, sink(), extra);
+    }
+
+    Result<void> flush_all() {
+        internal::RecursiveLockGuard lock(mu_);
+        return buffer_.flush_all(sink());
+    }
+
+    bool single_instance(const Config& config) const override {
+#ifdef AGFS_THREADS
+        return Base::single_instance(config);
+#else
+        const char* paths = config.get_str("write_back_paths");
+        return (paths && *paths) || Base::single_instance(config);
+#endif
+    }
+
+    Result<void> initialize(const Config& config) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.clear();
+            buffer_.configure(config);
+            config_ = config;
+        }
+        return Base::initialize(config);
+    }
+
+    // The write-back config travels ahead of Base's snapshot
+    Result<std::vector<uint8_t>> export_state() override {
+        Config config;
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            config = config_;
+        }
+        return internal::prepend_config_state(Base::export_state(), config);
+    }
+
+    Result<void> import_state(Span<const uint8_t> state) override {
+        StateReader r(state);
+        Config config = r.config();
+        if (!r.ok()) {
+            return Error::invalid_input("corrupt write-back state");
+        }
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.clear();
+            buffer_.configure(config);
+            config_ = std::move(config);
+        }
+        return Base::import_state(r.remaining());
+    }
+
+    Result<void> shutdown() override {
+        Result<void> flushed = flush_all();
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.clear();
+        }
+        Result<void> result = Base::shutdown();
+        return flushed.is_err() ? flushed : result;
+    }
+
+    Result<int64_t> write(Path path, Data data, int64_t offset, WriteFlag flags) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.flush_due(sink());
+            auto failed = buffer_.take_error(path);
+            if (failed.is_err()) {
+                return failed.unwrap_err();
+            }
+            if (buffer_.enabled(path) && WriteBackBuffer::bufferable(flags)) {
+                return buffered_write(path, data, offset, flags);
+            }
+            auto flushed = buffer_.flush(path, sink());
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        return Base::write(path, data, offset, flags);
+    }
+
+    Result<int64_t> writev(Path path, Span<const WriteSegment> segments, WriteFlag flags) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        return Base::writev(path, segments, flags);
+    }
+
+    Result<std::vector<uint8_t>> read(Path path, int64_t offset, int64_t size) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        return Base::read(path, offset, size);
+    }
+
+    Result<int64_t> read_into(Path path, int64_t offset, Span<uint8_t> buf) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        return Base::read_into(path, offset, buf);
+    }
+
+    Result<void> readv(Path path, Span<ReadSegment> segments) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Base::readv(path, segments);
+    }
+
+    // Buffered data only grows the file, so it is added to the base size
+    // instead of being flushed
+    Result<FileInfo> stat(Path path) override {
+        bool pending;
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.flush_due(sink());
+            pending = buffer_.has(path);
+        }
+        if (pending) {
+            auto result = Base::stat(path);
+            if (result.is_ok() && !result.unwrap().is_dir) {
+                FileInfo info = std::move(result.unwrap());
+                internal::RecursiveLockGuard lock(mu_);
+                info.size = buffer_.size_with_pending(path, info.size);
+                return info;
+            }
+            auto flushed = flush(path); // e.g. the buffer creates the file
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        return Base::stat(path);
+    }
+
+    Result<std::vector<FileInfo>> readdir(Path path) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.flush_due(sink());
+            auto flushed = buffer_.flush_below(path, sink());
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        return Base::readdir(path);
+    }
+
+    Result<void> create(Path path) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Base::create(path);
+    }
+
+    Result<void> remove(Path path) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.discard(path);
+        }
+        return Base::remove(path);
+    }
+
+    Result<void> remove_all(Path path) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            buffer_.discard(path);
+        }
+        return Base::remove_all(path);
+    }
+
+    Result<void> rename(Path old_path, Path new_path) override {
+        {
+            internal::RecursiveLockGuard lock(mu_);
+            auto flushed = buffer_.flush_below(old_path, sink());
+            if (flushed.is_err()) {
+                return flushed;
+            }
+            flushed = buffer_.flush_below(new_path, sink());
+            if (flushed.is_err()) {
+                return flushed;
+            }
+        }
+        return Base::rename(old_path, new_path);
+    }
+
+    Result<void> chmod(Path path, uint32_t mode) override {
+        auto flushed = before(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Base::chmod(path, mode);
+    }
+
+    // Shadow the HandleFileSystem entry points the export macros call,
+    // flushing the handle's path first (only instantiated for handle plugins)
+    Result<void> handle_sync(int64_t id) {
+        if (auto h = Base::acquire_handle(id)) {
+            auto flushed = flush(h->path(), WriteFlag::SYNC);
+            if (flushed.is_err()) {
+                return flushed;
+            }
+        }
+        return Base::handle_sync(id);
+    }
+
+    Result<void> handle_close(int64_t id) {
+        Result<void> flushed;
+        if (auto h = Base::acquire_handle(id)) {
+            flushed = flush(h->path());
+        }
+        Result<void> result = Base::handle_close(id);
+        return flushed.is_err() ? flushed : result;
+    }
+
+private:
+    // Called with mu_ held
+    Result<int64_t> buffered_write(Path path, Data data, int64_t offset, WriteFlag flags) {
+        Span<const uint8_t> bytes(data.data(), data.size());
+        if (!buffer_.append(path, bytes, offset, flags)) {
+            auto flushed = buffer_.flush(path, sink());
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+            buffer_.append(path, bytes, offset, flags);
+        }
+        if (flags.contains(WriteFlag::SYNC) || buffer_.full(path)) {
+            auto flushed = buffer_.flush(path, sink(), flags.contains(WriteFlag::SYNC) ? WriteFlag::SYNC : WriteFlag::NONE);
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        return (int64_t)data.size();
+    }
+
+    auto sink() {
+        return [this](const std::string& path, const std::vector<uint8_t>& data, int64_t offset, WriteFlag flags) {
+            return Base::write(path, data, offset, flags);
+        };
+    }
+
+    // Age out other buffers, then flush path's own
+    Result<void> before(std::string_view path) {
+        internal::RecursiveLockGuard lock(mu_);
+        buffer_.flush_due(sink());
+        return buffer_.flush(path, sink());
+    }
+
+    WriteBackBuffer buffer_;
+    Config config_; // for export_state()
+    internal::RecursiveMutex mu_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_WRITEBACK_H
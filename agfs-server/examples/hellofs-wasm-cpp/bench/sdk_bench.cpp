@@ -0,0 +1,526 @@
+// Microbenchmarks for SDK hot paths
+//
+// Built natively (make bench-native) it prints results to stdout. Built as
+// a WASM plugin (make bench-wasm) it exports bench_run, which
+// cmd/wasmbench calls through the server's WASM loader.
+//
+// Each result is one JSON object per line:
+//   {"name":..., "env":"native"|"wasm", "iterations":N, "ns_per_op":...,
+//    "ops_per_sec":..., "allocs_per_op":..., "alloc_bytes_per_op":...,
+//    "bytes_per_op":...}
+// allocs_per_op counts operator new calls; bytes_per_op is the payload
+// each op produces or copies (0 when an op should not copy at all).
+
+#include "agfs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Allocation counters fed by the global operator new below
+static uint64_t g_alloc_count = 0;
+static uint64_t g_alloc_bytes = 0;
+
+// Every replaceable form is defined, in matched pairs, so no allocation
+// bypasses the counters. The bodies stay out of line: once inlined, GCC pairs
+// free() with the operator new at the call site and warns
+// (-Wmismatched-new-delete).
+#define BENCH_ALLOC_FN __attribute__((noinline))
+
+BENCH_ALLOC_FN static void* bench_alloc(size_t size, size_t align) {
+    g_alloc_count++;
+    g_alloc_bytes += size;
+    void* p = nullptr;
+    if (align <= alignof(std::max_align_t)) {
+        p = std::malloc(size ? size : 1);
+    } else if (posix_memalign(&p, align, size ? size : 1) != 0) {
+        p = nullptr;
+    }
+    return p;
+}
+
+BENCH_ALLOC_FN static void bench_free(void* p) {
+    std::free(p);
+}
+
+BENCH_ALLOC_FN void* operator new(size_t size) {
+    void* p = bench_alloc(size, 0);
+    if (!p) std::abort();
+    return p;
+}
+BENCH_ALLOC_FN void* operator new[](size_t size) { return operator new(size); }
+BENCH_ALLOC_FN void* operator new(size_t size, const std::nothrow_t&) noexcept { return bench_alloc(size, 0); }
+BENCH_ALLOC_FN void* operator new[](size_t size, const std::nothrow_t&) noexcept { return bench_alloc(size, 0); }
+BENCH_ALLOC_FN void* operator new(size_t size, std::align_val_t align) {
+    void* p = bench_alloc(size, (size_t)align);
+    if (!p) std::abort();
+    return p;
+}
+BENCH_ALLOC_FN void* operator new[](size_t size, std::align_val_t align) { return operator new(size, align); }
+
+BENCH_ALLOC_FN void operator delete(void* p) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete[](void* p) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete(void* p, size_t) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete[](void* p, size_t) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete(void* p, const std::nothrow_t&) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete[](void* p, const std::nothrow_t&) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete(void* p, std::align_val_t) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete[](void* p, std::align_val_t) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete(void* p, size_t, std::align_val_t) noexcept { bench_free(p); }
+BENCH_ALLOC_FN void operator delete[](void* p, size_t, std::align_val_t) noexcept { bench_free(p); }
+
+namespace {
+
+#ifdef __wasm__
+constexpr const char* BENCH_ENV = "wasm";
+#else
+constexpr const char* BENCH_ENV = "native";
+#endif
+
+// Keeps results observable so the optimizer cannot drop the measured work
+volatile uint64_t g_sink = 0;
+
+// Per-benchmark context: the body runs iterations() ops and reports the
+// payload size of one op
+class BenchState {
+public:
+    explicit BenchState(uint64_t iterations) : iterations_(iterations) {}
+
+    uint64_t iterations() const { return iterations_; }
+    void set_bytes_per_op(uint64_t n) { bytes_per_op_ = n; }
+    uint64_t bytes_per_op() const { return bytes_per_op_; }
+
+private:
+    uint64_t iterations_;
+    uint64_t bytes_per_op_ = 0;
+};
+
+using BenchFn = void (*)(BenchState&);
+
+struct Benchmark {
+    const char* name;
+    BenchFn fn;
+};
+
+// ---------------------------------------------------------------------------
+// Fixtures
+
+std::vector<agfs::FileInfo> make_entries(size_t n) {
+    std::vector<agfs::FileInfo> entries;
+    entries.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        entries.push_back(agfs::FileInfo::file("entry-" + std::to_string(i) + ".txt", 4096 + i, 0644));
+    }
+    return entries;
+}
+
+std::string make_base64(size_t raw_len) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((raw_len + 2) / 3 * 4);
+    for (size_t i = 0; i < raw_len / 3 * 4; i++) {
+        out.push_back(alphabet[(i * 7) % 64]);
+    }
+    return out;
+}
+
+constexpr const char* CONFIG_JSON =
+    "{\"host_prefix\":\"/data/backend\",\"metadata_cache_size\":4096,"
+    "\"metadata_cache_ttl_ms\":2000,\"block_cache_size\":8388608,"
+    "\"block_cache_readahead\":4,\"read_only\":false,"
+    "\"endpoint\":\"https://storage.example.com/bucket\",\"region\":\"us-east-1\"}";
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+
+void bench_serialize_fileinfo_array(BenchState& state) {
+    auto entries = make_entries(100);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::string json = agfs::ffi::JsonParser::serialize_fileinfo_array(entries);
+        g_sink += json.size();
+        state.set_bytes_per_op(json.size());
+    }
+}
+
+void bench_encode_fileinfo_binary(BenchState& state) {
+    auto entries = make_entries(100);
+    size_t len = agfs::ffi::BinaryCodec::encoded_size(entries.data(), entries.size());
+    std::vector<uint8_t> buf(len);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        agfs::ffi::BinaryCodec::encode(entries.data(), entries.size(), buf.data());
+        g_sink += buf[len - 1];
+    }
+    state.set_bytes_per_op(len);
+}
+
+void bench_parse_config(BenchState& state) {
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        agfs::Config config = agfs::ffi::JsonParser::parse_config(CONFIG_JSON);
+        g_sink += config.values.size();
+    }
+    state.set_bytes_per_op(std::strlen(CONFIG_JSON));
+}
+
+void bench_http_request_to_json(BenchState& state) {
+    agfs::HttpRequest req = agfs::HttpRequest::post("https://api.example.com/v1/objects/key");
+    req.add_header("Content-Type", "application/octet-stream");
+    req.add_header("Authorization", "Bearer 0123456789abcdef");
+    req.body.assign(4096, 0x5a);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::string json = req.to_json();
+        g_sink += json.size();
+        state.set_bytes_per_op(json.size());
+    }
+}
+
+void bench_http_request_encode_header(BenchState& state) {
+    agfs::HttpRequest req = agfs::HttpRequest::post("https://api.example.com/v1/objects/key");
+    req.add_header("Content-Type", "application/octet-stream");
+    req.add_header("Authorization", "Bearer 0123456789abcdef");
+    req.body.assign(4096, 0x5a);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::vector<uint8_t> header = req.encode_header();
+        g_sink += header.size();
+        state.set_bytes_per_op(header.size());
+    }
+}
+
+void bench_base64_decode_64k(BenchState& state) {
+    std::string input = make_base64(64 * 1024);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::vector<uint8_t> out = agfs::HttpResponse::base64_decode(input);
+        g_sink += out.size();
+    }
+    state.set_bytes_per_op(input.size());
+}
+
+void bench_base64_encode_64k(BenchState& state) {
+    std::vector<uint8_t> data(64 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (uint8_t)(i * 31);
+    }
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::string out = agfs::Base64::encode(data);
+        g_sink += out.size();
+    }
+    state.set_bytes_per_op(data.size());
+}
+
+// Mostly plain text with an occasional quote, like typical header values
+void bench_json_escape_4k(BenchState& state) {
+    std::string input;
+    for (size_t i = 0; i < 4096; i++) {
+        input.push_back(i % 97 == 0 ? '"' : (char)('a' + i % 26));
+    }
+    std::string out;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        out.clear();
+        agfs::JsonWriter::append_escaped(out, input);
+        g_sink += out.size();
+    }
+    state.set_bytes_per_op(input.size());
+}
+
+// Text-like data: runs of words, so both chunking and LZ find structure
+std::vector<uint8_t> make_text(size_t n) {
+    static const char* words[] = {"agent ", "artifact ", "step ", "result ", "0x1f2e ", "ok\n", "tool_call ", "{\"id\": "};
+    std::vector<uint8_t> out;
+    out.reserve(n);
+    uint32_t x = 12345;
+    while (out.size() < n) {
+        x = x * 1103515245 + 12345;
+        const char* w = words[(x >> 16) % 8];
+        for (; *w && out.size() < n; w++) {
+            out.push_back((uint8_t)*w);
+        }
+    }
+    return out;
+}
+
+void bench_chunker_cut_1m(BenchState& state) {
+    std::vector<uint8_t> data = make_text(1024 * 1024);
+    agfs::ContentChunker chunker;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        size_t pos = 0;
+        while (pos < data.size()) {
+            pos += chunker.cut(agfs::Span<const uint8_t>(data.data() + pos, data.size() - pos), true);
+        }
+        g_sink += pos;
+    }
+    state.set_bytes_per_op(data.size());
+}
+
+void bench_lz_compress_64k(BenchState& state) {
+    std::vector<uint8_t> data = make_text(64 * 1024);
+    agfs::LzCodec codec;
+    std::vector<uint8_t> out;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        out.clear();
+        g_sink += codec.compress(data, out);
+    }
+    state.set_bytes_per_op(data.size());
+}
+
+void bench_lz_decompress_64k(BenchState& state) {
+    std::vector<uint8_t> data = make_text(64 * 1024);
+    agfs::LzCodec codec;
+    std::vector<uint8_t> packed;
+    codec.compress(data, packed);
+    std::vector<uint8_t> out(data.size());
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        g_sink += agfs::LzCodec::decompress(packed, agfs::Span<uint8_t>(out)).is_ok();
+    }
+    state.set_bytes_per_op(data.size());
+}
+
+void bench_sha256_64k(BenchState& state) {
+    std::vector<uint8_t> data = make_text(64 * 1024);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        g_sink += agfs::Sha256::hash(data)[0];
+    }
+    state.set_bytes_per_op(data.size());
+}
+
+// Longest-prefix lookup among 256 mounts of /tenants/<t>/<area>
+void bench_router_match_256(BenchState& state) {
+    static const char* areas[] = {"data", "logs", "cache", "tmp"};
+    agfs::PathRouter<int> router;
+    std::vector<std::string> paths;
+    for (int t = 0; t < 64; t++) {
+        for (int a = 0; a < 4; a++) {
+            std::string prefix = "/tenants/t" + std::to_string(t) + "/" + areas[a];
+            router.add(prefix, t * 4 + a);
+            paths.push_back(prefix + "/2024/06/file-" + std::to_string(t) + ".log");
+        }
+    }
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto m = router.match(paths[i % paths.size()]);
+        g_sink += *m.handler + m.rest.size();
+    }
+}
+
+agfs::Result<std::vector<uint8_t>> result_source(size_t n) {
+    return std::vector<uint8_t>(n, 1);
+}
+
+agfs::Result<std::vector<uint8_t>> result_forward(size_t n) {
+    auto result = result_source(n);
+    if (result.is_err()) {
+        return result.unwrap_err();
+    }
+    return result;
+}
+
+// One allocation per op means the buffer moved through every return
+void bench_result_move_vector(BenchState& state) {
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto result = result_forward(64 * 1024);
+        g_sink += result.unwrap().size();
+    }
+    state.set_bytes_per_op(0);
+}
+
+agfs::Result<agfs::FileInfo> stat_source(const std::string& name) {
+    return agfs::FileInfo::file(name, 1234, 0644);
+}
+
+void bench_result_fileinfo(BenchState& state) {
+    std::string name = "a-reasonably-long-file-name-beyond-sso.txt";
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto result = stat_source(name);
+        g_sink += result.unwrap().size;
+    }
+}
+
+// Plugin served through the real export wrappers below
+class BenchFS : public agfs::FileSystemV2 {
+public:
+    BenchFS() : data_(256 * 1024, 0x42) {} // small enough for the 2MB initial memory
+
+    const char* name() const override { return "benchfs"; }
+
+    agfs::Result<int64_t> read_into(std::string_view, int64_t offset, agfs::Span<uint8_t> buf) override {
+        if (offset < 0 || (size_t)offset >= data_.size()) {
+            return (int64_t)0;
+        }
+        size_t n = std::min(buf.size(), data_.size() - (size_t)offset);
+        std::memcpy(buf.data(), data_.data() + offset, n);
+        return (int64_t)n;
+    }
+
+    agfs::Result<int64_t> write(std::string_view, agfs::Span<const uint8_t> data, int64_t offset, agfs::WriteFlag) override {
+        if (offset < 0) offset = 0;
+        size_t end = std::min(data_.size(), (size_t)offset + data.size());
+        if ((size_t)offset < end) {
+            std::memcpy(data_.data() + offset, data.data(), end - (size_t)offset);
+        }
+        return (int64_t)data.size();
+    }
+
+    agfs::Result<agfs::FileInfo> stat(std::string_view path) override {
+        return agfs::FileInfo::file(std::string(path), data_.size(), 0644);
+    }
+
+    agfs::Result<std::vector<agfs::FileInfo>> readdir(std::string_view) override {
+        return std::vector<agfs::FileInfo>{agfs::FileInfo::file("data", data_.size(), 0644)};
+    }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+} // namespace
+
+AGFS_EXPORT_PLUGIN(BenchFS);
+
+namespace {
+
+void ensure_plugin() {
+    if (!g_plugin_instance) {
+        plugin_new();
+        get_output_buffer_ptr(); // reads up to the buffer size skip malloc, as under the host
+    }
+}
+
+template<size_t Size>
+void bench_fs_read_export(BenchState& state) {
+    ensure_plugin();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        uint64_t packed = fs_read("/data", (int64_t)((i * Size) % (128 * 1024)), (int64_t)Size);
+        g_sink += packed >> 32;
+    }
+    state.set_bytes_per_op(Size);
+}
+
+template<size_t Size>
+void bench_fs_write_export(BenchState& state) {
+    ensure_plugin();
+    std::vector<uint8_t> data(Size, 0x17);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        uint64_t packed = fs_write("/data", data.data(), data.size(), (int64_t)((i * Size) % (128 * 1024)), 0);
+        g_sink += packed >> 32;
+    }
+    state.set_bytes_per_op(Size);
+}
+
+const Benchmark BENCHMARKS[] = {
+    {"json/serialize_fileinfo_array/100", bench_serialize_fileinfo_array},
+    {"binary/encode_fileinfo/100", bench_encode_fileinfo_binary},
+    {"json/parse_config", bench_parse_config},
+    {"http/request_to_json/4KB", bench_http_request_to_json},
+    {"http/request_encode_header", bench_http_request_encode_header},
+    {"http/base64_decode/64KB", bench_base64_decode_64k},
+    {"base64/encode/64KB", bench_base64_encode_64k},
+    {"json/escape_string/4KB", bench_json_escape_4k},
+    {"chunkstore/chunk/1MB", bench_chunker_cut_1m},
+    {"chunkstore/lz_compress/64KB", bench_lz_compress_64k},
+    {"chunkstore/lz_decompress/64KB", bench_lz_decompress_64k},
+    {"chunkstore/sha256/64KB", bench_sha256_64k},
+    {"router/match/256", bench_router_match_256},
+    {"result/move_vector/64KB", bench_result_move_vector},
+    {"result/fileinfo", bench_result_fileinfo},
+    {"export/fs_read/4KB", bench_fs_read_export<4096>},
+    {"export/fs_read/64KB", bench_fs_read_export<65536>},
+    {"export/fs_write/4KB", bench_fs_write_export<4096>},
+    {"export/fs_write/64KB", bench_fs_write_export<65536>},
+};
+
+uint64_t now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Grow the iteration count until one run lasts min_time_ms, then report it
+void run_one(const Benchmark& bench, uint64_t min_time_ms, std::string& out) {
+    uint64_t min_ns = min_time_ms * 1000000ull;
+    uint64_t iterations = 1;
+    for (;;) {
+        BenchState state(iterations);
+        uint64_t allocs = g_alloc_count;
+        uint64_t alloc_bytes = g_alloc_bytes;
+        uint64_t start = now_ns();
+        bench.fn(state);
+        uint64_t elapsed = now_ns() - start;
+        allocs = g_alloc_count - allocs;
+        alloc_bytes = g_alloc_bytes - alloc_bytes;
+
+        if (elapsed >= min_ns || iterations >= (1ull << 40)) {
+            double ns_per_op = (double)elapsed / (double)iterations;
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "{\"name\":\"%s\",\"env\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.2f,"
+                          "\"ops_per_sec\":%.0f,\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.0f,"
+                          "\"bytes_per_op\":%llu}\n",
+                          bench.name, BENCH_ENV, (unsigned long long)iterations, ns_per_op,
+                          ns_per_op > 0 ? 1e9 / ns_per_op : 0.0,
+                          (double)allocs / (double)iterations, (double)alloc_bytes / (double)iterations,
+                          (unsigned long long)state.bytes_per_op());
+            out += line;
+            return;
+        }
+
+        // Aim 20% past the target from the last run's rate, at most 100x growth
+        uint64_t next = elapsed > 0 ? (uint64_t)((double)iterations * 1.2 * (double)min_ns / (double)elapsed)
+                                    : iterations * 100;
+        if (next > iterations * 100) next = iterations * 100;
+        iterations = next > iterations ? next : iterations + 1;
+    }
+}
+
+// Run every benchmark whose name contains filter (all when empty)
+std::string run_benchmarks(const std::string& filter, uint64_t min_time_ms) {
+    std::string out;
+    for (const Benchmark& bench : BENCHMARKS) {
+        if (filter.empty() || std::string(bench.name).find(filter) != std::string::npos) {
+            run_one(bench, min_time_ms, out);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+extern "C" {
+
+// Returns packed u64: low 32 bits = JSON lines ptr, high 32 bits = length
+// A null ptr with a non-zero length means the report could not be allocated.
+__attribute__((export_name("bench_run")))
+uint64_t bench_run(const char* filter, uint32_t min_time_ms) {
+    std::string out = run_benchmarks(agfs::ffi::read_string(filter), min_time_ms ? min_time_ms : 200);
+    if (out.empty()) {
+        return 0;
+    }
+    uint8_t* buf = (uint8_t*)agfs::ffi::wasm_malloc(out.size());
+    if (!buf) {
+        return agfs::ffi::pack_u64(0, (uint32_t)out.size());
+    }
+    std::memcpy(buf, out.data(), out.size());
+    return agfs::ffi::pack_u64(agfs::ffi::ptr_u32(buf), (uint32_t)out.size());
+}
+
+} // extern "C"
+
+#ifndef __wasm__
+int main(int argc, char** argv) {
+    std::string filter;
+    uint64_t min_time_ms = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--min-time-ms=", 0) == 0) {
+            min_time_ms = std::strtoull(arg.c_str() + 14, nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=SUBSTRING] [--min-time-ms=N]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::string out = run_benchmarks(filter, min_time_ms);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return 0;
+}
+#endif
@@ -6,14 +6,17 @@
 
 #include "../agfs-cpp-sdk/agfs.h"
 
-class HelloFS : public agfs::FileSystem {
-private:
+struct HelloSettings {
     std::string host_prefix;
+};
+
+class HelloFS : public agfs::FileSystem, public agfs::Configurable<HelloSettings> {
+private:
 
     // Convert /host/xxx to actual host path, or return empty if not host path
     std::string get_host_path(const std::string& path) const {
-        if (path.rfind("/host/", 0) == 0 && !host_prefix.empty()) {
-            return host_prefix + path.substr(5);  // Remove "/host", add prefix
+        if (path.rfind("/host/", 0) == 0 && !settings().host_prefix.empty()) {
+            return settings().host_prefix + path.substr(5);  // Remove "/host", add prefix
         }
         return "";
     }
@@ -29,13 +32,13 @@ public:
                " - /host/* - Proxies to host filesystem (if configured host_prefix)";
     }
 
-    agfs::Result<void> initialize(const agfs::Config& config) override {
-        // Get optional host_prefix from config
-        const char* prefix = config.get_str("host_prefix");
-        if (prefix != nullptr) {
-            host_prefix = prefix;
-        }
-        return agfs::Result<void>();
+    // Parsed into settings() before initialize(); also exported as
+    // plugin_get_config_params
+    static agfs::ConfigSchema<HelloSettings> config_schema() {
+        static constexpr agfs::ConfigField<HelloSettings> fields[] = {
+            {"host_prefix", &HelloSettings::host_prefix, "Host directory exposed under /host"},
+        };
+        return fields;
     }
 
     agfs::Result<std::vector<uint8_t>> read(const std::string& path,
@@ -52,6 +55,25 @@ public:
         return agfs::Error::not_found();
     }
 
+    // Serve /hello.txt without allocating; everything else goes through read()
+    agfs::Result<int64_t> read_into(const std::string& path, int64_t offset,
+                                    agfs::Span<uint8_t> buf) override {
+        if (path == "/hello.txt") {
+            static const char content[] = "Hello World from C++\n";
+            int64_t len = sizeof(content) - 1;
+            if (offset < 0 || offset >= len) {
+                return static_cast<int64_t>(0);
+            }
+            int64_t n = len - offset;
+            if (n > static_cast<int64_t>(buf.size())) {
+                n = static_cast<int64_t>(buf.size());
+            }
+            std::memcpy(buf.data(), content + offset, n);
+            return n;
+        }
+        return agfs::FileSystem::read_into(path, offset, buf);
+    }
+
     agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
         if (path == "/") {
             return agfs::FileInfo::dir("", 0755);
@@ -59,7 +81,7 @@ public:
         if (path == "/hello.txt") {
             return agfs::FileInfo::file("hello.txt", 21, 0644);
         }
-        if (path == "/host" && !host_prefix.empty()) {
+        if (path == "/host" && !settings().host_prefix.empty()) {
             return agfs::FileInfo::dir("host", 0755);
         }
         auto host_path = get_host_path(path);
@@ -73,13 +95,13 @@ public:
         if (path == "/") {
             std::vector<agfs::FileInfo> entries;
             entries.push_back(agfs::FileInfo::file("hello.txt", 21, 0644));
-            if (!host_prefix.empty()) {
+            if (!settings().host_prefix.empty()) {
                 entries.push_back(agfs::FileInfo::dir("host", 0755));
             }
             return entries;
         }
-        if (path == "/host" && !host_prefix.empty()) {
-            return agfs::HostFS::readdir(host_prefix);
+        if (path == "/host" && !settings().host_prefix.empty()) {
+            return agfs::HostFS::readdir(settings().host_prefix);
         }
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
@@ -92,14 +114,9 @@ public:
                                 const std::vector<uint8_t>& data,
                                 int64_t offset,
                                 agfs::WriteFlag flags) override {
-        (void)offset; (void)flags; // HostFS doesn't support offset/flags yet
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            auto result = agfs::HostFS::write(host_path, data);
-            if (result.is_ok()) {
-                return static_cast<int64_t>(data.size());
-            }
-            return result.unwrap_err();
+            return agfs::HostFS::write_at(host_path, data, offset, flags);
         }
         return agfs::Error::permission_denied();
     }
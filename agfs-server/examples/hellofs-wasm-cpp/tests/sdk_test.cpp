@@ -0,0 +1,229 @@
+// Native checks for SDK behaviour that spans several plugin instances or
+// layers (make test-native)
+//
+// Each test prints nothing on success; a failed CHECK reports its line and
+// the run exits non-zero after all tests.
+
+#include "agfs.h"
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                      \
+            return;                                                            \
+        }                                                                      \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// Fixtures
+
+// Files and directories of an in-memory backend, shared by every MemFS
+// created while it is current
+struct MemStore {
+    std::map<std::string, std::vector<uint8_t>> files;
+    std::set<std::string> dirs{"/"};
+};
+
+std::shared_ptr<MemStore> g_store = std::make_shared<MemStore>();
+
+std::string parent_of(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+class MemFS : public agfs::FileSystem {
+public:
+    const char* name() const override { return "mem"; }
+
+    agfs::Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) override {
+        auto it = store_->files.find(path);
+        if (it == store_->files.end()) {
+            return agfs::Error::not_found();
+        }
+        const auto& data = it->second;
+        if (offset >= (int64_t)data.size()) {
+            return std::vector<uint8_t>();
+        }
+        size_t avail = data.size() - (size_t)offset;
+        size_t n = size < 0 || (size_t)size > avail ? avail : (size_t)size;
+        return std::vector<uint8_t>(data.begin() + offset, data.begin() + offset + n);
+    }
+
+    agfs::Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data, int64_t offset,
+                                agfs::WriteFlag flags) override {
+        auto& file = store_->files[path];
+        if (flags.contains(agfs::WriteFlag::TRUNCATE)) {
+            file.clear();
+        }
+        if (offset < 0 || flags.contains(agfs::WriteFlag::APPEND)) {
+            offset = (int64_t)file.size();
+        }
+        if (file.size() < (size_t)offset + data.size()) {
+            file.resize((size_t)offset + data.size());
+        }
+        std::copy(data.begin(), data.end(), file.begin() + offset);
+        return (int64_t)data.size();
+    }
+
+    agfs::Result<void> mkdir(const std::string& path, uint32_t) override {
+        store_->dirs.insert(path);
+        return agfs::Result<void>();
+    }
+
+    agfs::Result<void> remove(const std::string& path) override {
+        if (store_->files.erase(path) == 0 && store_->dirs.erase(path) == 0) {
+            return agfs::Error::not_found();
+        }
+        return agfs::Result<void>();
+    }
+
+    agfs::Result<void> rename(const std::string& old_path, const std::string& new_path) override {
+        auto it = store_->files.find(old_path);
+        if (it == store_->files.end()) {
+            return agfs::Error::not_found();
+        }
+        store_->files[new_path] = std::move(it->second);
+        store_->files.erase(old_path);
+        return agfs::Result<void>();
+    }
+
+    agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
+        auto it = store_->files.find(path);
+        if (it != store_->files.end()) {
+            return agfs::FileInfo::file(path.substr(path.rfind('/') + 1), (int64_t)it->second.size(), 0644);
+        }
+        if (store_->dirs.count(path)) {
+            return agfs::FileInfo::dir(path.substr(path.rfind('/') + 1), 0755);
+        }
+        return agfs::Error::not_found();
+    }
+
+    agfs::Result<std::vector<agfs::FileInfo>> readdir(const std::string& path) override {
+        if (!store_->dirs.count(path)) {
+            return agfs::Error::not_found();
+        }
+        std::vector<agfs::FileInfo> entries;
+        for (const auto& dir : store_->dirs) {
+            if (dir != "/" && parent_of(dir) == path) {
+                entries.push_back(agfs::FileInfo::dir(dir.substr(dir.rfind('/') + 1), 0755));
+            }
+        }
+        for (const auto& file : store_->files) {
+            if (parent_of(file.first) == path) {
+                entries.push_back(agfs::FileInfo::file(file.first.substr(file.first.rfind('/') + 1),
+                                                       (int64_t)file.second.size(), 0644));
+            }
+        }
+        return entries;
+    }
+
+private:
+    std::shared_ptr<MemStore> store_ = g_store;
+};
+
+std::vector<uint8_t> pattern_bytes(size_t n, uint32_t seed) {
+    std::vector<uint8_t> out(n);
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        out[i] = (uint8_t)(seed >> 16);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+
+// Instance A collects chunks instance B still believes are stored; B must
+// store them again instead of writing a manifest that points at nothing
+void test_chunkstore_gc_across_instances() {
+    g_store = std::make_shared<MemStore>();
+    agfs::Config config;
+    agfs::ChunkedStoreFS<MemFS> a;
+    agfs::ChunkedStoreFS<MemFS> b;
+    CHECK(a.initialize(config).is_ok());
+    CHECK(b.initialize(config).is_ok());
+
+    // B learns the chunks first, along with a full-size zero chunk
+    std::vector<uint8_t> data = pattern_bytes(200000, 7);
+    CHECK(b.write("/seed", data, 0, agfs::WriteFlag::CREATE).is_ok());
+    CHECK(b.write("/sparse", data, 8 << 20, agfs::WriteFlag::CREATE).is_ok());
+    CHECK(b.remove("/seed").is_ok());
+    CHECK(b.remove("/sparse").is_ok());
+
+    CHECK(a.write("/f", data, 0, agfs::WriteFlag::CREATE).is_ok());
+    CHECK(a.remove("/f").is_ok());
+    auto collected = a.collect_garbage();
+    CHECK(collected.is_ok() && collected.unwrap() > 0);
+
+    CHECK(b.write("/g", data, 0, agfs::WriteFlag::CREATE).is_ok());
+    CHECK(b.write("/h", std::vector<uint8_t>{1}, 8 << 20, agfs::WriteFlag::CREATE).is_ok());
+    auto g = b.read("/g", 0, -1);
+    CHECK(g.is_ok() && g.unwrap() == data);
+    auto h = a.read("/h", 0, -1);
+    CHECK(h.is_ok() && h.unwrap().size() == (8 << 20) + 1 && h.unwrap()[0] == 0 && h.unwrap().back() == 1);
+}
+
+// Mounts whose readdir_page is their own go straight to it, mount root included
+class PagedFS : public MemFS {
+public:
+    int pages = 0;
+
+    agfs::Result<agfs::DirPage> readdir_page(const std::string& path, const std::string& cursor,
+                                             size_t max_entries) override {
+        pages++;
+        return agfs::FileSystem::readdir_page(path, cursor, max_entries);
+    }
+};
+
+void test_router_pages_at_mount_root() {
+    g_store = std::make_shared<MemStore>();
+    PagedFS data;
+    CHECK(data.write("/a", std::vector<uint8_t>{1}, 0, agfs::WriteFlag::CREATE).is_ok());
+    CHECK(data.write("/b", std::vector<uint8_t>{2}, 0, agfs::WriteFlag::CREATE).is_ok());
+    PagedFS other;
+    agfs::RoutedFS routed;
+    routed.mount("/data", data);
+    routed.mount("/nested/inner", other);
+
+    auto page = routed.readdir_page("/data", "", 1);
+    CHECK(page.is_ok() && page.unwrap().entries.size() == 1 && page.unwrap().has_more());
+    CHECK(data.pages == 1);
+
+    // With a mount below it, the listing is merged instead
+    routed.mount("/data/sub", other);
+    auto merged = routed.readdir_page("/data", "", 10);
+    CHECK(merged.is_ok() && merged.unwrap().entries.size() == 3);
+    CHECK(data.pages == 1);
+}
+
+struct Test {
+    const char* name;
+    void (*fn)();
+};
+
+const Test TESTS[] = {
+    {"chunkstore/gc_across_instances", test_chunkstore_gc_across_instances},
+    {"router/pages_at_mount_root", test_router_pages_at_mount_root},
+};
+
+} // namespace
+
+int main() {
+    for (const auto& test : TESTS) {
+        int before = g_failures;
+        test.fn();
+        std::printf("%s %s\n", g_failures == before ? "ok  " : "FAIL", test.name);
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -56,6 +56,41 @@ type Syncer interface {
 	Sync(path string) error
 }
 
+// ReadRange is one range of a vectored read
+type ReadRange struct {
+	Offset int64
+	Size   int64
+}
+
+// WriteSegment is one range of a vectored write
+type WriteSegment struct {
+	Offset int64
+	Data   []byte
+}
+
+// VectorIO is implemented by file systems that can serve several ranges of
+// one file per call, e.g. WASM plugins exporting fs_readv/fs_writev
+// This lets callers that split large I/O into chunks (FUSE) pay the per-call
+// cost once per batch instead of once per chunk.
+type VectorIO interface {
+	// ReadV reads every range; a result shorter than its range hit end of file
+	ReadV(path string, ranges []ReadRange) ([][]byte, error)
+
+	// WriteV writes the segments in order and returns the total bytes written
+	// TRUNCATE in flags applies before the first segment only.
+	WriteV(path string, segments []WriteSegment, flags WriteFlag) (int64, error)
+}
+
+// Copier is implemented by file systems that can copy data between two of
+// their own paths without returning it to the caller (see CopyRange)
+type Copier interface {
+	// CopyRange copies length bytes (-1 = to end of file) of src starting at
+	// srcOffset into dst at dstOffset and returns the bytes copied, which
+	// is short if src ends first. flags apply to opening dst; CREATE makes it
+	// if missing and TRUNCATE empties it first.
+	CopyRange(src string, srcOffset int64, dst string, dstOffset int64, length int64, flags WriteFlag) (int64, error)
+}
+
 // === Special Semantics Interfaces ===
 
 // AppendOnlyFS marks file systems where certain paths only support append operations
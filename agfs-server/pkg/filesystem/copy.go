@@ -0,0 +1,51 @@
+package filesystem
+
+// copyChunkSize bounds the memory CopyRangeByChunks holds at once
+const copyChunkSize = 1 << 20 // 1MB
+
+// CopyRange copies a range of src to dst within fs (see Copier.CopyRange)
+// It uses fs's own Copier when there is one and chunked Read/Write otherwise.
+func CopyRange(fs FileSystem, src string, srcOffset int64, dst string, dstOffset int64, length int64, flags WriteFlag) (int64, error) {
+	if copier, ok := fs.(Copier); ok {
+		return copier.CopyRange(src, srcOffset, dst, dstOffset, length, flags)
+	}
+	return CopyRangeByChunks(fs, src, srcOffset, dst, dstOffset, length, flags)
+}
+
+// CopyRangeByChunks implements Copier.CopyRange with Read/Write calls of at
+// most copyChunkSize bytes
+// TRUNCATE and EXCLUSIVE in flags only apply to the first write.
+func CopyRangeByChunks(fs FileSystem, src string, srcOffset int64, dst string, dstOffset int64, length int64, flags WriteFlag) (int64, error) {
+	if srcOffset < 0 || dstOffset < 0 {
+		return 0, NewInvalidArgumentError("offset", srcOffset, "copy offsets must not be negative")
+	}
+
+	var copied int64
+	for length < 0 || copied < length {
+		n := int64(copyChunkSize)
+		if length >= 0 && length-copied < n {
+			n = length - copied
+		}
+
+		data, eof, err := ReadUpTo(fs, src, srcOffset+copied, n)
+		if err != nil {
+			return copied, err
+		}
+		if len(data) == 0 && copied > 0 {
+			break
+		}
+
+		// An empty first chunk still opens dst, so CREATE/TRUNCATE take effect
+		written, err := fs.Write(dst, data, dstOffset+copied, flags)
+		if err != nil {
+			return copied, err
+		}
+		copied += written
+		flags &^= WriteFlagTruncate | WriteFlagExclusive
+
+		if eof || written < int64(len(data)) || int64(len(data)) < n {
+			break
+		}
+	}
+	return copied, nil
+}
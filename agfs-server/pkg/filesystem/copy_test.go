@@ -0,0 +1,72 @@
+package filesystem_test
+
+import (
+	"bytes"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugins/memfs"
+)
+
+func TestCopyRangeByChunks(t *testing.T) {
+	fs := memfs.NewMemoryFS()
+	src := bytes.Repeat([]byte("0123456789"), 250000) // 2.5 chunks
+	if _, err := fs.Write("/src", src, 0, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("write src: %v", err)
+	}
+
+	// Whole file into a new file
+	n, err := filesystem.CopyRangeByChunks(fs, "/src", 0, "/dst", 0, -1, filesystem.WriteFlagCreate|filesystem.WriteFlagTruncate)
+	if err != nil || n != int64(len(src)) {
+		t.Fatalf("copy: n=%d err=%v", n, err)
+	}
+	got, _ := fs.Read("/dst", 0, -1)
+	if !bytes.Equal(got, src) {
+		t.Fatalf("dst differs from src (%d vs %d bytes)", len(got), len(src))
+	}
+
+	// A range into the middle of an existing file
+	n, err = filesystem.CopyRangeByChunks(fs, "/src", 3, "/dst", 10, 4, filesystem.WriteFlagNone)
+	if err != nil || n != 4 {
+		t.Fatalf("range copy: n=%d err=%v", n, err)
+	}
+	got, _ = fs.Read("/dst", 8, 8)
+	if string(got) != "89345645" {
+		t.Errorf("unexpected range content %q", got)
+	}
+}
+
+func TestCopyRangeByChunksShortSource(t *testing.T) {
+	fs := memfs.NewMemoryFS()
+	fs.Write("/src", []byte("abc"), 0, filesystem.WriteFlagCreate)
+	fs.Write("/dst", []byte("xxxxxxxx"), 0, filesystem.WriteFlagCreate)
+
+	// Copying past the end of src is short and TRUNCATE still applies
+	n, err := filesystem.CopyRangeByChunks(fs, "/src", 1, "/dst", 0, 100, filesystem.WriteFlagTruncate)
+	if err != nil || n != 2 {
+		t.Fatalf("copy: n=%d err=%v", n, err)
+	}
+	got, _ := fs.Read("/dst", 0, -1)
+	if string(got) != "bc" {
+		t.Errorf("unexpected dst %q", got)
+	}
+
+	// An empty source still creates dst
+	fs.Write("/empty", nil, 0, filesystem.WriteFlagCreate)
+	if _, err := filesystem.CopyRangeByChunks(fs, "/empty", 0, "/new", 0, -1, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("empty copy: %v", err)
+	}
+	if _, err := fs.Stat("/new"); err != nil {
+		t.Errorf("dst not created: %v", err)
+	}
+}
+
+func TestCopyRangeByChunksErrors(t *testing.T) {
+	fs := memfs.NewMemoryFS()
+	if _, err := filesystem.CopyRangeByChunks(fs, "/missing", 0, "/dst", 0, -1, filesystem.WriteFlagCreate); err == nil {
+		t.Error("expected error for missing source")
+	}
+	if _, err := filesystem.CopyRangeByChunks(fs, "/src", -1, "/dst", 0, -1, filesystem.WriteFlagCreate); err == nil {
+		t.Error("expected error for negative offset")
+	}
+}
@@ -0,0 +1,110 @@
+package filesystem
+
+import (
+	"errors"
+	"io"
+)
+
+// ReadInto fills buf from path at offset and returns the bytes read, which is
+// short if the file ends first
+// HandleFS file systems read straight into buf through a read-only handle;
+// others, and handle file systems that do not support it, go through Read
+// in chunks of at most copyChunkSize bytes.
+func ReadInto(fs FileSystem, path string, offset int64, buf []byte) (int, error) {
+	if offset < 0 {
+		return 0, NewInvalidArgumentError("offset", offset, "read offset must not be negative")
+	}
+	if handleFS, ok := fs.(HandleFS); ok {
+		handle, err := handleFS.OpenHandle(path, O_RDONLY, 0)
+		if err == nil {
+			defer handle.Close()
+			return readFullAt(handle, buf, offset)
+		}
+		if !errors.Is(err, ErrNotSupported) {
+			return 0, err
+		}
+	}
+	return ReadIntoByChunks(fs, path, offset, buf)
+}
+
+// ReadUpTo reads up to size bytes of path at offset through fs.Read
+// File systems return io.EOF along with the data read so far when a read
+// reaches the end of the file. ReadUpTo returns that data with a nil error
+// instead, and reports eof so callers reading in chunks know to stop.
+func ReadUpTo(fs FileSystem, path string, offset, size int64) (data []byte, eof bool, err error) {
+	data, err = fs.Read(path, offset, size)
+	if errors.Is(err, io.EOF) {
+		return data, true, nil
+	}
+	if err != nil {
+		return nil, false, err
+	}
+	return data, false, nil
+}
+
+// ReadIntoByChunks implements ReadInto with Read calls
+// VectorIO file systems get every chunk in a single ReadV call.
+func ReadIntoByChunks(fs FileSystem, path string, offset int64, buf []byte) (int, error) {
+	if vio, ok := fs.(VectorIO); ok && len(buf) > copyChunkSize {
+		return readIntoVectored(vio, path, offset, buf)
+	}
+	n := 0
+	for n < len(buf) {
+		size := len(buf) - n
+		if size > copyChunkSize {
+			size = copyChunkSize
+		}
+
+		data, eof, err := ReadUpTo(fs, path, offset+int64(n), int64(size))
+		if err != nil {
+			return n, err
+		}
+		n += copy(buf[n:], data)
+		if eof || len(data) < size {
+			break
+		}
+	}
+	return n, nil
+}
+
+func readIntoVectored(vio VectorIO, path string, offset int64, buf []byte) (int, error) {
+	ranges := make([]ReadRange, 0, (len(buf)+copyChunkSize-1)/copyChunkSize)
+	for start := 0; start < len(buf); start += copyChunkSize {
+		size := len(buf) - start
+		if size > copyChunkSize {
+			size = copyChunkSize
+		}
+		ranges = append(ranges, ReadRange{Offset: offset + int64(start), Size: int64(size)})
+	}
+
+	results, err := vio.ReadV(path, ranges)
+	if err != nil {
+		return 0, err
+	}
+	n := 0
+	for i, data := range results {
+		if i >= len(ranges) {
+			break
+		}
+		n += copy(buf[n:], data)
+		if int64(len(data)) < ranges[i].Size {
+			break // end of file
+		}
+	}
+	return n, nil
+}
+
+func readFullAt(handle FileHandle, buf []byte, offset int64) (int, error) {
+	n := 0
+	for n < len(buf) {
+		read, err := handle.ReadAt(buf[n:], offset+int64(n))
+		n += read
+		if errors.Is(err, io.EOF) || (err == nil && read == 0) {
+			break
+		}
+		if err != nil {
+			return n, err
+		}
+	}
+	return n, nil
+}
@@ -0,0 +1,125 @@
+package filesystem_test
+
+import (
+	"bytes"
+	"io"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugins/memfs"
+)
+
+// readOnlyFS hides the handle support of the file system it wraps
+type readOnlyFS struct{ filesystem.FileSystem }
+
+func TestReadInto(t *testing.T) {
+	mfs := memfs.NewMemoryFS()
+	data := bytes.Repeat([]byte("0123456789"), 250000) // 2.5 chunks
+	if _, err := mfs.Write("/src", data, 0, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("write src: %v", err)
+	}
+
+	for name, fs := range map[string]filesystem.FileSystem{"handles": mfs, "chunks": readOnlyFS{mfs}} {
+		buf := make([]byte, len(data))
+		n, err := filesystem.ReadInto(fs, "/src", 0, buf)
+		if err != nil || n != len(data) || !bytes.Equal(buf, data) {
+			t.Fatalf("%s: whole file: n=%d err=%v", name, n, err)
+		}
+
+		// Past the end of the file the read is short
+		buf = make([]byte, 16)
+		n, err = filesystem.ReadInto(fs, "/src", int64(len(data)-4), buf)
+		if err != nil || n != 4 || string(buf[:n]) != "6789" {
+			t.Errorf("%s: tail: n=%d err=%v %q", name, n, err, buf[:n])
+		}
+		n, err = filesystem.ReadInto(fs, "/src", int64(len(data)+10), buf)
+		if err != nil || n != 0 {
+			t.Errorf("%s: past end: n=%d err=%v", name, n, err)
+		}
+
+		if _, err := filesystem.ReadInto(fs, "/missing", 0, buf); err == nil {
+			t.Errorf("%s: expected error for missing file", name)
+		}
+		if _, err := filesystem.ReadInto(fs, "/src", -1, buf); err == nil {
+			t.Errorf("%s: expected error for negative offset", name)
+		}
+	}
+}
+
+// vectorFS serves ReadV by looping over Read and counts the calls
+type vectorFS struct {
+	readOnlyFS
+	calls int
+}
+
+func (v *vectorFS) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	v.calls++
+	return filesystem.ReadV(v.readOnlyFS, path, ranges)
+}
+
+func (v *vectorFS) WriteV(path string, segments []filesystem.WriteSegment, flags filesystem.WriteFlag) (int64, error) {
+	v.calls++
+	return filesystem.WriteV(v.readOnlyFS, path, segments, flags)
+}
+
+func TestReadIntoVectored(t *testing.T) {
+	mfs := memfs.NewMemoryFS()
+	data := bytes.Repeat([]byte("0123456789"), 250000) // 2.5 chunks
+	if _, err := mfs.Write("/src", data, 0, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("write src: %v", err)
+	}
+	fs := &vectorFS{readOnlyFS: readOnlyFS{mfs}}
+
+	buf := make([]byte, len(data)+100)
+	n, err := filesystem.ReadInto(fs, "/src", 0, buf)
+	if err != nil || n != len(data) || !bytes.Equal(buf[:n], data) {
+		t.Fatalf("whole file: n=%d err=%v", n, err)
+	}
+	if fs.calls != 1 {
+		t.Fatalf("ReadV calls = %d, want 1", fs.calls)
+	}
+
+	segments := []filesystem.WriteSegment{{Offset: 0, Data: []byte("ab")}, {Offset: 4, Data: []byte("cd")}}
+	if n, err := fs.WriteV("/dst", segments, filesystem.WriteFlagCreate); err != nil || n != 4 {
+		t.Fatalf("WriteV: n=%d err=%v", n, err)
+	}
+	got, _ := mfs.Read("/dst", 0, -1)
+	if string(got[:2]) != "ab" || string(got[4:6]) != "cd" {
+		t.Fatalf("WriteV wrote %q", got)
+	}
+}
+
+// eofFS returns io.EOF with the data of every read that reaches the end of the file
+type eofFS struct{ filesystem.FileSystem }
+
+func (e eofFS) Read(path string, offset, size int64) ([]byte, error) {
+	data, err := e.FileSystem.Read(path, offset, size)
+	if err == nil && int64(len(data)) < size {
+		err = io.EOF
+	}
+	return data, err
+}
+
+func TestReadUpTo(t *testing.T) {
+	mfs := memfs.NewMemoryFS()
+	if _, err := mfs.Write("/src", []byte("0123456789"), 0, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("write src: %v", err)
+	}
+	fs := eofFS{mfs}
+
+	data, eof, err := filesystem.ReadUpTo(fs, "/src", 2, 4)
+	if err != nil || eof || string(data) != "2345" {
+		t.Fatalf("middle: %q eof=%v err=%v", data, eof, err)
+	}
+	data, eof, err = filesystem.ReadUpTo(fs, "/src", 6, 10)
+	if err != nil || !eof || string(data) != "6789" {
+		t.Fatalf("tail: %q eof=%v err=%v", data, eof, err)
+	}
+	data, eof, err = filesystem.ReadUpTo(fs, "/src", 20, 4)
+	if err != nil || !eof || len(data) != 0 {
+		t.Fatalf("past end: %q eof=%v err=%v", data, eof, err)
+	}
+	if _, _, err := filesystem.ReadUpTo(fs, "/missing", 0, 4); err == nil {
+		t.Fatalf("expected an error for a missing file")
+	}
+}
@@ -0,0 +1,40 @@
+package filesystem
+
+// ReadV reads several ranges of path (see VectorIO.ReadV)
+// It uses fs's own VectorIO when there is one and one Read per range otherwise.
+func ReadV(fs FileSystem, path string, ranges []ReadRange) ([][]byte, error) {
+	if vio, ok := fs.(VectorIO); ok {
+		return vio.ReadV(path, ranges)
+	}
+	out := make([][]byte, len(ranges))
+	for i, r := range ranges {
+		data, _, err := ReadUpTo(fs, path, r.Offset, r.Size)
+		if err != nil {
+			return nil, err
+		}
+		out[i] = data
+	}
+	return out, nil
+}
+
+// WriteV writes several ranges of path (see VectorIO.WriteV)
+// It uses fs's own VectorIO when there is one and one Write per segment
+// otherwise, stopping after a short write.
+func WriteV(fs FileSystem, path string, segments []WriteSegment, flags WriteFlag) (int64, error) {
+	if vio, ok := fs.(VectorIO); ok {
+		return vio.WriteV(path, segments, flags)
+	}
+	var total int64
+	for _, seg := range segments {
+		n, err := fs.Write(path, seg.Data, seg.Offset, flags)
+		if err != nil {
+			return total, err
+		}
+		total += n
+		if n < int64(len(seg.Data)) {
+			break
+		}
+		flags &^= WriteFlagTruncate
+	}
+	return total, nil
+}
@@ -15,6 +15,7 @@ import (
 	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
 	"github.com/c4pt0r/agfs/agfs-server/pkg/mountablefs"
 	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/api"
 	log "github.com/sirupsen/logrus"
 )
 
@@ -56,6 +57,68 @@ func (ph *PluginHandler) ListMounts(w http.ResponseWriter, r *http.Request) {
 	writeJSON(w, http.StatusOK, ListMountsResponse{Mounts: mountInfos})
 }
 
+// metricsReporter is implemented by plugins that report per-operation
+// metrics (WASM plugins built with AGFS_ENABLE_METRICS)
+type metricsReporter interface {
+	PluginMetrics() *api.PluginMetrics
+}
+
+// OpMetricsInfo is one operation's counters with latency estimates
+type OpMetricsInfo struct {
+	*api.OpMetrics
+	MeanNanos int64 `json:"mean_ns"`
+	P50Nanos  int64 `json:"p50_ns"`
+	P90Nanos  int64 `json:"p90_ns"`
+	P99Nanos  int64 `json:"p99_ns"`
+}
+
+// MountMetrics represents the metrics reported by one mounted plugin
+type MountMetrics struct {
+	Path       string                   `json:"path"`
+	PluginName string                   `json:"pluginName"`
+	Ops        map[string]OpMetricsInfo `json:"ops"`
+}
+
+// ListMountMetricsResponse represents the response for listing mount metrics
+type ListMountMetricsResponse struct {
+	Mounts []MountMetrics `json:"mounts"`
+}
+
+// ListMountMetrics handles GET /mounts/metrics
+// Counters are cumulative since the plugin was mounted.
+func (ph *PluginHandler) ListMountMetrics(w http.ResponseWriter, r *http.Request) {
+	mounts := ph.mfs.GetMounts()
+
+	result := []MountMetrics{}
+	for _, mount := range mounts {
+		reporter, ok := mount.Plugin.(metricsReporter)
+		if !ok {
+			continue
+		}
+		m := reporter.PluginMetrics()
+		if m == nil {
+			continue
+		}
+		info := MountMetrics{
+			Path:       mount.Path,
+			PluginName: mount.Plugin.Name(),
+			Ops:        make(map[string]OpMetricsInfo, len(m.Ops)),
+		}
+		for name, op := range m.Ops {
+			info.Ops[name] = OpMetricsInfo{
+				OpMetrics: op,
+				MeanNanos: int64(op.Mean()),
+				P50Nanos:  int64(op.Quantile(0.50)),
+				P90Nanos:  int64(op.Quantile(0.90)),
+				P99Nanos:  int64(op.Quantile(0.99)),
+			}
+		}
+		result = append(result, info)
+	}
+
+	writeJSON(w, http.StatusOK, ListMountMetricsResponse{Mounts: result})
+}
+
 // UnmountRequest represents an unmount request
 type UnmountRequest struct {
 	Path string `json:"path"`
@@ -434,6 +497,14 @@ func (ph *PluginHandler) SetupRoutes(mux *http.ServeMux) {
 		ph.ListMounts(w, r)
 	})
 
+	mux.HandleFunc("/api/v1/mounts/metrics", func(w http.ResponseWriter, r *http.Request) {
+		if r.Method != http.MethodGet {
+			writeError(w, http.StatusMethodNotAllowed, "method not allowed")
+			return
+		}
+		ph.ListMountMetrics(w, r)
+	})
+
 	mux.HandleFunc("/api/v1/mount", func(w http.ResponseWriter, r *http.Request) {
 		if r.Method != http.MethodPost {
 			writeError(w, http.StatusMethodNotAllowed, "method not allowed")
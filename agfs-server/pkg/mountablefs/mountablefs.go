@@ -563,6 +563,36 @@ func (mfs *MountableFS) Write(path string, data []byte, offset int64, flags file
 	return 0, filesystem.NewNotFoundError("write", path)
 }
 
+// ReadV implements filesystem.VectorIO interface
+func (mfs *MountableFS) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	resolved, err := mfs.resolvePath(path)
+	if err != nil {
+		return nil, err
+	}
+
+	mount, relPath, found := mfs.findMount(resolved)
+
+	if found {
+		return filesystem.ReadV(mount.Plugin.GetFileSystem(), relPath, ranges)
+	}
+	return nil, filesystem.NewNotFoundError("read", path)
+}
+
+// WriteV implements filesystem.VectorIO interface
+func (mfs *MountableFS) WriteV(path string, segments []filesystem.WriteSegment, flags filesystem.WriteFlag) (int64, error) {
+	resolved, err := mfs.resolvePath(path)
+	if err != nil {
+		return 0, err
+	}
+
+	mount, relPath, found := mfs.findMount(resolved)
+
+	if found {
+		return filesystem.WriteV(mount.Plugin.GetFileSystem(), relPath, segments, flags)
+	}
+	return 0, filesystem.NewNotFoundError("write", path)
+}
+
 func (mfs *MountableFS) ReadDir(path string) ([]filesystem.FileInfo, error) {
 	// Lock-free implementation
 	path = filesystem.NormalizePath(path)
@@ -921,6 +951,34 @@ func (mfs *MountableFS) Truncate(path string, size int64) error {
 	return fmt.Errorf("filesystem does not support truncate: %s", path)
 }
 
+// CopyRange implements filesystem.Copier interface
+// Copies within one mount are handed to that mount's file system; copies
+// between mounts move the data through the server in chunks.
+func (mfs *MountableFS) CopyRange(src string, srcOffset int64, dst string, dstOffset int64, length int64, flags filesystem.WriteFlag) (int64, error) {
+	resolvedSrc, err := mfs.resolvePath(src)
+	if err != nil {
+		return 0, err
+	}
+	resolvedDst, err := mfs.resolvePath(dst)
+	if err != nil {
+		return 0, err
+	}
+
+	srcMount, srcRelPath, found := mfs.findMount(resolvedSrc)
+	if !found {
+		return 0, filesystem.NewNotFoundError("copy", src)
+	}
+	dstMount, dstRelPath, found := mfs.findMount(resolvedDst)
+	if !found {
+		return 0, filesystem.NewNotFoundError("copy", dst)
+	}
+
+	if srcMount == dstMount {
+		return filesystem.CopyRange(srcMount.Plugin.GetFileSystem(), srcRelPath, srcOffset, dstRelPath, dstOffset, length, flags)
+	}
+	return filesystem.CopyRangeByChunks(mfs, resolvedSrc, srcOffset, resolvedDst, dstOffset, length, flags)
+}
+
 // Touch implements filesystem.Toucher interface
 func (mfs *MountableFS) Touch(path string) error {
 	mount, relPath, found := mfs.findMount(path)
@@ -1363,3 +1421,9 @@ var _ filesystem.FileHandle = (*globalFileHandle)(nil)
 
 // Ensure MountableFS implements Truncater interface
 var _ filesystem.Truncater = (*MountableFS)(nil)
+
+// Ensure MountableFS implements Copier interface
+var _ filesystem.Copier = (*MountableFS)(nil)
+
+// Ensure MountableFS implements VectorIO interface
+var _ filesystem.VectorIO = (*MountableFS)(nil)
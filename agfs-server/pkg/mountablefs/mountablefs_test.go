@@ -693,6 +693,46 @@ func TestSymlinkCrossMount(t *testing.T) {
 	}
 }
 
+func TestCopyRange(t *testing.T) {
+	mfs := NewMountableFS(api.PoolConfig{})
+
+	plugin1 := NewMockServicePlugin("plugin1")
+	plugin2 := NewMockServicePlugin("plugin2")
+	if err := mfs.Mount("/mnt1", plugin1); err != nil {
+		t.Fatalf("Failed to mount plugin1: %v", err)
+	}
+	if err := mfs.Mount("/mnt2", plugin2); err != nil {
+		t.Fatalf("Failed to mount plugin2: %v", err)
+	}
+	if _, err := plugin1.fs.Write("/file.txt", []byte("from plugin1"), 0, filesystem.WriteFlagCreate); err != nil {
+		t.Fatalf("Failed to create file in plugin1: %v", err)
+	}
+
+	// Within one mount
+	n, err := mfs.CopyRange("/mnt1/file.txt", 0, "/mnt1/copy.txt", 0, -1, filesystem.WriteFlagCreate)
+	if err != nil || n != 12 {
+		t.Fatalf("Same-mount copy failed: n=%d err=%v", n, err)
+	}
+	data, _ := plugin1.fs.Read("/copy.txt", 0, -1)
+	if string(data) != "from plugin1" {
+		t.Errorf("Expected 'from plugin1', got %s", string(data))
+	}
+
+	// Across mounts
+	n, err = mfs.CopyRange("/mnt1/file.txt", 0, "/mnt2/copy.txt", 0, -1, filesystem.WriteFlagCreate)
+	if err != nil || n != 12 {
+		t.Fatalf("Cross-mount copy failed: n=%d err=%v", n, err)
+	}
+	data, _ = plugin2.fs.Read("/copy.txt", 0, -1)
+	if string(data) != "from plugin1" {
+		t.Errorf("Expected 'from plugin1', got %s", string(data))
+	}
+
+	if _, err := mfs.CopyRange("/nowhere/file.txt", 0, "/mnt2/x", 0, -1, filesystem.WriteFlagCreate); err == nil {
+		t.Error("Expected error for unmounted source")
+	}
+}
+
 func TestSymlinkVisibility(t *testing.T) {
 	mfs := NewMountableFS(api.PoolConfig{})
 
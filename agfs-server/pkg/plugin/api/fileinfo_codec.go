@@ -0,0 +1,129 @@
+package api
+
+import (
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Compact binary FileInfo encoding returned by fs_stat_bin / fs_readdir_bin
+//
+// Layout (little-endian):
+//
+//	u32 total_len, u32 count, then count records of:
+//	u32 record_len, i64 size, u32 mode, i64 mod_time (unix seconds, 0 = unset),
+//	u8 flags (bit 0 = dir, bit 1 = meta), u32 name_len + name,
+//	[meta] u32 len + meta name, u32 len + meta type, u32 len + meta content (JSON)
+const (
+	fileInfoBinHeaderSize = 8
+	fileInfoBinFlagDir    = 1 << 0
+	fileInfoBinFlagMeta   = 1 << 1
+)
+
+// readFileInfoBinary copies an encoded FileInfo buffer out of WASM memory
+func readFileInfoBinary(module wazeroapi.Module, ptr uint32) ([]byte, bool) {
+	mem := module.Memory()
+	if mem == nil {
+		return nil, false
+	}
+	total, ok := mem.ReadUint32Le(ptr)
+	if !ok || total < fileInfoBinHeaderSize {
+		return nil, false
+	}
+	view, ok := mem.Read(ptr, total)
+	if !ok {
+		return nil, false
+	}
+	buf := make([]byte, len(view))
+	copy(buf, view)
+	return buf, true
+}
+
+// decodeFileInfoBinary decodes a buffer produced by the SDK's BinaryCodec
+func decodeFileInfoBinary(buf []byte) ([]filesystem.FileInfo, error) {
+	if len(buf) < fileInfoBinHeaderSize {
+		return nil, fmt.Errorf("fileinfo buffer too short: %d bytes", len(buf))
+	}
+	total := binary.LittleEndian.Uint32(buf[0:4])
+	count := binary.LittleEndian.Uint32(buf[4:8])
+	if int(total) > len(buf) {
+		return nil, fmt.Errorf("fileinfo buffer truncated: header says %d bytes, have %d", total, len(buf))
+	}
+	buf = buf[fileInfoBinHeaderSize:total]
+
+	infos := make([]filesystem.FileInfo, 0, count)
+	for i := uint32(0); i < count; i++ {
+		if len(buf) < 4 {
+			return nil, fmt.Errorf("fileinfo record %d: truncated length", i)
+		}
+		recLen := binary.LittleEndian.Uint32(buf[0:4])
+		if int(recLen) > len(buf)-4 {
+			return nil, fmt.Errorf("fileinfo record %d: truncated body", i)
+		}
+		info, err := decodeFileInfoRecord(buf[4 : 4+recLen])
+		if err != nil {
+			return nil, fmt.Errorf("fileinfo record %d: %w", i, err)
+		}
+		infos = append(infos, info)
+		buf = buf[4+recLen:]
+	}
+	return infos, nil
+}
+
+func decodeFileInfoRecord(rec []byte) (filesystem.FileInfo, error) {
+	var info filesystem.FileInfo
+	const fixed = 8 + 4 + 8 + 1
+	if len(rec) < fixed {
+		return info, fmt.Errorf("record too short")
+	}
+	info.Size = int64(binary.LittleEndian.Uint64(rec[0:8]))
+	info.Mode = binary.LittleEndian.Uint32(rec[8:12])
+	if modTime := int64(binary.LittleEndian.Uint64(rec[12:20])); modTime != 0 {
+		info.ModTime = time.Unix(modTime, 0)
+	}
+	flags := rec[20]
+	info.IsDir = flags&fileInfoBinFlagDir != 0
+	rest := rec[fixed:]
+
+	readStr := func() (string, error) {
+		if len(rest) < 4 {
+			return "", fmt.Errorf("truncated string length")
+		}
+		n := binary.LittleEndian.Uint32(rest[0:4])
+		if int(n) > len(rest)-4 {
+			return "", fmt.Errorf("truncated string")
+		}
+		s := string(rest[4 : 4+n])
+		rest = rest[4+n:]
+		return s, nil
+	}
+
+	var err error
+	if info.Name, err = readStr(); err != nil {
+		return info, err
+	}
+	if flags&fileInfoBinFlagMeta != 0 {
+		if info.Meta.Name, err = readStr(); err != nil {
+			return info, err
+		}
+		if info.Meta.Type, err = readStr(); err != nil {
+			return info, err
+		}
+		content, err := readStr()
+		if err != nil {
+			return info, err
+		}
+		if content != "" {
+			// Content that is not a string map is dropped instead of failing the listing
+			var m map[string]string
+			if json.Unmarshal([]byte(content), &m) == nil {
+				info.Meta.Content = m
+			}
+		}
+	}
+	return info, nil
+}
@@ -0,0 +1,97 @@
+package api
+
+import (
+	"encoding/binary"
+	"testing"
+	"time"
+)
+
+// encodeFileInfoRecord mirrors agfs::ffi::BinaryCodec::encode for one record
+func encodeFileInfoRecord(name string, size int64, mode uint32, modTime int64, isDir bool, meta []string) []byte {
+	var rec []byte
+	rec = binary.LittleEndian.AppendUint64(rec, uint64(size))
+	rec = binary.LittleEndian.AppendUint32(rec, mode)
+	rec = binary.LittleEndian.AppendUint64(rec, uint64(modTime))
+	var flags byte
+	if isDir {
+		flags |= fileInfoBinFlagDir
+	}
+	if meta != nil {
+		flags |= fileInfoBinFlagMeta
+	}
+	rec = append(rec, flags)
+	strs := append([]string{name}, meta...)
+	for _, s := range strs {
+		rec = binary.LittleEndian.AppendUint32(rec, uint32(len(s)))
+		rec = append(rec, s...)
+	}
+	return append(binary.LittleEndian.AppendUint32(nil, uint32(len(rec))), rec...)
+}
+
+func encodeFileInfoBuffer(records ...[]byte) []byte {
+	body := []byte{}
+	for _, r := range records {
+		body = append(body, r...)
+	}
+	buf := binary.LittleEndian.AppendUint32(nil, uint32(fileInfoBinHeaderSize+len(body)))
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(records)))
+	return append(buf, body...)
+}
+
+func TestDecodeFileInfoBinary(t *testing.T) {
+	buf := encodeFileInfoBuffer(
+		encodeFileInfoRecord("hello.txt", 21, 0644, 0, false, nil),
+		encodeFileInfoRecord("host", 0, 0755, 1700000000, true, []string{"hellofs", "dir", `{"k":"v"}`}),
+	)
+
+	infos, err := decodeFileInfoBinary(buf)
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if len(infos) != 2 {
+		t.Fatalf("expected 2 entries, got %d", len(infos))
+	}
+
+	file := infos[0]
+	if file.Name != "hello.txt" || file.Size != 21 || file.Mode != 0644 || file.IsDir {
+		t.Errorf("unexpected file entry: %+v", file)
+	}
+	if !file.ModTime.IsZero() {
+		t.Errorf("expected zero ModTime, got %v", file.ModTime)
+	}
+
+	dir := infos[1]
+	if dir.Name != "host" || !dir.IsDir || dir.Mode != 0755 {
+		t.Errorf("unexpected dir entry: %+v", dir)
+	}
+	if !dir.ModTime.Equal(time.Unix(1700000000, 0)) {
+		t.Errorf("unexpected ModTime: %v", dir.ModTime)
+	}
+	if dir.Meta.Name != "hellofs" || dir.Meta.Type != "dir" || dir.Meta.Content["k"] != "v" {
+		t.Errorf("unexpected meta: %+v", dir.Meta)
+	}
+}
+
+func TestDecodeFileInfoBinaryEmpty(t *testing.T) {
+	infos, err := decodeFileInfoBinary(encodeFileInfoBuffer())
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if len(infos) != 0 {
+		t.Errorf("expected no entries, got %d", len(infos))
+	}
+}
+
+func TestDecodeFileInfoBinaryTruncated(t *testing.T) {
+	buf := encodeFileInfoBuffer(encodeFileInfoRecord("a", 1, 0644, 0, false, nil))
+
+	if _, err := decodeFileInfoBinary(buf[:len(buf)-1]); err == nil {
+		t.Error("expected error for truncated buffer")
+	}
+
+	// Header claims more records than are present
+	binary.LittleEndian.PutUint32(buf[4:8], 2)
+	if _, err := decodeFileInfoBinary(buf); err == nil {
+		t.Error("expected error for missing record")
+	}
+}
@@ -12,6 +12,20 @@ import (
 // Host function implementations for filesystem operations
 // These functions are exported to WASM modules and allow them to access the host filesystem
 
+// hostErrNoMessage stands in for an error pointer when the message itself
+// could not be written into WASM memory; plugins must not read or free it
+const hostErrNoMessage = 1
+
+// writeHostError copies an error message into WASM memory for the plugin to free
+// Returns: Its address, or hostErrNoMessage if it could not be written
+func writeHostError(mod wazeroapi.Module, msg string) uint32 {
+	ptr, _, err := writeStringToMemory(mod, msg)
+	if err != nil || ptr == 0 {
+		return hostErrNoMessage
+	}
+	return ptr
+}
+
 func HostFSRead(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
 	pathPtr := uint32(params[0])
 	offset := int64(params[1])
@@ -31,7 +45,7 @@ func HostFSRead(ctx context.Context, mod wazeroapi.Module, params []uint64, fs f
 		return []uint64{0}
 	}
 
-	data, err := fs.Read(path, offset, size)
+	data, _, err := filesystem.ReadUpTo(fs, path, offset, size)
 	if err != nil {
 		log.Errorf("host_fs_read: error reading file: %v", err)
 		return []uint64{0}
@@ -85,20 +99,150 @@ func HostFSWrite(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	return []uint64{uint64(bytesWritten)}
 }
 
+// HostFSWriteAt writes at an offset with explicit write flags
+// Returns packed u64: high 32 bits = bytes written, low 32 bits = error pointer (0 = success)
+func HostFSWriteAt(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+	dataPtr := uint32(params[1])
+	dataLen := uint32(params[2])
+	offset := int64(params[3])
+	flags := filesystem.WriteFlag(uint32(params[4]))
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_write_at: failed to read path from memory")
+		errPtr := writeHostError(mod, "failed to read path from memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	data, ok := mod.Memory().Read(dataPtr, dataLen)
+	if !ok {
+		log.Errorf("host_fs_write_at: failed to read data from memory")
+		errPtr := writeHostError(mod, "failed to read data from memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	log.Debugf("host_fs_write_at: path=%s, dataLen=%d, offset=%d, flags=%d", path, dataLen, offset, flags)
+
+	if fs == nil {
+		log.Errorf("host_fs_write_at: no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr)}
+	}
+
+	bytesWritten, err := fs.Write(path, data, offset, flags)
+	if err != nil {
+		log.Errorf("host_fs_write_at: error writing file: %v", err)
+		errPtr := writeHostError(mod, err.Error())
+		return []uint64{uint64(errPtr)}
+	}
+
+	return []uint64{uint64(uint32(bytesWritten)) << 32}
+}
+
+// HostFSCopy copies a range between two host paths without the data
+// entering WASM memory (see filesystem.CopyRange)
+// Stores the bytes copied as an i64 at copiedPtr and returns an error
+// pointer (0 = success).
+func HostFSCopy(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	srcPtr := uint32(params[0])
+	dstPtr := uint32(params[1])
+	srcOffset := int64(params[2])
+	dstOffset := int64(params[3])
+	length := int64(params[4])
+	flags := filesystem.WriteFlag(uint32(params[5]))
+	copiedPtr := uint32(params[6])
+
+	src, ok := readStringFromMemory(mod, srcPtr)
+	if !ok {
+		errPtr := writeHostError(mod, "failed to read source path from memory")
+		return []uint64{uint64(errPtr)}
+	}
+	dst, ok := readStringFromMemory(mod, dstPtr)
+	if !ok {
+		errPtr := writeHostError(mod, "failed to read destination path from memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	log.Debugf("host_fs_copy: src=%s@%d, dst=%s@%d, length=%d, flags=%d", src, srcOffset, dst, dstOffset, length, flags)
+
+	if fs == nil {
+		log.Errorf("host_fs_copy: no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr)}
+	}
+
+	copied, err := filesystem.CopyRange(fs, src, srcOffset, dst, dstOffset, length, flags)
+	if copiedPtr != 0 && !mod.Memory().WriteUint64Le(copiedPtr, uint64(copied)) {
+		log.Errorf("host_fs_copy: failed to write byte count to memory")
+	}
+	if err != nil {
+		log.Errorf("host_fs_copy: error copying: %v", err)
+		errPtr := writeHostError(mod, err.Error())
+		return []uint64{uint64(errPtr)}
+	}
+
+	return []uint64{0}
+}
+
+// HostFSMap fills a region the plugin reserved at dstPtr with dstLen bytes of
+// a host file (see filesystem.ReadInto), for HostFS::map
+// The data lands in WASM memory without an intermediate buffer when the host
+// filesystem supports handles.
+// Returns packed u64: high 32 bits = bytes placed, low 32 bits = error pointer (0 = success)
+func HostFSMap(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+	offset := int64(params[1])
+	dstLen := uint32(params[2])
+	dstPtr := uint32(params[3])
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_map: failed to read path from memory")
+		errPtr := writeHostError(mod, "failed to read path from memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	// A view of the reserved region itself, so reads land in place
+	dst, ok := mod.Memory().Read(dstPtr, dstLen)
+	if !ok {
+		log.Errorf("host_fs_map: region %d+%d is outside memory", dstPtr, dstLen)
+		errPtr := writeHostError(mod, "map region is outside memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	log.Debugf("host_fs_map: path=%s, offset=%d, len=%d", path, offset, dstLen)
+
+	if fs == nil {
+		log.Errorf("host_fs_map: no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr)}
+	}
+
+	n, err := filesystem.ReadInto(fs, path, offset, dst)
+	if err != nil {
+		log.Errorf("host_fs_map: error reading file: %v", err)
+		errPtr := writeHostError(mod, err.Error())
+		return []uint64{uint64(errPtr)}
+	}
+
+	return []uint64{uint64(uint32(n)) << 32}
+}
+
 func HostFSStat(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
 	pathPtr := uint32(params[0])
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
 		log.Errorf("host_fs_stat: failed to read path from memory")
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	log.Debugf("host_fs_stat: path=%s", path)
 
 	if fs == nil {
 		log.Errorf("host_fs_stat: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr) << 32}
 	}
 
@@ -106,11 +250,7 @@ func HostFSStat(ctx context.Context, mod wazeroapi.Module, params []uint64, fs f
 	if err != nil {
 		log.Errorf("host_fs_stat: error stating file: %v", err)
 		// Pack error: upper 32 bits = error pointer
-		errStr := err.Error()
-		errPtr, _, err := writeStringToMemory(mod, errStr)
-		if err != nil {
-			return []uint64{0}
-		}
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr) << 32}
 	}
 
@@ -118,13 +258,13 @@ func HostFSStat(ctx context.Context, mod wazeroapi.Module, params []uint64, fs f
 	jsonData, err := json.Marshal(fileInfo)
 	if err != nil {
 		log.Errorf("host_fs_stat: failed to marshal fileInfo: %v", err)
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	jsonPtr, _, err := writeStringToMemory(mod, string(jsonData))
 	if err != nil {
 		log.Errorf("host_fs_stat: failed to write JSON to memory: %v", err)
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	// Pack: lower 32 bits = json pointer, upper 32 bits = 0 (no error)
@@ -137,25 +277,21 @@ func HostFSReadDir(ctx context.Context, mod wazeroapi.Module, params []uint64, f
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
 		log.Errorf("host_fs_readdir: failed to read path from memory")
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	log.Debugf("host_fs_readdir: path=%s", path)
 
 	if fs == nil {
 		log.Errorf("host_fs_readdir: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr) << 32}
 	}
 
 	fileInfos, err := fs.ReadDir(path)
 	if err != nil {
 		log.Errorf("host_fs_readdir: error reading directory: %v", err)
-		errStr := err.Error()
-		errPtr, _, err := writeStringToMemory(mod, errStr)
-		if err != nil {
-			return []uint64{0}
-		}
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr) << 32}
 	}
 
@@ -163,13 +299,13 @@ func HostFSReadDir(ctx context.Context, mod wazeroapi.Module, params []uint64, f
 	jsonData, err := json.Marshal(fileInfos)
 	if err != nil {
 		log.Errorf("host_fs_readdir: failed to marshal fileInfos: %v", err)
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	jsonPtr, _, err := writeStringToMemory(mod, string(jsonData))
 	if err != nil {
 		log.Errorf("host_fs_readdir: failed to write JSON to memory: %v", err)
-		return []uint64{0}
+		return []uint64{uint64(hostErrNoMessage) << 32}
 	}
 
 	return []uint64{uint64(jsonPtr)}
@@ -180,21 +316,21 @@ func HostFSCreate(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1} // Error
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_create: path=%s", path)
 
 	if fs == nil {
 		log.Errorf("host_fs_create: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.Create(path)
 	if err != nil {
 		log.Errorf("host_fs_create: error creating file: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -207,21 +343,21 @@ func HostFSMkdir(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_mkdir: path=%s, perm=%o", path, perm)
 
 	if fs == nil {
 		log.Errorf("host_fs_mkdir: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.Mkdir(path, perm)
 	if err != nil {
 		log.Errorf("host_fs_mkdir: error creating directory: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -233,21 +369,21 @@ func HostFSRemove(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_remove: path=%s", path)
 
 	if fs == nil {
 		log.Errorf("host_fs_remove: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.Remove(path)
 	if err != nil {
 		log.Errorf("host_fs_remove: error removing: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -259,21 +395,21 @@ func HostFSRemoveAll(ctx context.Context, mod wazeroapi.Module, params []uint64,
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_remove_all: path=%s", path)
 
 	if fs == nil {
 		log.Errorf("host_fs_remove_all: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.RemoveAll(path)
 	if err != nil {
 		log.Errorf("host_fs_remove_all: error removing: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -286,26 +422,26 @@ func HostFSRename(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	oldPath, ok := readStringFromMemory(mod, oldPathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	newPath, ok := readStringFromMemory(mod, newPathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_rename: oldPath=%s, newPath=%s", oldPath, newPath)
 
 	if fs == nil {
 		log.Errorf("host_fs_rename: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.Rename(oldPath, newPath)
 	if err != nil {
 		log.Errorf("host_fs_rename: error renaming: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -318,21 +454,21 @@ func HostFSChmod(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return []uint64{hostErrNoMessage}
 	}
 
 	log.Debugf("host_fs_chmod: path=%s, mode=%o", path, mode)
 
 	if fs == nil {
 		log.Errorf("host_fs_chmod: no host filesystem provided")
-		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		errPtr := writeHostError(mod, "no host filesystem provided")
 		return []uint64{uint64(errPtr)}
 	}
 
 	err := fs.Chmod(path, mode)
 	if err != nil {
 		log.Errorf("host_fs_chmod: error changing mode: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr := writeHostError(mod, err.Error())
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -0,0 +1,20 @@
+package api
+
+import (
+	"testing"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// noMallocModule cannot allocate, so no error message fits into its memory
+type noMallocModule struct {
+	wazeroapi.Module
+}
+
+func (noMallocModule) ExportedFunction(string) wazeroapi.Function { return nil }
+
+func TestWriteHostErrorWithoutMemory(t *testing.T) {
+	if got := writeHostError(noMallocModule{}, "boom"); got != hostErrNoMessage {
+		t.Fatalf("writeHostError = %d, want hostErrNoMessage (%d)", got, hostErrNoMessage)
+	}
+}
@@ -1,11 +1,12 @@
 package api
 
 import (
+	"bytes"
 	"context"
 	"encoding/json"
 	"io"
 	"net/http"
-	"strings"
+	"sync"
 	"time"
 
 	log "github.com/sirupsen/logrus"
@@ -56,48 +57,46 @@ func HostHTTPRequest(ctx context.Context, mod wazeroapi.Module, params []uint64)
 		return packHTTPResponse(mod, &resp)
 	}
 
+	resp := doHTTPRequest(ctx, nil, &req)
+	return packHTTPResponse(mod, resp)
+}
+
+// doHTTPRequest performs req and collects the whole response
+// client may be nil, in which case a client with the request's timeout is used.
+// Failures are reported through HTTPResponse.Error.
+func doHTTPRequest(ctx context.Context, client *http.Client, req *HTTPRequest) *HTTPResponse {
 	// Validate method
 	if req.Method == "" {
 		req.Method = "GET"
 	}
 
 	// Create HTTP client with timeout
-	timeout := time.Duration(req.Timeout) * time.Second
-	if timeout == 0 {
-		timeout = 30 * time.Second // default 30s timeout
-	}
-	client := &http.Client{
-		Timeout: timeout,
+	if client == nil {
+		timeout := time.Duration(req.Timeout) * time.Second
+		if timeout == 0 {
+			timeout = 30 * time.Second // default 30s timeout
+		}
+		client = &http.Client{
+			Timeout: timeout,
+		}
 	}
 
 	// Create HTTP request
-	var bodyReader io.Reader
-	if len(req.Body) > 0 {
-		bodyReader = strings.NewReader(string(req.Body))
-	}
-
-	httpReq, err := http.NewRequestWithContext(ctx, req.Method, req.URL, bodyReader)
+	httpReq, err := newHTTPRequest(ctx, req)
 	if err != nil {
 		log.Errorf("host_http_request: failed to create request: %v", err)
-		resp := HTTPResponse{
+		return &HTTPResponse{
 			Error: "failed to create request: " + err.Error(),
 		}
-		return packHTTPResponse(mod, &resp)
-	}
-
-	// Set headers
-	for key, value := range req.Headers {
-		httpReq.Header.Set(key, value)
 	}
 
 	// Perform request
 	httpResp, err := client.Do(httpReq)
 	if err != nil {
 		log.Errorf("host_http_request: request failed: %v", err)
-		resp := HTTPResponse{
+		return &HTTPResponse{
 			Error: "request failed: " + err.Error(),
 		}
-		return packHTTPResponse(mod, &resp)
 	}
 	defer httpResp.Body.Close()
 
@@ -105,30 +104,51 @@ func HostHTTPRequest(ctx context.Context, mod wazeroapi.Module, params []uint64)
 	respBody, err := io.ReadAll(httpResp.Body)
 	if err != nil {
 		log.Errorf("host_http_request: failed to read response body: %v", err)
-		resp := HTTPResponse{
+		return &HTTPResponse{
 			StatusCode: httpResp.StatusCode,
 			Error:      "failed to read response body: " + err.Error(),
 		}
-		return packHTTPResponse(mod, &resp)
-	}
-
-	// Build response headers map
-	respHeaders := make(map[string]string)
-	for key, values := range httpResp.Header {
-		if len(values) > 0 {
-			respHeaders[key] = values[0] // Take first value
-		}
 	}
 
 	// Create response
-	resp := HTTPResponse{
+	resp := &HTTPResponse{
 		StatusCode: httpResp.StatusCode,
-		Headers:    respHeaders,
+		Headers:    flattenHTTPHeaders(httpResp.Header),
 		Body:       respBody,
 	}
 
 	log.Debugf("host_http_request: status=%d, bodyLen=%d", resp.StatusCode, len(resp.Body))
-	return packHTTPResponse(mod, &resp)
+	return resp
+}
+
+// newHTTPRequest builds an *http.Request with req's method, URL, body and headers
+func newHTTPRequest(ctx context.Context, req *HTTPRequest) (*http.Request, error) {
+	var bodyReader io.Reader
+	if len(req.Body) > 0 {
+		bodyReader = bytes.NewReader(req.Body)
+	}
+
+	httpReq, err := http.NewRequestWithContext(ctx, req.Method, req.URL, bodyReader)
+	if err != nil {
+		return nil, err
+	}
+
+	// Set headers
+	for key, value := range req.Headers {
+		httpReq.Header.Set(key, value)
+	}
+	return httpReq, nil
+}
+
+// flattenHTTPHeaders keeps the first value of each response header
+func flattenHTTPHeaders(header http.Header) map[string]string {
+	respHeaders := make(map[string]string, len(header))
+	for key, values := range header {
+		if len(values) > 0 {
+			respHeaders[key] = values[0] // Take first value
+		}
+	}
+	return respHeaders
 }
 
 // packHTTPResponse serializes and writes HTTPResponse to WASM memory
@@ -149,3 +169,96 @@ func packHTTPResponse(mod wazeroapi.Module, resp *HTTPResponse) []uint64 {
 	packed := uint64(respPtr) | (uint64(len(respJSON)) << 32)
 	return []uint64{packed}
 }
+
+// hostHTTPState holds the HTTP resources a module instance has open
+// Resources are addressed by small integer IDs handed to the plugin and are
+// released together by ReleaseHostHTTPState when the instance is destroyed.
+type hostHTTPState struct {
+	mu       sync.Mutex
+	nextID   uint32
+	streams  map[uint32]*hostHTTPStream
+	sessions map[uint32]*hostHTTPSession
+	tickets  map[uint32]*hostHTTPTicket
+	inflight chan struct{} // semaphore for submitted requests
+}
+
+// hostHTTPStates maps wazeroapi.Module -> *hostHTTPState
+var hostHTTPStates sync.Map
+
+// hostHTTPOwners maps a worker wazeroapi.Module -> the module its state is keyed by
+// Workers of a threaded pool share one plugin, so they share one state too.
+var hostHTTPOwners sync.Map
+
+// httpStateKey returns the module mod's HTTP state is stored under
+func httpStateKey(mod wazeroapi.Module) wazeroapi.Module {
+	if owner, ok := hostHTTPOwners.Load(mod); ok {
+		return owner.(wazeroapi.Module)
+	}
+	return mod
+}
+
+// ShareHostHTTPState makes mod use the HTTP state of owner
+// Resources mod opened on its own so far move over to owner, unless owner
+// already has a state of its own. Undo with UnshareHostHTTPState.
+func ShareHostHTTPState(mod, owner wazeroapi.Module) {
+	if value, ok := hostHTTPStates.LoadAndDelete(mod); ok {
+		if _, loaded := hostHTTPStates.LoadOrStore(owner, value); loaded {
+			hostHTTPStates.Store(mod, value)
+			ReleaseHostHTTPState(mod)
+		}
+	}
+	hostHTTPOwners.Store(mod, owner)
+}
+
+// UnshareHostHTTPState detaches mod from the state it shares
+// The state itself stays open for the owner's other modules.
+func UnshareHostHTTPState(mod wazeroapi.Module) {
+	hostHTTPOwners.Delete(mod)
+}
+
+func httpStateFor(mod wazeroapi.Module) *hostHTTPState {
+	mod = httpStateKey(mod)
+	if state, ok := hostHTTPStates.Load(mod); ok {
+		return state.(*hostHTTPState)
+	}
+	state, _ := hostHTTPStates.LoadOrStore(mod, &hostHTTPState{
+		streams:  make(map[uint32]*hostHTTPStream),
+		sessions: make(map[uint32]*hostHTTPSession),
+		tickets:  make(map[uint32]*hostHTTPTicket),
+		inflight: make(chan struct{}, maxConcurrentHTTPRequests),
+	})
+	return state.(*hostHTTPState)
+}
+
+// allocID returns an unused non-zero resource ID; the caller holds s.mu
+func (s *hostHTTPState) allocID() uint32 {
+	s.nextID++
+	if s.nextID == 0 {
+		s.nextID = 1
+	}
+	return s.nextID
+}
+
+// ReleaseHostHTTPState closes every HTTP resource opened by mod
+// For a shared state, mod is the owner passed to ShareHostHTTPState.
+func ReleaseHostHTTPState(mod wazeroapi.Module) {
+	value, ok := hostHTTPStates.LoadAndDelete(mod)
+	if !ok {
+		return
+	}
+	state := value.(*hostHTTPState)
+	state.mu.Lock()
+	defer state.mu.Unlock()
+	for id, stream := range state.streams {
+		stream.close()
+		delete(state.streams, id)
+	}
+	for id, ticket := range state.tickets {
+		ticket.cancel()
+		delete(state.tickets, id)
+	}
+	for id, session := range state.sessions {
+		session.close()
+		delete(state.sessions, id)
+	}
+}
@@ -0,0 +1,153 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"fmt"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// maxConcurrentHTTPRequests caps how many submitted requests of one instance
+// are in flight at once; further submissions queue behind them
+const maxConcurrentHTTPRequests = 32
+
+// maxHTTPWaitTickets caps how many ticket IDs one host_http_wait call accepts
+const maxHTTPWaitTickets = 1 << 16
+
+// hostHTTPTicket is a request submitted with host_http_submit
+// resp is written once, before done is closed.
+type hostHTTPTicket struct {
+	done   chan struct{}
+	resp   *HTTPResponse
+	cancel context.CancelFunc
+}
+
+// submitHTTPRequest starts req in the background and registers a ticket for it
+func (s *hostHTTPState) submitHTTPRequest(session *hostHTTPSession, req *HTTPRequest) uint32 {
+	ctx, cancel := context.WithCancel(context.Background())
+	ticket := &hostHTTPTicket{done: make(chan struct{}), cancel: cancel}
+
+	s.mu.Lock()
+	id := s.allocID()
+	s.tickets[id] = ticket
+	s.mu.Unlock()
+
+	go func() {
+		defer close(ticket.done)
+		defer cancel()
+		select {
+		case s.inflight <- struct{}{}:
+			defer func() { <-s.inflight }()
+		case <-ctx.Done():
+			ticket.resp = &HTTPResponse{Error: "request cancelled"}
+			return
+		}
+		if session != nil {
+			ticket.resp = session.do(ctx, req)
+		} else {
+			ticket.resp = doHTTPRequest(ctx, nil, req)
+		}
+	}()
+	return id
+}
+
+// collectHTTPTickets returns the completed results among ids, in order, and
+// forgets their tickets. With wait set it blocks until every ticket is done.
+// Unknown IDs complete immediately with an error.
+func (s *hostHTTPState) collectHTTPTickets(ids []uint32, wait bool) []byte {
+	out := binary.LittleEndian.AppendUint32(nil, 0)
+	count := uint32(0)
+	for _, id := range ids {
+		s.mu.Lock()
+		ticket := s.tickets[id]
+		s.mu.Unlock()
+
+		var resp *HTTPResponse
+		if ticket == nil {
+			resp = &HTTPResponse{Error: fmt.Sprintf("unknown HTTP ticket %d", id)}
+		} else {
+			if wait {
+				<-ticket.done
+			}
+			select {
+			case <-ticket.done:
+				resp = ticket.resp
+			default:
+				continue
+			}
+			s.mu.Lock()
+			delete(s.tickets, id)
+			s.mu.Unlock()
+		}
+
+		out = binary.LittleEndian.AppendUint32(out, id)
+		out = appendHTTPBytes(out, encodeHTTPResponse(resp))
+		count++
+	}
+	binary.LittleEndian.PutUint32(out, count)
+	return out
+}
+
+// HostHTTPSubmit starts a request without waiting for its response
+// Parameters:
+//   - params[0]: session ID, or 0 to send the request without a session
+//   - params[1..4]: encoded request header and body, as for HostHTTPRequestV2
+//
+// Returns: ticket ID for host_http_wait, or 0 on failure
+func HostHTTPSubmit(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	state := httpStateFor(mod)
+	var session *hostHTTPSession
+	if sessionID := uint32(params[0]); sessionID != 0 {
+		state.mu.Lock()
+		session = state.sessions[sessionID]
+		state.mu.Unlock()
+		if session == nil {
+			log.Errorf("host_http_submit: unknown session %d", sessionID)
+			return []uint64{0}
+		}
+	}
+
+	req, err := readHTTPRequestV2(mod, uint32(params[1]), uint32(params[2]), uint32(params[3]), uint32(params[4]))
+	if err != nil {
+		log.Errorf("host_http_submit: %v", err)
+		return []uint64{0}
+	}
+
+	return []uint64{uint64(state.submitHTTPRequest(session, req))}
+}
+
+// HostHTTPWait collects the results of submitted requests in one call
+// Parameters:
+//   - params[0], params[1]: pointer to and count of u32 ticket IDs
+//   - params[2]: 1 to block until all of them complete, 0 to return only those already done
+//
+// Returns: packed u64 (lower 32 bits = buffer pointer, upper 32 bits = buffer size)
+// where the buffer is u32 result_count followed by result_count ×
+// (u32 ticket, u32 len + binary response). Collected tickets are released.
+func HostHTTPWait(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	idsPtr := uint32(params[0])
+	count := uint64(uint32(params[1]))
+	if count > maxHTTPWaitTickets {
+		log.Errorf("host_http_wait: %d tickets exceeds the limit of %d", count, maxHTTPWaitTickets)
+		return []uint64{0}
+	}
+	raw, ok := mod.Memory().Read(idsPtr, uint32(count*4))
+	if !ok {
+		log.Errorf("host_http_wait: failed to read tickets from memory")
+		return []uint64{0}
+	}
+	ids := make([]uint32, count)
+	for i := range ids {
+		ids[i] = binary.LittleEndian.Uint32(raw[i*4:])
+	}
+
+	encoded := httpStateFor(mod).collectHTTPTickets(ids, params[2] != 0)
+	ptr, _, err := writeBytesToMemory(mod, encoded)
+	if err != nil {
+		log.Errorf("host_http_wait: failed to write results to memory: %v", err)
+		return []uint64{0}
+	}
+	return []uint64{uint64(ptr) | (uint64(len(encoded)) << 32)}
+}
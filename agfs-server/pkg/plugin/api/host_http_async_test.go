@@ -0,0 +1,110 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"net/http"
+	"net/http/httptest"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+type testHTTPResult struct {
+	ticket uint32
+	resp   *HTTPResponse
+}
+
+func decodeTestHTTPResults(t *testing.T, buf []byte) []testHTTPResult {
+	r := &httpCodecReader{buf: buf}
+	count := r.u32()
+	var results []testHTTPResult
+	for i := uint32(0); i < count; i++ {
+		ticket := r.u32()
+		resp := &httpCodecReader{buf: r.bytes()}
+		status := resp.u32()
+		errMsg := resp.str()
+		for n := resp.u32(); n > 0; n-- {
+			resp.str()
+			resp.str()
+		}
+		body := resp.bytes()
+		if r.err != nil || resp.err != nil {
+			t.Fatalf("malformed results buffer")
+		}
+		results = append(results, testHTTPResult{ticket, &HTTPResponse{StatusCode: int(status), Error: errMsg, Body: body}})
+	}
+	return results
+}
+
+func TestHTTPSubmitRunsConcurrently(t *testing.T) {
+	var active, peak int32
+	server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		n := atomic.AddInt32(&active, 1)
+		for {
+			p := atomic.LoadInt32(&peak)
+			if n <= p || atomic.CompareAndSwapInt32(&peak, p, n) {
+				break
+			}
+		}
+		time.Sleep(100 * time.Millisecond)
+		atomic.AddInt32(&active, -1)
+		w.Write([]byte(r.URL.Path))
+	}))
+	defer server.Close()
+
+	state := httpStateFor(nil)
+	defer ReleaseHostHTTPState(nil)
+
+	paths := []string{"/a", "/b", "/c", "/d"}
+	var ids []uint32
+	for _, path := range paths {
+		ids = append(ids, state.submitHTTPRequest(nil, &HTTPRequest{Method: "GET", URL: server.URL + path}))
+	}
+
+	if results := decodeTestHTTPResults(t, state.collectHTTPTickets(ids, false)); len(results) != 0 {
+		t.Fatalf("poll returned %d results before any request finished", len(results))
+	}
+
+	start := time.Now()
+	results := decodeTestHTTPResults(t, state.collectHTTPTickets(ids, true))
+	if elapsed := time.Since(start); elapsed > 300*time.Millisecond {
+		t.Fatalf("wait took %v; requests did not run concurrently", elapsed)
+	}
+	if len(results) != len(paths) {
+		t.Fatalf("got %d results, want %d", len(results), len(paths))
+	}
+	for i, result := range results {
+		if result.ticket != ids[i] || string(result.resp.Body) != paths[i] {
+			t.Fatalf("result %d = ticket %d body %q", i, result.ticket, result.resp.Body)
+		}
+	}
+	if atomic.LoadInt32(&peak) < 2 {
+		t.Fatalf("peak concurrency %d", peak)
+	}
+
+	// Collected tickets are released
+	results = decodeTestHTTPResults(t, state.collectHTTPTickets(ids[:1], false))
+	if len(results) != 1 || results[0].resp.Error == "" {
+		t.Fatalf("expected an unknown-ticket error, got %+v", results)
+	}
+}
+
+func TestEncodeHTTPResultsHeader(t *testing.T) {
+	state := httpStateFor(nil)
+	defer ReleaseHostHTTPState(nil)
+	out := state.collectHTTPTickets(nil, true)
+	if len(out) != 4 || binary.LittleEndian.Uint32(out) != 0 {
+		t.Fatalf("unexpected empty result buffer %v", out)
+	}
+}
+
+func TestHTTPWaitRejectsOversizedCount(t *testing.T) {
+	// 0x40000001 tickets would wrap count*4 to 4 bytes in uint32; the call
+	// must fail before touching memory (noMallocModule has none).
+	for _, count := range []uint64{maxHTTPWaitTickets + 1, 0x40000001, 0xFFFFFFFF} {
+		if got := HostHTTPWait(context.Background(), noMallocModule{}, []uint64{0, count, 0}); got[0] != 0 {
+			t.Fatalf("HostHTTPWait(count=%d) = %d, want 0", count, got[0])
+		}
+	}
+}
@@ -0,0 +1,225 @@
+package api
+
+import (
+	"context"
+	"fmt"
+	"net/http"
+	"net/url"
+	"strings"
+	"sync"
+	"time"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Binary session configuration used by host_http_session_open (little-endian):
+//
+//	u32 base_url_len + base_url, u32 timeout (seconds),
+//	u32 header_count, then header_count × (u32 key_len + key, u32 value_len + value)
+
+// sessionIdleConnsPerHost is how many idle connections a session origin keeps;
+// net/http defaults to 2, which forces new handshakes under concurrent use
+const sessionIdleConnsPerHost = 64
+
+// hostHTTPSession holds a plugin's defaults for requests to one base URL
+type hostHTTPSession struct {
+	baseURL string
+	origin  string // key of the shared transport, released by close
+	headers map[string]string
+	client  *http.Client
+}
+
+// sharedTransport is an origin's connection pool and the sessions using it
+type sharedTransport struct {
+	transport *http.Transport
+	refs      int
+}
+
+// sessionTransports maps an origin (scheme://host) to its shared transport
+// Every open session of every instance talking to the same origin reuses one
+// connection pool; the last session to close shuts it down.
+var (
+	sessionTransportsMu sync.Mutex
+	sessionTransports   = make(map[string]*sharedTransport)
+)
+
+// acquireSessionTransport returns origin's transport and counts one more session using it
+func acquireSessionTransport(origin string) *http.Transport {
+	sessionTransportsMu.Lock()
+	defer sessionTransportsMu.Unlock()
+	shared, ok := sessionTransports[origin]
+	if !ok {
+		transport := http.DefaultTransport.(*http.Transport).Clone()
+		transport.MaxIdleConns = 0 // no overall limit, only per host
+		transport.MaxIdleConnsPerHost = sessionIdleConnsPerHost
+		shared = &sharedTransport{transport: transport}
+		sessionTransports[origin] = shared
+	}
+	shared.refs++
+	return shared.transport
+}
+
+// releaseSessionTransport drops one session's reference to origin's transport
+// The last one closes its idle connections and forgets it.
+func releaseSessionTransport(origin string) {
+	sessionTransportsMu.Lock()
+	defer sessionTransportsMu.Unlock()
+	shared, ok := sessionTransports[origin]
+	if !ok {
+		return
+	}
+	shared.refs--
+	if shared.refs <= 0 {
+		shared.transport.CloseIdleConnections()
+		delete(sessionTransports, origin)
+	}
+}
+
+// decodeHTTPSessionConfig decodes a binary session configuration
+func decodeHTTPSessionConfig(buf []byte) (*hostHTTPSession, error) {
+	r := &httpCodecReader{buf: buf}
+	baseURL := r.str()
+	timeout := time.Duration(r.u32()) * time.Second
+	count := r.u32()
+	headers := make(map[string]string)
+	for i := uint32(0); i < count && r.err == nil; i++ {
+		key := r.str()
+		headers[key] = r.str()
+	}
+	if r.err != nil {
+		return nil, r.err
+	}
+
+	base, err := url.Parse(baseURL)
+	if err != nil {
+		return nil, err
+	}
+	if base.Scheme == "" || base.Host == "" {
+		return nil, fmt.Errorf("session base URL must be absolute: %q", baseURL)
+	}
+	if timeout == 0 {
+		timeout = 30 * time.Second // default 30s timeout
+	}
+
+	origin := base.Scheme + "://" + base.Host
+	return &hostHTTPSession{
+		baseURL: baseURL,
+		origin:  origin,
+		headers: headers,
+		client: &http.Client{
+			Transport: acquireSessionTransport(origin),
+			Timeout:   timeout,
+		},
+	}, nil
+}
+
+// close gives up the session's share of its origin's transport
+func (s *hostHTTPSession) close() {
+	releaseSessionTransport(s.origin)
+}
+
+// prepare resolves req against the session's base URL and default headers
+// Absolute URLs are used as-is; anything else is appended to the base URL.
+// Headers set on the request take precedence over the session defaults.
+func (s *hostHTTPSession) prepare(req *HTTPRequest) {
+	if !strings.Contains(req.URL, "://") {
+		if req.URL == "" {
+			req.URL = s.baseURL
+		} else {
+			req.URL = strings.TrimSuffix(s.baseURL, "/") + "/" + strings.TrimPrefix(req.URL, "/")
+		}
+	}
+	if len(s.headers) > 0 {
+		headers := make(map[string]string, len(s.headers)+len(req.Headers))
+		for key, value := range s.headers {
+			headers[key] = value
+		}
+		for key, value := range req.Headers {
+			headers[key] = value
+		}
+		req.Headers = headers
+	}
+}
+
+// do performs req with the session's client
+// A non-zero per-request timeout replaces the session timeout.
+func (s *hostHTTPSession) do(ctx context.Context, req *HTTPRequest) *HTTPResponse {
+	s.prepare(req)
+	client := s.client
+	if req.Timeout > 0 {
+		withTimeout := *s.client
+		withTimeout.Timeout = time.Duration(req.Timeout) * time.Second
+		client = &withTimeout
+	}
+	return doHTTPRequest(ctx, client, req)
+}
+
+// HostHTTPSessionOpen creates a session from a binary configuration
+// Parameters:
+//   - params[0], params[1]: pointer and length of the encoded configuration
+//
+// Returns: session ID, or 0 on failure
+func HostHTTPSessionOpen(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	buf, ok := mod.Memory().Read(uint32(params[0]), uint32(params[1]))
+	if !ok {
+		log.Errorf("host_http_session_open: failed to read config from memory")
+		return []uint64{0}
+	}
+	session, err := decodeHTTPSessionConfig(buf)
+	if err != nil {
+		log.Errorf("host_http_session_open: %v", err)
+		return []uint64{0}
+	}
+
+	state := httpStateFor(mod)
+	state.mu.Lock()
+	id := state.allocID()
+	state.sessions[id] = session
+	state.mu.Unlock()
+
+	log.Debugf("host_http_session_open: id=%d, base=%s", id, session.baseURL)
+	return []uint64{uint64(id)}
+}
+
+// HostHTTPSessionRequest performs a request through a session
+// Parameters:
+//   - params[0]: session ID
+//   - params[1..4]: encoded request header and body, as for HostHTTPRequestV2
+//
+// Returns: packed u64 (lower 32 bits = response pointer, upper 32 bits = response size)
+func HostHTTPSessionRequest(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+	state := httpStateFor(mod)
+	state.mu.Lock()
+	session := state.sessions[id]
+	state.mu.Unlock()
+	if session == nil {
+		return []uint64{packHTTPResponseV2(mod, &HTTPResponse{Error: fmt.Sprintf("unknown HTTP session %d", id)})}
+	}
+
+	req, err := readHTTPRequestV2(mod, uint32(params[1]), uint32(params[2]), uint32(params[3]), uint32(params[4]))
+	if err != nil {
+		log.Errorf("host_http_session_request: %v", err)
+		return []uint64{packHTTPResponseV2(mod, &HTTPResponse{Error: "failed to parse request: " + err.Error()})}
+	}
+
+	resp := session.do(ctx, req)
+	return []uint64{packHTTPResponseV2(mod, resp)}
+}
+
+// HostHTTPSessionClose releases a session
+// Returns: 0 on success, 1 if the session ID is unknown
+func HostHTTPSessionClose(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+	state := httpStateFor(mod)
+	state.mu.Lock()
+	defer state.mu.Unlock()
+	session, ok := state.sessions[id]
+	if !ok {
+		return []uint64{1}
+	}
+	delete(state.sessions, id)
+	session.close()
+	return []uint64{0}
+}
@@ -0,0 +1,157 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"net"
+	"net/http"
+	"net/http/httptest"
+	"sync/atomic"
+	"testing"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// testWorkerModule is a module whose memory holds buf at offset 0
+type testWorkerModule struct {
+	wazeroapi.Module
+	memory *testWorkerMemory
+}
+
+type testWorkerMemory struct {
+	wazeroapi.Memory
+	buf []byte
+}
+
+func (m *testWorkerModule) Memory() wazeroapi.Memory { return m.memory }
+
+func (m *testWorkerMemory) Read(offset, count uint32) ([]byte, bool) {
+	if uint64(offset)+uint64(count) > uint64(len(m.buf)) {
+		return nil, false
+	}
+	return m.buf[offset : offset+count], true
+}
+
+func encodeTestHTTPSessionConfig(baseURL string, timeout uint32, headers [][2]string) []byte {
+	var buf []byte
+	buf = appendHTTPString(buf, baseURL)
+	buf = binary.LittleEndian.AppendUint32(buf, timeout)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(headers)))
+	for _, h := range headers {
+		buf = appendHTTPString(buf, h[0])
+		buf = appendHTTPString(buf, h[1])
+	}
+	return buf
+}
+
+func TestHTTPSessionReusesConnections(t *testing.T) {
+	var conns int32
+	server := httptest.NewUnstartedServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("X-Path", r.URL.Path)
+		w.Write([]byte(r.Header.Get("Authorization") + "|" + r.Header.Get("Accept")))
+	}))
+	server.Config.ConnState = func(_ net.Conn, state http.ConnState) {
+		if state == http.StateNew {
+			atomic.AddInt32(&conns, 1)
+		}
+	}
+	server.Start()
+	defer server.Close()
+
+	session, err := decodeHTTPSessionConfig(encodeTestHTTPSessionConfig(server.URL+"/v1/", 5, [][2]string{
+		{"Authorization", "token"},
+		{"Accept", "text/plain"},
+	}))
+	if err != nil {
+		t.Fatalf("decode: %v", err)
+	}
+	defer session.close()
+
+	for i := 0; i < 5; i++ {
+		resp := session.do(context.Background(), &HTTPRequest{
+			Method:  "GET",
+			URL:     "/items",
+			Headers: map[string]string{"Accept": "application/json"},
+		})
+		if resp.Error != "" {
+			t.Fatalf("request %d: %s", i, resp.Error)
+		}
+		if resp.Headers["X-Path"] != "/v1/items" || string(resp.Body) != "token|application/json" {
+			t.Fatalf("unexpected response: path=%q body=%q", resp.Headers["X-Path"], resp.Body)
+		}
+	}
+	if n := atomic.LoadInt32(&conns); n != 1 {
+		t.Fatalf("opened %d connections, want 1", n)
+	}
+}
+
+func TestDecodeHTTPSessionConfigRejectsRelativeBase(t *testing.T) {
+	if _, err := decodeHTTPSessionConfig(encodeTestHTTPSessionConfig("/relative", 0, nil)); err == nil {
+		t.Fatalf("expected an error for a relative base URL")
+	}
+}
+
+func TestHTTPSessionTransportsAreReleased(t *testing.T) {
+	config := encodeTestHTTPSessionConfig("http://transport-refs.invalid/api", 0, nil)
+	first, err := decodeHTTPSessionConfig(config)
+	if err != nil {
+		t.Fatalf("decode: %v", err)
+	}
+	second, err := decodeHTTPSessionConfig(config)
+	if err != nil {
+		t.Fatalf("decode: %v", err)
+	}
+	if first.client.Transport != second.client.Transport {
+		t.Fatalf("sessions to one origin should share a transport")
+	}
+
+	origin := "http://transport-refs.invalid"
+	first.close()
+	sessionTransportsMu.Lock()
+	shared := sessionTransports[origin]
+	sessionTransportsMu.Unlock()
+	if shared == nil || shared.refs != 1 {
+		t.Fatalf("transport released while a session still uses it: %+v", shared)
+	}
+
+	second.close()
+	sessionTransportsMu.Lock()
+	_, ok := sessionTransports[origin]
+	sessionTransportsMu.Unlock()
+	if ok {
+		t.Fatalf("transport kept after the last session closed")
+	}
+}
+
+func TestHTTPSessionIsSharedByThreadedWorkers(t *testing.T) {
+	config := encodeTestHTTPSessionConfig("http://shared-workers.invalid/api", 0, nil)
+	memory := &testWorkerMemory{buf: config}
+	owner := &testWorkerModule{memory: memory}
+	first := &testWorkerModule{memory: memory}
+	second := &testWorkerModule{memory: memory}
+	ShareHostHTTPState(first, owner)
+	ShareHostHTTPState(second, owner)
+	defer ReleaseHostHTTPState(owner)
+
+	id := uint32(HostHTTPSessionOpen(context.Background(), first, []uint64{0, uint64(len(config))})[0])
+	if id == 0 {
+		t.Fatalf("session open failed")
+	}
+	state := httpStateFor(second)
+	state.mu.Lock()
+	_, ok := state.sessions[id]
+	state.mu.Unlock()
+	if !ok {
+		t.Fatalf("session %d opened on one worker is unknown to the other", id)
+	}
+
+	// Recycling the worker that opened the session keeps it open
+	UnshareHostHTTPState(first)
+	if _, ok := hostHTTPStates.Load(owner); !ok {
+		t.Fatalf("shared state released with a worker")
+	}
+	if got := HostHTTPSessionClose(context.Background(), second, []uint64{uint64(id)})[0]; got != 0 {
+		t.Fatalf("closing the session from the other worker returned %d", got)
+	}
+	UnshareHostHTTPState(second)
+}
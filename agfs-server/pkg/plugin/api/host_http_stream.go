@@ -0,0 +1,157 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"errors"
+	"io"
+	"net/http"
+	"time"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// hostHTTPStream is a response whose body is read incrementally by the plugin
+type hostHTTPStream struct {
+	resp   *http.Response
+	cancel context.CancelFunc
+}
+
+func (st *hostHTTPStream) close() {
+	st.resp.Body.Close()
+	st.cancel()
+}
+
+// openHTTPStream sends req and returns once the response headers arrive
+// The request timeout covers only the wait for headers; the body can then be
+// read for as long as the plugin keeps the stream open.
+func openHTTPStream(req *HTTPRequest) (*hostHTTPStream, *HTTPResponse) {
+	if req.Method == "" {
+		req.Method = "GET"
+	}
+	timeout := time.Duration(req.Timeout) * time.Second
+	if timeout == 0 {
+		timeout = 30 * time.Second // default 30s timeout
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	httpReq, err := newHTTPRequest(ctx, req)
+	if err != nil {
+		cancel()
+		return nil, &HTTPResponse{Error: "failed to create request: " + err.Error()}
+	}
+
+	timer := time.AfterFunc(timeout, cancel)
+	httpResp, err := http.DefaultClient.Do(httpReq)
+	if !timer.Stop() || err != nil {
+		cancel()
+		if err == nil {
+			httpResp.Body.Close()
+			err = context.DeadlineExceeded
+		}
+		return nil, &HTTPResponse{Error: "request failed: " + err.Error()}
+	}
+
+	return &hostHTTPStream{resp: httpResp, cancel: cancel}, &HTTPResponse{
+		StatusCode: httpResp.StatusCode,
+		Headers:    flattenHTTPHeaders(httpResp.Header),
+	}
+}
+
+// HostHTTPStreamOpen starts a streaming HTTP request
+// Parameters are the same as HostHTTPRequestV2.
+// Returns: packed u64 (lower 32 bits = buffer pointer, upper 32 bits = buffer size)
+// where the buffer is u32 stream_id (0 on failure) followed by a binary
+// response with an empty body.
+func HostHTTPStreamOpen(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	var id uint32
+	var resp *HTTPResponse
+
+	req, err := readHTTPRequestV2(mod, uint32(params[0]), uint32(params[1]), uint32(params[2]), uint32(params[3]))
+	if err != nil {
+		log.Errorf("host_http_stream_open: %v", err)
+		resp = &HTTPResponse{Error: "failed to parse request: " + err.Error()}
+	} else {
+		log.Debugf("host_http_stream_open: method=%s, url=%s", req.Method, req.URL)
+		var stream *hostHTTPStream
+		stream, resp = openHTTPStream(req)
+		if stream != nil {
+			state := httpStateFor(mod)
+			state.mu.Lock()
+			id = state.allocID()
+			state.streams[id] = stream
+			state.mu.Unlock()
+		}
+	}
+
+	encoded := binary.LittleEndian.AppendUint32(nil, id)
+	encoded = append(encoded, encodeHTTPResponse(resp)...)
+	ptr, _, err := writeBytesToMemory(mod, encoded)
+	if err != nil {
+		log.Errorf("host_http_stream_open: failed to write response to memory: %v", err)
+		if id != 0 {
+			closeHTTPStream(mod, id)
+		}
+		return []uint64{0}
+	}
+	return []uint64{uint64(ptr) | (uint64(len(encoded)) << 32)}
+}
+
+// HostHTTPStreamRead reads the next part of a stream's body into WASM memory
+// Parameters:
+//   - params[0]: stream ID
+//   - params[1], params[2]: destination pointer and capacity
+//
+// Returns: bytes read (fills the buffer unless the body ends), 0 at end of body, -1 on error
+func HostHTTPStreamRead(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+	bufPtr := uint32(params[1])
+	bufLen := uint32(params[2])
+
+	state := httpStateFor(mod)
+	state.mu.Lock()
+	stream := state.streams[id]
+	state.mu.Unlock()
+	if stream == nil {
+		log.Errorf("host_http_stream_read: unknown stream %d", id)
+		return []uint64{^uint64(0)}
+	}
+
+	// Read straight into the plugin's buffer
+	dst, ok := mod.Memory().Read(bufPtr, bufLen)
+	if !ok {
+		log.Errorf("host_http_stream_read: invalid buffer")
+		return []uint64{^uint64(0)}
+	}
+	n, err := io.ReadFull(stream.resp.Body, dst)
+	if err != nil && !errors.Is(err, io.EOF) && !errors.Is(err, io.ErrUnexpectedEOF) {
+		log.Errorf("host_http_stream_read: %v", err)
+		if n == 0 {
+			return []uint64{^uint64(0)}
+		}
+	}
+	return []uint64{uint64(n)}
+}
+
+// HostHTTPStreamClose releases a stream
+// Returns: 0 on success, 1 if the stream ID is unknown
+func HostHTTPStreamClose(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	if !closeHTTPStream(mod, uint32(params[0])) {
+		return []uint64{1}
+	}
+	return []uint64{0}
+}
+
+func closeHTTPStream(mod wazeroapi.Module, id uint32) bool {
+	state := httpStateFor(mod)
+	state.mu.Lock()
+	stream := state.streams[id]
+	delete(state.streams, id)
+	state.mu.Unlock()
+	if stream == nil {
+		return false
+	}
+	stream.close()
+	return true
+}
@@ -0,0 +1,54 @@
+package api
+
+import (
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+	"time"
+)
+
+func TestOpenHTTPStream(t *testing.T) {
+	body := strings.Repeat("0123456789", 1000)
+	server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		if r.Header.Get("Range") != "bytes=0-" {
+			t.Errorf("Range header = %q", r.Header.Get("Range"))
+		}
+		w.Header().Set("X-Test", "yes")
+		w.WriteHeader(http.StatusPartialContent)
+		w.(http.Flusher).Flush()
+		// Outlive the header timeout before sending the body
+		time.Sleep(1500 * time.Millisecond)
+		io.WriteString(w, body)
+	}))
+	defer server.Close()
+
+	stream, resp := openHTTPStream(&HTTPRequest{
+		URL:     server.URL,
+		Headers: map[string]string{"Range": "bytes=0-"},
+		Timeout: 1,
+	})
+	if stream == nil {
+		t.Fatalf("open failed: %s", resp.Error)
+	}
+	defer stream.close()
+
+	if resp.StatusCode != http.StatusPartialContent || resp.Headers["X-Test"] != "yes" {
+		t.Fatalf("unexpected response head: %+v", resp)
+	}
+	got, err := io.ReadAll(stream.resp.Body)
+	if err != nil {
+		t.Fatalf("read body: %v", err)
+	}
+	if string(got) != body {
+		t.Fatalf("body length = %d, want %d", len(got), len(body))
+	}
+}
+
+func TestOpenHTTPStreamError(t *testing.T) {
+	stream, resp := openHTTPStream(&HTTPRequest{Method: "GET", URL: "://bad"})
+	if stream != nil || resp.Error == "" {
+		t.Fatalf("expected an error response, got %+v", resp)
+	}
+}
@@ -0,0 +1,176 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"fmt"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Binary HTTP encoding used by host_http_request_v2
+//
+// Request header (little-endian), the body is passed as a separate pointer/length:
+//
+//	u32 method_len + method, u32 url_len + url, u32 timeout (seconds),
+//	u32 header_count, then header_count × (u32 key_len + key, u32 value_len + value)
+//
+// Response:
+//
+//	u32 status_code, u32 error_len + error,
+//	u32 header_count, then header_count × (u32 key_len + key, u32 value_len + value),
+//	u32 body_len + body
+
+// httpCodecReader is a bounds-checked cursor over an encoded buffer
+// It also decodes the plugin_get_metrics buffer, which uses the same framing.
+type httpCodecReader struct {
+	buf []byte
+	err error
+}
+
+func (r *httpCodecReader) u32() uint32 {
+	if r.err != nil {
+		return 0
+	}
+	if len(r.buf) < 4 {
+		r.err = fmt.Errorf("buffer truncated")
+		return 0
+	}
+	v := binary.LittleEndian.Uint32(r.buf)
+	r.buf = r.buf[4:]
+	return v
+}
+
+func (r *httpCodecReader) u64() uint64 {
+	if r.err != nil {
+		return 0
+	}
+	if len(r.buf) < 8 {
+		r.err = fmt.Errorf("buffer truncated")
+		return 0
+	}
+	v := binary.LittleEndian.Uint64(r.buf)
+	r.buf = r.buf[8:]
+	return v
+}
+
+func (r *httpCodecReader) bytes() []byte {
+	n := r.u32()
+	if r.err != nil {
+		return nil
+	}
+	if uint32(len(r.buf)) < n {
+		r.err = fmt.Errorf("buffer truncated")
+		return nil
+	}
+	v := r.buf[:n]
+	r.buf = r.buf[n:]
+	return v
+}
+
+func (r *httpCodecReader) str() string {
+	return string(r.bytes())
+}
+
+// decodeHTTPRequestHeader decodes a binary request header (everything but the body)
+func decodeHTTPRequestHeader(buf []byte) (*HTTPRequest, error) {
+	r := &httpCodecReader{buf: buf}
+	req := &HTTPRequest{}
+	req.Method = r.str()
+	req.URL = r.str()
+	req.Timeout = int(r.u32())
+	count := r.u32()
+	if r.err == nil && count > 0 {
+		req.Headers = make(map[string]string, count)
+		for i := uint32(0); i < count && r.err == nil; i++ {
+			key := r.str()
+			req.Headers[key] = r.str()
+		}
+	}
+	if r.err != nil {
+		return nil, r.err
+	}
+	return req, nil
+}
+
+func appendHTTPBytes(buf []byte, v []byte) []byte {
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(v)))
+	return append(buf, v...)
+}
+
+func appendHTTPString(buf []byte, v string) []byte {
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(v)))
+	return append(buf, v...)
+}
+
+// encodeHTTPResponse encodes resp in the binary response layout
+func encodeHTTPResponse(resp *HTTPResponse) []byte {
+	size := 16 + len(resp.Error) + len(resp.Body)
+	for key, value := range resp.Headers {
+		size += 8 + len(key) + len(value)
+	}
+
+	buf := make([]byte, 0, size)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(resp.StatusCode))
+	buf = appendHTTPString(buf, resp.Error)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(resp.Headers)))
+	for key, value := range resp.Headers {
+		buf = appendHTTPString(buf, key)
+		buf = appendHTTPString(buf, value)
+	}
+	return appendHTTPBytes(buf, resp.Body)
+}
+
+// readHTTPRequestV2 decodes a binary request header and copies its body out of WASM memory
+func readHTTPRequestV2(mod wazeroapi.Module, reqPtr, reqLen, bodyPtr, bodyLen uint32) (*HTTPRequest, error) {
+	mem := mod.Memory()
+	header, ok := mem.Read(reqPtr, reqLen)
+	if !ok {
+		return nil, fmt.Errorf("failed to read request from memory")
+	}
+	req, err := decodeHTTPRequestHeader(header)
+	if err != nil {
+		return nil, err
+	}
+	if bodyLen > 0 {
+		body, ok := mem.Read(bodyPtr, bodyLen)
+		if !ok {
+			return nil, fmt.Errorf("failed to read request body from memory")
+		}
+		req.Body = make([]byte, len(body))
+		copy(req.Body, body)
+	}
+	return req, nil
+}
+
+// packHTTPResponseV2 writes a binary response to WASM memory
+// Returns: packed u64 (lower 32 bits = response pointer, upper 32 bits = response size)
+func packHTTPResponseV2(mod wazeroapi.Module, resp *HTTPResponse) uint64 {
+	encoded := encodeHTTPResponse(resp)
+	respPtr, _, err := writeBytesToMemory(mod, encoded)
+	if err != nil {
+		log.Errorf("packHTTPResponseV2: failed to write response to memory: %v", err)
+		return 0
+	}
+	return uint64(respPtr) | (uint64(len(encoded)) << 32)
+}
+
+// HostHTTPRequestV2 performs an HTTP request described by a binary header
+// Parameters:
+//   - params[0], params[1]: pointer and length of the encoded request header
+//   - params[2], params[3]: pointer and length of the raw request body
+//
+// Returns: packed u64 (lower 32 bits = response pointer, upper 32 bits = response size)
+func HostHTTPRequestV2(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	req, err := readHTTPRequestV2(mod, uint32(params[0]), uint32(params[1]), uint32(params[2]), uint32(params[3]))
+	if err != nil {
+		log.Errorf("host_http_request_v2: %v", err)
+		return []uint64{packHTTPResponseV2(mod, &HTTPResponse{Error: "failed to parse request: " + err.Error()})}
+	}
+
+	log.Debugf("host_http_request_v2: method=%s, url=%s, bodyLen=%d", req.Method, req.URL, len(req.Body))
+
+	resp := doHTTPRequest(ctx, nil, req)
+	return []uint64{packHTTPResponseV2(mod, resp)}
+}
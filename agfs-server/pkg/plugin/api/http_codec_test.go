@@ -0,0 +1,60 @@
+package api
+
+import (
+	"encoding/binary"
+	"testing"
+)
+
+func encodeTestHTTPRequestHeader(method, url string, timeout uint32, headers [][2]string) []byte {
+	var buf []byte
+	buf = appendHTTPString(buf, method)
+	buf = appendHTTPString(buf, url)
+	buf = binary.LittleEndian.AppendUint32(buf, timeout)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(headers)))
+	for _, h := range headers {
+		buf = appendHTTPString(buf, h[0])
+		buf = appendHTTPString(buf, h[1])
+	}
+	return buf
+}
+
+func TestDecodeHTTPRequestHeader(t *testing.T) {
+	buf := encodeTestHTTPRequestHeader("PUT", "https://example.com/obj", 15, [][2]string{{"Content-Type", "application/octet-stream"}})
+	req, err := decodeHTTPRequestHeader(buf)
+	if err != nil {
+		t.Fatalf("decode: %v", err)
+	}
+	if req.Method != "PUT" || req.URL != "https://example.com/obj" || req.Timeout != 15 {
+		t.Fatalf("unexpected request: %+v", req)
+	}
+	if req.Headers["Content-Type"] != "application/octet-stream" {
+		t.Fatalf("unexpected headers: %v", req.Headers)
+	}
+
+	if _, err := decodeHTTPRequestHeader(buf[:len(buf)-3]); err == nil {
+		t.Fatalf("expected error for truncated header")
+	}
+}
+
+func TestEncodeHTTPResponse(t *testing.T) {
+	resp := &HTTPResponse{StatusCode: 200, Headers: map[string]string{"Etag": "abc"}, Body: []byte{0, 1, 2, 255}}
+	r := &httpCodecReader{buf: encodeHTTPResponse(resp)}
+	if status := r.u32(); status != 200 {
+		t.Fatalf("status = %d", status)
+	}
+	if e := r.str(); e != "" {
+		t.Fatalf("error = %q", e)
+	}
+	if n := r.u32(); n != 1 {
+		t.Fatalf("header count = %d", n)
+	}
+	if k, v := r.str(), r.str(); k != "Etag" || v != "abc" {
+		t.Fatalf("header = %q: %q", k, v)
+	}
+	if body := r.bytes(); string(body) != string(resp.Body) {
+		t.Fatalf("body = %v", body)
+	}
+	if r.err != nil || len(r.buf) != 0 {
+		t.Fatalf("trailing data or error: %v, %d bytes", r.err, len(r.buf))
+	}
+}
@@ -0,0 +1,102 @@
+package api
+
+import (
+	"encoding/binary"
+	"fmt"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Packed iovec formats of the fs_readv / fs_writev exports
+//
+// Layouts (little-endian):
+//
+//	fs_readv request:  count x (i64 offset, i64 size)
+//	fs_readv result:   u32 total_len, u32 count, count x u32 bytes read,
+//	                   then the data of every range back to back
+//	fs_writev request: u32 count, then count x (i64 offset, u32 len, data)
+const (
+	readVRangeSize    = 16
+	readVHeaderSize   = 8
+	writeVSegmentHead = 12
+)
+
+// encodeReadVRequest packs ranges for fs_readv
+func encodeReadVRequest(ranges []filesystem.ReadRange) []byte {
+	buf := make([]byte, len(ranges)*readVRangeSize)
+	for i, r := range ranges {
+		binary.LittleEndian.PutUint64(buf[i*readVRangeSize:], uint64(r.Offset))
+		binary.LittleEndian.PutUint64(buf[i*readVRangeSize+8:], uint64(r.Size))
+	}
+	return buf
+}
+
+// encodeWriteVRequest packs segments for fs_writev
+func encodeWriteVRequest(segments []filesystem.WriteSegment) []byte {
+	size := 4
+	for _, seg := range segments {
+		size += writeVSegmentHead + len(seg.Data)
+	}
+	buf := make([]byte, size)
+	binary.LittleEndian.PutUint32(buf, uint32(len(segments)))
+	at := 4
+	for _, seg := range segments {
+		binary.LittleEndian.PutUint64(buf[at:], uint64(seg.Offset))
+		binary.LittleEndian.PutUint32(buf[at+8:], uint32(len(seg.Data)))
+		at += writeVSegmentHead
+		at += copy(buf[at:], seg.Data)
+	}
+	return buf
+}
+
+// readReadVResult copies an fs_readv result buffer out of WASM memory
+func readReadVResult(module wazeroapi.Module, ptr uint32) ([]byte, bool) {
+	mem := module.Memory()
+	if mem == nil {
+		return nil, false
+	}
+	total, ok := mem.ReadUint32Le(ptr)
+	if !ok || total < readVHeaderSize {
+		return nil, false
+	}
+	view, ok := mem.Read(ptr, total)
+	if !ok {
+		return nil, false
+	}
+	buf := make([]byte, len(view))
+	copy(buf, view)
+	return buf, true
+}
+
+// decodeReadVResult splits an fs_readv result into one slice per range
+// The slices share buf.
+func decodeReadVResult(buf []byte, ranges int) ([][]byte, error) {
+	if len(buf) < readVHeaderSize {
+		return nil, fmt.Errorf("readv buffer too short: %d bytes", len(buf))
+	}
+	total := binary.LittleEndian.Uint32(buf[0:4])
+	count := binary.LittleEndian.Uint32(buf[4:8])
+	if int(total) > len(buf) {
+		return nil, fmt.Errorf("readv buffer truncated: header says %d bytes, have %d", total, len(buf))
+	}
+	if int(count) != ranges {
+		return nil, fmt.Errorf("readv returned %d ranges, want %d", count, ranges)
+	}
+	buf = buf[:total]
+
+	at := readVHeaderSize + 4*int(count)
+	if at > len(buf) {
+		return nil, fmt.Errorf("readv buffer truncated in lengths")
+	}
+	out := make([][]byte, count)
+	for i := range out {
+		n := int(binary.LittleEndian.Uint32(buf[readVHeaderSize+4*i:]))
+		if n > len(buf)-at {
+			return nil, fmt.Errorf("readv range %d truncated", i)
+		}
+		out[i] = buf[at : at+n : at+n]
+		at += n
+	}
+	return out, nil
+}
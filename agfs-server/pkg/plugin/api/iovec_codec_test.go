@@ -0,0 +1,86 @@
+package api
+
+import (
+	"bytes"
+	"encoding/binary"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+// encodeReadVResult mirrors the fs_readv result layout of the C++ SDK
+func encodeReadVResult(chunks ...[]byte) []byte {
+	var body []byte
+	lens := []byte{}
+	for _, c := range chunks {
+		lens = binary.LittleEndian.AppendUint32(lens, uint32(len(c)))
+		body = append(body, c...)
+	}
+	buf := binary.LittleEndian.AppendUint32(nil, uint32(readVHeaderSize+len(lens)+len(body)))
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(chunks)))
+	buf = append(buf, lens...)
+	return append(buf, body...)
+}
+
+func TestEncodeReadVRequest(t *testing.T) {
+	buf := encodeReadVRequest([]filesystem.ReadRange{{Offset: 0, Size: 131072}, {Offset: 131072, Size: 7}})
+	if len(buf) != 2*readVRangeSize {
+		t.Fatalf("expected %d bytes, got %d", 2*readVRangeSize, len(buf))
+	}
+	if off := binary.LittleEndian.Uint64(buf[16:]); off != 131072 {
+		t.Errorf("unexpected second offset %d", off)
+	}
+	if size := binary.LittleEndian.Uint64(buf[24:]); size != 7 {
+		t.Errorf("unexpected second size %d", size)
+	}
+}
+
+func TestEncodeWriteVRequest(t *testing.T) {
+	buf := encodeWriteVRequest([]filesystem.WriteSegment{
+		{Offset: 10, Data: []byte("abc")},
+		{Offset: -1, Data: nil},
+	})
+	want := binary.LittleEndian.AppendUint32(nil, 2)
+	want = binary.LittleEndian.AppendUint64(want, 10)
+	want = binary.LittleEndian.AppendUint32(want, 3)
+	want = append(want, "abc"...)
+	want = binary.LittleEndian.AppendUint64(want, ^uint64(0))
+	want = binary.LittleEndian.AppendUint32(want, 0)
+	if !bytes.Equal(buf, want) {
+		t.Errorf("unexpected encoding\n got %v\nwant %v", buf, want)
+	}
+}
+
+func TestDecodeReadVResult(t *testing.T) {
+	// A short second range (end of file) and an empty third one
+	out, err := decodeReadVResult(encodeReadVResult([]byte("hello"), []byte("wo"), nil), 3)
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if len(out) != 3 || string(out[0]) != "hello" || string(out[1]) != "wo" || len(out[2]) != 0 {
+		t.Errorf("unexpected ranges: %q", out)
+	}
+
+	// Appending to one range must not overwrite the next
+	_ = append(out[0], 'X')
+	if string(out[1]) != "wo" {
+		t.Errorf("ranges alias each other: %q", out[1])
+	}
+}
+
+func TestDecodeReadVResultMalformed(t *testing.T) {
+	buf := encodeReadVResult([]byte("hello"), []byte("world"))
+
+	if _, err := decodeReadVResult(buf, 3); err == nil {
+		t.Error("expected error for range count mismatch")
+	}
+	if _, err := decodeReadVResult(buf[:len(buf)-1], 2); err == nil {
+		t.Error("expected error for truncated buffer")
+	}
+
+	// Length table claims more data than the buffer holds
+	binary.LittleEndian.PutUint32(buf[readVHeaderSize+4:], 6)
+	if _, err := decodeReadVResult(buf, 2); err == nil {
+		t.Error("expected error for oversized range")
+	}
+}
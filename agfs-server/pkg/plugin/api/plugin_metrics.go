@@ -0,0 +1,185 @@
+package api
+
+import (
+	"context"
+	"fmt"
+	"math"
+	"sort"
+	"time"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// pluginMetricsVersion is the only plugin_get_metrics layout understood here
+const pluginMetricsVersion = 1
+
+// PluginMetrics holds per-operation counters reported by a WASM plugin's
+// plugin_get_metrics export, keyed by operation name (fs_read, hostfs_stat, ...)
+type PluginMetrics struct {
+	Ops map[string]*OpMetrics `json:"ops"`
+}
+
+// OpMetrics is one operation's totals and latency histogram
+// Buckets[i] counts calls that took [2^i, 2^(i+1)) nanoseconds.
+type OpMetrics struct {
+	Count      uint64   `json:"count"`
+	TotalNanos uint64   `json:"total_ns"`
+	BytesIn    uint64   `json:"bytes_in"`
+	BytesOut   uint64   `json:"bytes_out"`
+	Buckets    []uint64 `json:"buckets"`
+}
+
+// NewPluginMetrics returns an empty metrics set
+func NewPluginMetrics() *PluginMetrics {
+	return &PluginMetrics{Ops: make(map[string]*OpMetrics)}
+}
+
+// decodePluginMetrics parses a plugin_get_metrics buffer
+// Layout (little-endian): u32 version, u32 op_count, then per op: u32 len +
+// name, u64 count, u64 total_ns, u64 bytes_in, u64 bytes_out, u32
+// bucket_count, bucket_count × (u32 index, u64 calls).
+func decodePluginMetrics(data []byte) (*PluginMetrics, error) {
+	r := &httpCodecReader{buf: data}
+	version := r.u32()
+	opCount := r.u32()
+	if r.err != nil {
+		return nil, fmt.Errorf("plugin metrics: %w", r.err)
+	}
+	if version != pluginMetricsVersion {
+		return nil, fmt.Errorf("plugin metrics: unsupported version %d", version)
+	}
+
+	m := NewPluginMetrics()
+	for i := uint32(0); i < opCount; i++ {
+		name := string(r.bytes())
+		op := &OpMetrics{
+			Count:      r.u64(),
+			TotalNanos: r.u64(),
+			BytesIn:    r.u64(),
+			BytesOut:   r.u64(),
+		}
+		bucketCount := r.u32()
+		for b := uint32(0); b < bucketCount && r.err == nil; b++ {
+			idx := r.u32()
+			n := r.u64()
+			if idx >= 64 {
+				return nil, fmt.Errorf("plugin metrics: bucket index %d out of range", idx)
+			}
+			for uint32(len(op.Buckets)) <= idx {
+				op.Buckets = append(op.Buckets, 0)
+			}
+			op.Buckets[idx] += n
+		}
+		if r.err != nil {
+			return nil, fmt.Errorf("plugin metrics: %w", r.err)
+		}
+		m.mergeOp(name, op)
+	}
+	return m, nil
+}
+
+// Merge adds other's counters into m
+func (m *PluginMetrics) Merge(other *PluginMetrics) {
+	if other == nil {
+		return
+	}
+	for name, op := range other.Ops {
+		m.mergeOp(name, op)
+	}
+}
+
+func (m *PluginMetrics) mergeOp(name string, op *OpMetrics) {
+	dst, ok := m.Ops[name]
+	if !ok {
+		dst = &OpMetrics{}
+		m.Ops[name] = dst
+	}
+	dst.Count += op.Count
+	dst.TotalNanos += op.TotalNanos
+	dst.BytesIn += op.BytesIn
+	dst.BytesOut += op.BytesOut
+	for len(dst.Buckets) < len(op.Buckets) {
+		dst.Buckets = append(dst.Buckets, 0)
+	}
+	for i, n := range op.Buckets {
+		dst.Buckets[i] += n
+	}
+}
+
+// Clone returns a deep copy of m
+func (m *PluginMetrics) Clone() *PluginMetrics {
+	c := NewPluginMetrics()
+	c.Merge(m)
+	return c
+}
+
+// Names returns the operation names in sorted order
+func (m *PluginMetrics) Names() []string {
+	names := make([]string, 0, len(m.Ops))
+	for name := range m.Ops {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	return names
+}
+
+// Mean returns the average latency
+func (op *OpMetrics) Mean() time.Duration {
+	if op.Count == 0 {
+		return 0
+	}
+	return time.Duration(op.TotalNanos / op.Count)
+}
+
+// Quantile estimates the q-th latency quantile (0 < q <= 1), interpolating
+// linearly inside the log2 bucket that holds it
+func (op *OpMetrics) Quantile(q float64) time.Duration {
+	var total uint64
+	for _, n := range op.Buckets {
+		total += n
+	}
+	if total == 0 {
+		return 0
+	}
+	rank := q * float64(total)
+	var seen float64
+	for i, n := range op.Buckets {
+		if n == 0 {
+			continue
+		}
+		if seen+float64(n) >= rank {
+			low := math.Ldexp(1, i)
+			frac := (rank - seen) / float64(n)
+			return time.Duration(low + frac*low)
+		}
+		seen += float64(n)
+	}
+	return time.Duration(math.Ldexp(1, len(op.Buckets)))
+}
+
+// collectModuleMetrics drains a module's plugin_get_metrics export
+// Returns nil when the plugin does not export it or was built without metrics.
+func collectModuleMetrics(ctx context.Context, module wazeroapi.Module) (*PluginMetrics, error) {
+	fn := module.ExportedFunction("plugin_get_metrics")
+	if fn == nil {
+		return nil, nil
+	}
+	results, err := fn.Call(ctx)
+	if err != nil {
+		return nil, fmt.Errorf("plugin_get_metrics failed: %w", err)
+	}
+	if len(results) < 1 || results[0] == 0 {
+		return nil, nil
+	}
+
+	// Unpack u64: lower 32 bits = pointer, upper 32 bits = size
+	ptr := uint32(results[0] & 0xFFFFFFFF)
+	size := uint32(results[0] >> 32)
+	defer freeWASMMemory(module, ptr, 0)
+
+	data, ok := module.Memory().Read(ptr, size)
+	if !ok {
+		return nil, fmt.Errorf("failed to read plugin metrics from memory")
+	}
+	return decodePluginMetrics(data)
+}
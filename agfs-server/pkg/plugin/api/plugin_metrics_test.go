@@ -0,0 +1,98 @@
+package api
+
+import (
+	"encoding/binary"
+	"testing"
+	"time"
+)
+
+type testOpMetrics struct {
+	name                              string
+	count, totalNs, bytesIn, bytesOut uint64
+	buckets                           map[uint32]uint64
+}
+
+func encodeTestPluginMetrics(ops []testOpMetrics) []byte {
+	var buf []byte
+	buf = binary.LittleEndian.AppendUint32(buf, pluginMetricsVersion)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(ops)))
+	for _, op := range ops {
+		buf = appendHTTPString(buf, op.name)
+		buf = binary.LittleEndian.AppendUint64(buf, op.count)
+		buf = binary.LittleEndian.AppendUint64(buf, op.totalNs)
+		buf = binary.LittleEndian.AppendUint64(buf, op.bytesIn)
+		buf = binary.LittleEndian.AppendUint64(buf, op.bytesOut)
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(len(op.buckets)))
+		for idx, n := range op.buckets {
+			buf = binary.LittleEndian.AppendUint32(buf, idx)
+			buf = binary.LittleEndian.AppendUint64(buf, n)
+		}
+	}
+	return buf
+}
+
+func TestDecodePluginMetrics(t *testing.T) {
+	buf := encodeTestPluginMetrics([]testOpMetrics{
+		{name: "fs_read", count: 4, totalNs: 4000, bytesOut: 400, buckets: map[uint32]uint64{9: 3, 12: 1}},
+		{name: "hostfs_stat", count: 1, totalNs: 70, buckets: map[uint32]uint64{6: 1}},
+	})
+	m, err := decodePluginMetrics(buf)
+	if err != nil {
+		t.Fatalf("decode: %v", err)
+	}
+	if names := m.Names(); len(names) != 2 || names[0] != "fs_read" || names[1] != "hostfs_stat" {
+		t.Fatalf("names = %v", names)
+	}
+	read := m.Ops["fs_read"]
+	if read.Count != 4 || read.TotalNanos != 4000 || read.BytesOut != 400 || read.BytesIn != 0 {
+		t.Fatalf("fs_read = %+v", read)
+	}
+	if len(read.Buckets) != 13 || read.Buckets[9] != 3 || read.Buckets[12] != 1 {
+		t.Fatalf("fs_read buckets = %v", read.Buckets)
+	}
+	if read.Mean() != time.Microsecond {
+		t.Fatalf("mean = %v", read.Mean())
+	}
+
+	if _, err := decodePluginMetrics(buf[:len(buf)-5]); err == nil {
+		t.Fatalf("expected error for truncated buffer")
+	}
+	bad := append([]byte(nil), buf...)
+	binary.LittleEndian.PutUint32(bad, 7)
+	if _, err := decodePluginMetrics(bad); err == nil {
+		t.Fatalf("expected error for unknown version")
+	}
+}
+
+func TestPluginMetricsMergeAndQuantile(t *testing.T) {
+	total := NewPluginMetrics()
+	for i := 0; i < 2; i++ {
+		m, err := decodePluginMetrics(encodeTestPluginMetrics([]testOpMetrics{
+			{name: "fs_write", count: 50, totalNs: 50 * 1500, bytesIn: 100, buckets: map[uint32]uint64{10: 45, 20: 5}},
+		}))
+		if err != nil {
+			t.Fatalf("decode: %v", err)
+		}
+		total.Merge(m)
+	}
+
+	op := total.Ops["fs_write"]
+	if op.Count != 100 || op.BytesIn != 200 || op.Buckets[10] != 90 || op.Buckets[20] != 10 {
+		t.Fatalf("merged = %+v", op)
+	}
+
+	// 90% of calls fall in [1024, 2048) ns, the rest in [2^20, 2^21) ns
+	if p50 := op.Quantile(0.5); p50 < 1024 || p50 >= 2048 {
+		t.Fatalf("p50 = %v", p50)
+	}
+	if p99 := op.Quantile(0.99); p99 < 1<<20 || p99 > 1<<21 {
+		t.Fatalf("p99 = %v", p99)
+	}
+
+	// Clones do not alias the source
+	c := total.Clone()
+	c.Ops["fs_write"].Buckets[10] = 0
+	if op.Buckets[10] != 90 {
+		t.Fatalf("clone aliases source buckets")
+	}
+}
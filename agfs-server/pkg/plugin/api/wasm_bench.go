@@ -0,0 +1,49 @@
+package api
+
+import (
+	"fmt"
+)
+
+// RunBenchmarks calls the plugin's bench_run export (see the C++ SDK's
+// bench/sdk_bench.cpp) and returns its JSON-lines report
+// filter selects benchmarks by substring; minTimeMs is the minimum run time
+// of each one (0 = plugin default).
+func (wp *WASMPlugin) RunBenchmarks(filter string, minTimeMs uint32) ([]byte, error) {
+	var report []byte
+	err := wp.instancePool.Execute(func(instance *WASMModuleInstance) error {
+		benchFunc := instance.module.ExportedFunction("bench_run")
+		if benchFunc == nil {
+			return fmt.Errorf("plugin does not export bench_run")
+		}
+
+		filterPtr, filterPtrSize, err := writeStringToMemory(instance.module, filter)
+		if err != nil {
+			return err
+		}
+		defer freeWASMMemory(instance.module, filterPtr, filterPtrSize)
+
+		results, err := benchFunc.Call(wp.instancePool.ctx, uint64(filterPtr), uint64(minTimeMs))
+		if err != nil {
+			return fmt.Errorf("bench_run failed: %w", err)
+		}
+		if len(results) < 1 || results[0] == 0 {
+			return nil
+		}
+
+		// Unpack u64: lower 32 bits = pointer, upper 32 bits = size
+		ptr := uint32(results[0] & 0xFFFFFFFF)
+		size := uint32(results[0] >> 32)
+		if ptr == 0 {
+			return fmt.Errorf("bench_run could not allocate its %d-byte report", size)
+		}
+		defer freeWASMMemory(instance.module, ptr, 0)
+
+		view, ok := instance.module.Memory().Read(ptr, size)
+		if !ok {
+			return fmt.Errorf("failed to read benchmark report from memory")
+		}
+		report = append([]byte(nil), view...)
+		return nil
+	})
+	return report, err
+}
@@ -4,6 +4,7 @@ import (
 	"context"
 	"fmt"
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
@@ -35,6 +36,20 @@ type WASMInstancePool struct {
 	mu               sync.Mutex
 	stats            PoolStats
 	closed           bool
+
+	// Plugin metrics drained from instances so far (see CollectMetrics)
+	metrics   *PluginMetrics
+	metricsMu sync.Mutex
+
+	// Last Initialize, replayed into instances that missed it (see restoreInitState)
+	initState *pluginInitState
+	initMu    sync.Mutex
+
+	// Set for threaded plugins, whose instances are workers over one shared memory
+	threads *threadSupport
+
+	tracer         atomic.Pointer[CallTracer] // see SetTracer
+	nextInstanceID atomic.Uint64
 }
 
 // PoolStats tracks pool usage statistics
@@ -48,12 +63,60 @@ type PoolStats struct {
 	mu             sync.Mutex
 }
 
+// maxInputSlots bounds SlotCount so slot usage fits in a uint32 bitmask
+const maxInputSlots = 32
+
 // SharedBufferInfo holds information about shared memory buffers
+// The input region is split into SlotCount slots of BufferSize bytes; each
+// argument written through it occupies one slot until it is freed, so several
+// arguments of the same call never overwrite each other.
 type SharedBufferInfo struct {
 	InputBufferPtr  uint32 // Pointer to input buffer (Go -> WASM)
 	OutputBufferPtr uint32 // Pointer to output buffer (WASM -> Go)
-	BufferSize      uint32 // Size of each buffer
+	BufferSize      uint32 // Size of each buffer (and of each input slot)
+	SlotCount       uint32 // Number of input slots (1 for plugins without get_shared_buffer_slots)
 	Enabled         bool   // Whether shared buffers are available
+
+	slotsInUse uint32 // Bitmask of input slots holding live arguments (accessed atomically)
+}
+
+// acquireInputSlot reserves a free input slot and returns its address
+func (b *SharedBufferInfo) acquireInputSlot() (uint32, bool) {
+	for {
+		used := atomic.LoadUint32(&b.slotsInUse)
+		slot := b.SlotCount
+		for i := uint32(0); i < b.SlotCount; i++ {
+			if used&(1<<i) == 0 {
+				slot = i
+				break
+			}
+		}
+		if slot == b.SlotCount {
+			return 0, false // all slots busy
+		}
+		if atomic.CompareAndSwapUint32(&b.slotsInUse, used, used|(1<<slot)) {
+			return b.InputBufferPtr + slot*b.BufferSize, true
+		}
+	}
+}
+
+// releaseInputSlot frees the slot starting at ptr
+// Returns false if ptr is not the start of an input slot.
+func (b *SharedBufferInfo) releaseInputSlot(ptr uint32) bool {
+	if ptr < b.InputBufferPtr || b.BufferSize == 0 {
+		return false
+	}
+	offset := ptr - b.InputBufferPtr
+	if offset%b.BufferSize != 0 || offset/b.BufferSize >= b.SlotCount {
+		return false
+	}
+	bit := uint32(1) << (offset / b.BufferSize)
+	for {
+		used := atomic.LoadUint32(&b.slotsInUse)
+		if atomic.CompareAndSwapUint32(&b.slotsInUse, used, used&^bit) {
+			return true
+		}
+	}
 }
 
 // WASMModuleInstance represents a single WASM module instance
@@ -64,6 +127,10 @@ type WASMModuleInstance struct {
 	createdAt    time.Time
 	requestCount int64 // Number of requests handled by this instance
 	mu           sync.Mutex
+
+	initGeneration uint64 // pluginInitState generation applied to this instance
+	threadBlock    uint32 // worker stack and TLS block of a threaded plugin
+	id             uint64 // pool-unique, reported in CallSpan
 }
 
 // NewWASMInstancePool creates a new WASM instance pool with configuration
@@ -129,7 +196,31 @@ func (p *WASMInstancePool) performHealthCheck() {
 }
 
 // Acquire gets an instance from the pool or creates a new one if available
+// Instances that have not seen the latest Initialize are brought up to date
+// before they are returned.
 func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
+	instance, err := p.acquire()
+	if err != nil {
+		return nil, err
+	}
+	if err := p.restoreInitState(instance); err != nil {
+		p.destroyInstance(instance)
+
+		p.mu.Lock()
+		p.currentInstances--
+		p.mu.Unlock()
+
+		p.stats.mu.Lock()
+		p.stats.TotalDestroyed++
+		p.stats.CurrentActive--
+		p.stats.FailedRequests++
+		p.stats.mu.Unlock()
+		return nil, err
+	}
+	return instance, nil
+}
+
+func (p *WASMInstancePool) acquire() (*WASMModuleInstance, error) {
 	// Check if pool is closed
 	p.mu.Lock()
 	if p.closed {
@@ -165,7 +256,7 @@ func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
 			}
 
 			// Create a new instance to replace the recycled one
-			return p.Acquire()
+			return p.acquire()
 		}
 
 		log.Debugf("Reusing WASM instance from pool for %s", p.pluginName)
@@ -257,7 +348,7 @@ func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
 			}
 
 			// Create a new instance to replace the recycled one
-			return p.Acquire()
+			return p.acquire()
 		}
 
 		// Increment request count for this instance
@@ -320,8 +411,16 @@ func (p *WASMInstancePool) Release(instance *WASMModuleInstance) {
 
 // createInstance creates a new WASM module instance
 func (p *WASMInstancePool) createInstance() (*WASMModuleInstance, error) {
+	if p.threads != nil {
+		return p.createWorker()
+	}
+
 	// Instantiate the compiled module
-	module, err := p.runtime.InstantiateModule(p.ctx, p.compiledModule, wazero.NewModuleConfig())
+	// Real clocks let plugins keep time-based caches (wazero fakes them by default)
+	config := wazero.NewModuleConfig().
+		WithSysNanotime().
+		WithSysWalltime()
+	module, err := p.runtime.InstantiateModule(p.ctx, p.compiledModule, config)
 	if err != nil {
 		return nil, fmt.Errorf("failed to instantiate WASM module: %w", err)
 	}
@@ -341,17 +440,20 @@ func (p *WASMInstancePool) createInstance() (*WASMModuleInstance, error) {
 		module:       module,
 		createdAt:    time.Now(),
 		sharedBuffer: sharedBuffer,
+		id:           p.nextInstanceID.Add(1),
 		fileSystem: &WASMFileSystem{
-			ctx:          p.ctx,
-			module:       module,
-			sharedBuffer: &sharedBuffer,
-			mu:           nil, // No mutex needed - each instance is single-threaded
+			ctx:    p.ctx,
+			module: module,
+			mu:     nil, // No mutex needed - each instance is single-threaded
 		},
 	}
 
+	// Share the instance's copy so slot bookkeeping is seen by every call
+	instance.fileSystem.sharedBuffer = &instance.sharedBuffer
+
 	if sharedBuffer.Enabled {
-		log.Debugf("Shared buffers enabled for %s: input=%d, output=%d, size=%d",
-			p.pluginName, sharedBuffer.InputBufferPtr, sharedBuffer.OutputBufferPtr, sharedBuffer.BufferSize)
+		log.Debugf("Shared buffers enabled for %s: input=%d, output=%d, size=%d, slots=%d",
+			p.pluginName, sharedBuffer.InputBufferPtr, sharedBuffer.OutputBufferPtr, sharedBuffer.BufferSize, sharedBuffer.SlotCount)
 	}
 
 	return instance, nil
@@ -394,8 +496,22 @@ func initializeSharedBuffer(module wazeroapi.Module, ctx context.Context) Shared
 	info.InputBufferPtr = uint32(inputResults[0])
 	info.OutputBufferPtr = uint32(outputResults[0])
 	info.BufferSize = uint32(sizeResults[0])
+	info.SlotCount = 1
 	info.Enabled = true
 
+	// Plugins built with a multi-slot input ring report how many slots it has
+	if getSlotsFunc := module.ExportedFunction("get_shared_buffer_slots"); getSlotsFunc != nil {
+		if slotResults, err := getSlotsFunc.Call(ctx); err == nil && len(slotResults) > 0 {
+			slots := uint32(slotResults[0])
+			if slots > maxInputSlots {
+				slots = maxInputSlots
+			}
+			if slots > 0 {
+				info.SlotCount = slots
+			}
+		}
+	}
+
 	return info
 }
 
@@ -404,13 +520,21 @@ func (p *WASMInstancePool) destroyInstance(instance *WASMModuleInstance) {
 	if instance == nil || instance.module == nil {
 		return
 	}
+	if p.threads != nil {
+		p.destroyWorker(instance)
+		return
+	}
+
+	// Keep the instance's unreported metrics before they are lost
+	p.drainMetrics(instance)
 
 	// Call plugin shutdown if available
 	if shutdownFunc := instance.module.ExportedFunction("plugin_shutdown"); shutdownFunc != nil {
 		shutdownFunc.Call(p.ctx)
 	}
 
-	// Close the module
+	// Release host-side resources (open HTTP streams) and close the module
+	ReleaseHostHTTPState(instance.module)
 	instance.module.Close(p.ctx)
 }
 
@@ -431,11 +555,66 @@ func (p *WASMInstancePool) Close() error {
 	for instance := range p.instances {
 		p.destroyInstance(instance)
 	}
+	if p.threads != nil {
+		p.threads.close(p.ctx)
+	}
 
 	log.Infof("Closed WASM instance pool for %s", p.pluginName)
 	return nil
 }
 
+// drainMetrics folds an instance's plugin_get_metrics counters into the pool total
+// Returns: The counters drained, nil if the plugin reports none
+func (p *WASMInstancePool) drainMetrics(instance *WASMModuleInstance) *PluginMetrics {
+	m, err := collectModuleMetrics(p.ctx, instance.module)
+	if err != nil {
+		log.Warnf("[Pool %s] %v", p.pluginName, err)
+		return nil
+	}
+	if m == nil {
+		return nil
+	}
+	p.metricsMu.Lock()
+	if p.metrics == nil {
+		p.metrics = NewPluginMetrics()
+	}
+	p.metrics.Merge(m)
+	p.metricsMu.Unlock()
+	return m
+}
+
+// CollectMetrics returns the plugin's cumulative metrics across all instances
+// Idle instances are drained now; busy ones report on a later call or when
+// they are destroyed. Returns nil if the plugin does not report metrics.
+func (p *WASMInstancePool) CollectMetrics() *PluginMetrics {
+	// Holding mu keeps Close from closing the channel while instances are out
+	p.mu.Lock()
+	if !p.closed {
+		idle := make([]*WASMModuleInstance, 0, len(p.instances))
+	drain:
+		for len(idle) < cap(idle) {
+			select {
+			case instance := <-p.instances:
+				idle = append(idle, instance)
+			default:
+				break drain
+			}
+		}
+		for _, instance := range idle {
+			p.drainMetrics(instance)
+			p.instances <- instance
+		}
+	}
+	p.mu.Unlock()
+
+	p.metricsMu.Lock()
+	defer p.metricsMu.Unlock()
+	if p.metrics == nil {
+		return nil
+	}
+	return p.metrics.Clone()
+}
+
 // GetStats returns the current pool statistics
 func (p *WASMInstancePool) GetStats() PoolStats {
 	p.stats.mu.Lock()
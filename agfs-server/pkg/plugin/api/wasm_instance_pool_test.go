@@ -0,0 +1,34 @@
+package api
+
+import "testing"
+
+func TestSharedBufferInputSlots(t *testing.T) {
+	b := &SharedBufferInfo{InputBufferPtr: 1024, BufferSize: 256, SlotCount: 2, Enabled: true}
+
+	first, ok := b.acquireInputSlot()
+	if !ok || first != 1024 {
+		t.Fatalf("first slot = %d, %v; want 1024, true", first, ok)
+	}
+	second, ok := b.acquireInputSlot()
+	if !ok || second != 1280 {
+		t.Fatalf("second slot = %d, %v; want 1280, true", second, ok)
+	}
+	if _, ok := b.acquireInputSlot(); ok {
+		t.Fatalf("expected all slots to be busy")
+	}
+
+	if b.releaseInputSlot(1100) {
+		t.Fatalf("released a pointer inside a slot")
+	}
+	if b.releaseInputSlot(1024 + 2*256) {
+		t.Fatalf("released a pointer past the last slot")
+	}
+	if !b.releaseInputSlot(first) {
+		t.Fatalf("failed to release first slot")
+	}
+
+	again, ok := b.acquireInputSlot()
+	if !ok || again != first {
+		t.Fatalf("reacquired slot = %d, %v; want %d, true", again, ok, first)
+	}
+}
@@ -112,49 +112,55 @@ func (wp *WASMPlugin) Validate(config map[string]interface{}) error {
 			return fmt.Errorf("validation failed")
 		}
 
-		return nil
+		return wp.checkSingleInstance(instance, configPtr)
 	})
 }
 
+// checkSingleInstance rejects configs under which the plugin keeps state every
+// call must see (plugin_single_instance) when the pool could send calls to
+// separate instances. Threaded plugins share one plugin between workers.
+func (wp *WASMPlugin) checkSingleInstance(instance *WASMModuleInstance, configPtr uint32) error {
+	singleFunc := instance.module.ExportedFunction("plugin_single_instance")
+	if singleFunc == nil || wp.instancePool.threads != nil || wp.instancePool.config.MaxInstances <= 1 {
+		return nil
+	}
+	results, err := singleFunc.Call(wp.instancePool.ctx, uint64(configPtr))
+	if err != nil {
+		return fmt.Errorf("plugin_single_instance call failed: %w", err)
+	}
+	if len(results) > 0 && uint32(results[0]) != 0 {
+		return fmt.Errorf("validation failed: this configuration keeps per-instance state (e.g. write_back_paths) "+
+			"and needs an instance pool size of 1 or a threaded build, not %d instances", wp.instancePool.config.MaxInstances)
+	}
+	return nil
+}
+
 // Initialize initializes the plugin with configuration
+// One instance runs plugin_initialize; if the plugin exports
+// plugin_export_state, its snapshot is what the pool restores into every
+// later instance, otherwise they re-run plugin_initialize with this config.
 func (wp *WASMPlugin) Initialize(config map[string]interface{}) error {
-	return wp.instancePool.Execute(func(instance *WASMModuleInstance) error {
-		initFunc := instance.module.ExportedFunction("plugin_initialize")
-		if initFunc == nil {
-			// If initialize function is not exported, assume initialization succeeds
-			return nil
-		}
+	// Convert config to JSON
+	configJSON, err := json.Marshal(config)
+	if err != nil {
+		return fmt.Errorf("failed to marshal config: %w", err)
+	}
 
-		// Convert config to JSON
-		configJSON, err := json.Marshal(config)
-		if err != nil {
-			return fmt.Errorf("failed to marshal config: %w", err)
+	return wp.instancePool.Execute(func(instance *WASMModuleInstance) error {
+		if err := callPluginInitialize(wp.instancePool.ctx, instance.module, configJSON); err != nil {
+			return err
 		}
 
-		// Write config to WASM memory
-		configPtr, configPtrSize, err := writeStringToMemory(instance.module, string(configJSON))
-		if err != nil {
-			return fmt.Errorf("failed to write config to memory: %w", err)
+		if wp.instancePool.threads != nil {
+			return nil // every worker shares the plugin just initialized
 		}
-		defer freeWASMMemory(instance.module, configPtr, configPtrSize)
 
-		// Call initialize function
-		results, err := initFunc.Call(wp.instancePool.ctx, uint64(configPtr))
+		state, err := exportPluginState(wp.instancePool.ctx, instance.module)
 		if err != nil {
-			return fmt.Errorf("initialize call failed: %w", err)
-		}
-
-		// Check for error return
-		if len(results) > 0 && results[0] != 0 {
-			errPtr := uint32(results[0])
-			if errMsg, ok := readStringFromMemory(instance.module, errPtr); ok {
-				freeWASMMemory(instance.module, errPtr, 0)
-				return fmt.Errorf("initialization failed: %s", errMsg)
-			}
-			freeWASMMemory(instance.module, errPtr, 0)
-			return fmt.Errorf("initialization failed")
+			log.Warnf("Failed to export plugin state, new instances will run plugin_initialize: %v", err)
+			state = nil
 		}
-
+		wp.instancePool.setInitState(instance, configJSON, state)
 		return nil
 	})
 }
@@ -234,6 +240,22 @@ func (wp *WASMPlugin) GetConfigParams() []plugin.ConfigParameter {
 	return params
 }
 
+// PluginMetrics returns the plugin's cumulative per-operation metrics, or nil
+// if it was built without them (see plugin_get_metrics)
+func (wp *WASMPlugin) PluginMetrics() *PluginMetrics {
+	return wp.instancePool.CollectMetrics()
+}
+
+// SetTracer reports every FileSystem call to t as a CallSpan; nil stops tracing
+func (wp *WASMPlugin) SetTracer(t CallTracer) {
+	wp.instancePool.SetTracer(t)
+}
+
+// PoolStats returns the instance pool's counters
+func (wp *WASMPlugin) PoolStats() PoolStats {
+	return wp.instancePool.GetStats()
+}
+
 // Shutdown shuts down the plugin
 func (wp *WASMPlugin) Shutdown() error {
 	// Close the instance pool
@@ -244,32 +266,32 @@ func (wp *WASMPlugin) Shutdown() error {
 // All methods delegate to the instance pool
 
 func (pfs *PooledWASMFileSystem) Create(path string) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("create", path, func(fs *WASMFileSystem) error {
 		return fs.Create(path)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) Mkdir(path string, perm uint32) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("mkdir", path, func(fs *WASMFileSystem) error {
 		return fs.Mkdir(path, perm)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) Remove(path string) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("remove", path, func(fs *WASMFileSystem) error {
 		return fs.Remove(path)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) RemoveAll(path string) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("remove_all", path, func(fs *WASMFileSystem) error {
 		return fs.RemoveAll(path)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) Read(path string, offset int64, size int64) ([]byte, error) {
 	var data []byte
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("read", path, func(fs *WASMFileSystem) error {
 		var readErr error
 		data, readErr = fs.Read(path, offset, size)
 		return readErr
@@ -279,7 +301,7 @@ func (pfs *PooledWASMFileSystem) Read(path string, offset int64, size int64) ([]
 
 func (pfs *PooledWASMFileSystem) Write(path string, data []byte, offset int64, flags filesystem.WriteFlag) (int64, error) {
 	var bytesWritten int64
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("write", path, func(fs *WASMFileSystem) error {
 		var writeErr error
 		bytesWritten, writeErr = fs.Write(path, data, offset, flags)
 		return writeErr
@@ -287,9 +309,31 @@ func (pfs *PooledWASMFileSystem) Write(path string, data []byte, offset int64, f
 	return bytesWritten, err
 }
 
+// ReadV reads several ranges of one file (see WASMFileSystem.ReadV)
+func (pfs *PooledWASMFileSystem) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	var data [][]byte
+	err := pfs.pool.executeOp("readv", path, func(fs *WASMFileSystem) error {
+		var readErr error
+		data, readErr = fs.ReadV(path, ranges)
+		return readErr
+	})
+	return data, err
+}
+
+// WriteV writes several ranges of one file (see WASMFileSystem.WriteV)
+func (pfs *PooledWASMFileSystem) WriteV(path string, segments []filesystem.WriteSegment, flags filesystem.WriteFlag) (int64, error) {
+	var bytesWritten int64
+	err := pfs.pool.executeOp("writev", path, func(fs *WASMFileSystem) error {
+		var writeErr error
+		bytesWritten, writeErr = fs.WriteV(path, segments, flags)
+		return writeErr
+	})
+	return bytesWritten, err
+}
+
 func (pfs *PooledWASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
 	var infos []filesystem.FileInfo
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("readdir", path, func(fs *WASMFileSystem) error {
 		var readErr error
 		infos, readErr = fs.ReadDir(path)
 		return readErr
@@ -297,9 +341,21 @@ func (pfs *PooledWASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, er
 	return infos, err
 }
 
+// ReadDirPage lists one page of a directory (see WASMFileSystem.ReadDirPage)
+func (pfs *PooledWASMFileSystem) ReadDirPage(path string, cursor string, maxEntries int) ([]filesystem.FileInfo, string, error) {
+	var infos []filesystem.FileInfo
+	var next string
+	err := pfs.pool.executeOp("readdir_page", path, func(fs *WASMFileSystem) error {
+		var readErr error
+		infos, next, readErr = fs.ReadDirPage(path, cursor, maxEntries)
+		return readErr
+	})
+	return infos, next, err
+}
+
 func (pfs *PooledWASMFileSystem) Stat(path string) (*filesystem.FileInfo, error) {
 	var info *filesystem.FileInfo
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("stat", path, func(fs *WASMFileSystem) error {
 		var statErr error
 		info, statErr = fs.Stat(path)
 		return statErr
@@ -308,20 +364,20 @@ func (pfs *PooledWASMFileSystem) Stat(path string) (*filesystem.FileInfo, error)
 }
 
 func (pfs *PooledWASMFileSystem) Rename(oldPath, newPath string) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("rename", oldPath, func(fs *WASMFileSystem) error {
 		return fs.Rename(oldPath, newPath)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) Chmod(path string, mode uint32) error {
-	return pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	return pfs.pool.executeOp("chmod", path, func(fs *WASMFileSystem) error {
 		return fs.Chmod(path, mode)
 	})
 }
 
 func (pfs *PooledWASMFileSystem) Open(path string) (io.ReadCloser, error) {
 	var reader io.ReadCloser
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("open", path, func(fs *WASMFileSystem) error {
 		var openErr error
 		reader, openErr = fs.Open(path)
 		return openErr
@@ -331,7 +387,7 @@ func (pfs *PooledWASMFileSystem) Open(path string) (io.ReadCloser, error) {
 
 func (pfs *PooledWASMFileSystem) OpenWrite(path string) (io.WriteCloser, error) {
 	var writer io.WriteCloser
-	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+	err := pfs.pool.executeOp("open_write", path, func(fs *WASMFileSystem) error {
 		var openErr error
 		writer, openErr = fs.OpenWrite(path)
 		return openErr
@@ -362,7 +418,12 @@ func (pfs *PooledWASMFileSystem) OpenHandle(path string, flags filesystem.OpenFl
 	}
 
 	// Call OpenHandle on the WASM instance
-	handle, err := instance.fileSystem.OpenHandle(path, flags, mode)
+	var handle filesystem.FileHandle
+	err = pfs.pool.executeHeld("open_handle", path, instance, func(fs *WASMFileSystem) error {
+		var openErr error
+		handle, openErr = fs.OpenHandle(path, flags, mode)
+		return openErr
+	})
 	if err != nil {
 		// Release the instance back to pool on error
 		pfs.pool.Release(instance)
@@ -433,6 +494,13 @@ type PooledWASMFileHandle struct {
 	mu       sync.Mutex
 }
 
+// call runs fn on the handle's instance, traced as op; the caller holds h.mu
+func (h *PooledWASMFileHandle) call(op string, fn func() error) error {
+	return h.pfs.pool.executeHeld(op, h.inner.Path(), h.instance, func(*WASMFileSystem) error {
+		return fn()
+	})
+}
+
 func (h *PooledWASMFileHandle) ID() int64 {
 	return h.id
 }
@@ -451,7 +519,13 @@ func (h *PooledWASMFileHandle) Read(buf []byte) (int, error) {
 	if h.closed {
 		return 0, fmt.Errorf("handle is closed")
 	}
-	return h.inner.Read(buf)
+	var n int
+	err := h.call("handle_read", func() error {
+		var err error
+		n, err = h.inner.Read(buf)
+		return err
+	})
+	return n, err
 }
 
 func (h *PooledWASMFileHandle) ReadAt(buf []byte, offset int64) (int, error) {
@@ -460,7 +534,13 @@ func (h *PooledWASMFileHandle) ReadAt(buf []byte, offset int64) (int, error) {
 	if h.closed {
 		return 0, fmt.Errorf("handle is closed")
 	}
-	return h.inner.ReadAt(buf, offset)
+	var n int
+	err := h.call("handle_read_at", func() error {
+		var err error
+		n, err = h.inner.ReadAt(buf, offset)
+		return err
+	})
+	return n, err
 }
 
 func (h *PooledWASMFileHandle) Write(data []byte) (int, error) {
@@ -469,7 +549,13 @@ func (h *PooledWASMFileHandle) Write(data []byte) (int, error) {
 	if h.closed {
 		return 0, fmt.Errorf("handle is closed")
 	}
-	return h.inner.Write(data)
+	var n int
+	err := h.call("handle_write", func() error {
+		var err error
+		n, err = h.inner.Write(data)
+		return err
+	})
+	return n, err
 }
 
 func (h *PooledWASMFileHandle) WriteAt(data []byte, offset int64) (int, error) {
@@ -478,7 +564,13 @@ func (h *PooledWASMFileHandle) WriteAt(data []byte, offset int64) (int, error) {
 	if h.closed {
 		return 0, fmt.Errorf("handle is closed")
 	}
-	return h.inner.WriteAt(data, offset)
+	var n int
+	err := h.call("handle_write_at", func() error {
+		var err error
+		n, err = h.inner.WriteAt(data, offset)
+		return err
+	})
+	return n, err
 }
 
 func (h *PooledWASMFileHandle) Seek(offset int64, whence int) (int64, error) {
@@ -487,7 +579,13 @@ func (h *PooledWASMFileHandle) Seek(offset int64, whence int) (int64, error) {
 	if h.closed {
 		return 0, fmt.Errorf("handle is closed")
 	}
-	return h.inner.Seek(offset, whence)
+	var pos int64
+	err := h.call("handle_seek", func() error {
+		var err error
+		pos, err = h.inner.Seek(offset, whence)
+		return err
+	})
+	return pos, err
 }
 
 func (h *PooledWASMFileHandle) Sync() error {
@@ -496,7 +594,7 @@ func (h *PooledWASMFileHandle) Sync() error {
 	if h.closed {
 		return fmt.Errorf("handle is closed")
 	}
-	return h.inner.Sync()
+	return h.call("handle_sync", h.inner.Sync)
 }
 
 func (h *PooledWASMFileHandle) Stat() (*filesystem.FileInfo, error) {
@@ -505,7 +603,13 @@ func (h *PooledWASMFileHandle) Stat() (*filesystem.FileInfo, error) {
 	if h.closed {
 		return nil, fmt.Errorf("handle is closed")
 	}
-	return h.inner.Stat()
+	var info *filesystem.FileInfo
+	err := h.call("handle_stat", func() error {
+		var err error
+		info, err = h.inner.Stat()
+		return err
+	})
+	return info, err
 }
 
 func (h *PooledWASMFileHandle) Close() error {
@@ -517,7 +621,7 @@ func (h *PooledWASMFileHandle) Close() error {
 	h.closed = true
 
 	// Close the inner handle
-	err := h.inner.Close()
+	err := h.call("close_handle", h.inner.Close)
 
 	// Remove from tracking (if not already removed by CloseHandle)
 	h.pfs.handleMu.Lock()
@@ -690,14 +794,18 @@ func (wfs *WASMFileSystem) Read(path string, offset int64, size int64) ([]byte,
 		return nil, fmt.Errorf("read failed")
 	}
 
-	data, ok := wfs.module.Memory().Read(dataPtr, dataSize)
+	view, ok := wfs.module.Memory().Read(dataPtr, dataSize)
 	if !ok {
-		freeWASMMemory(wfs.module, dataPtr, 0)
+		freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
 		return nil, fmt.Errorf("failed to read data from memory")
 	}
 
-	// Free WASM memory after copying data
-	freeWASMMemory(wfs.module, dataPtr, 0)
+	// The view aliases WASM memory (possibly the shared output buffer), so copy it out
+	data := make([]byte, len(view))
+	copy(data, view)
+
+	// Free WASM memory after copying data (shared output buffer is left alone)
+	freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
 
 	return data, nil
 }
@@ -748,7 +856,324 @@ func (wfs *WASMFileSystem) Write(path string, data []byte, offset int64, flags f
 	return int64(bytesWritten), nil
 }
 
+// Limits of one fs_readv call, AGFS_READV_MAX_SEGMENTS and
+// AGFS_READV_MAX_BYTES in the C++ SDK
+const (
+	maxReadVSegments = 4096
+	maxReadVBytes    = 64 << 20
+)
+
+// ReadV reads several ranges of path through fs_readv
+// Requests beyond the fs_readv limits are split over several calls, and
+// plugins without the export are read one range at a time.
+func (wfs *WASMFileSystem) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	readvFunc := wfs.module.ExportedFunction("fs_readv")
+	out := make([][]byte, 0, len(ranges))
+	for start := 0; start < len(ranges); {
+		end := start
+		var total int64
+		for end < len(ranges) && end-start < maxReadVSegments &&
+			ranges[end].Size >= 0 && ranges[end].Size <= maxReadVBytes-total {
+			total += ranges[end].Size
+			end++
+		}
+
+		if readvFunc == nil || end == start {
+			// One range at a time, also for a single range over the limit
+			data, err := wfs.Read(path, ranges[start].Offset, ranges[start].Size)
+			if err != nil {
+				return nil, err
+			}
+			out = append(out, data)
+			start++
+			continue
+		}
+
+		batch, err := wfs.readVCall(readvFunc, path, ranges[start:end])
+		if err != nil {
+			return nil, err
+		}
+		out = append(out, batch...)
+		start = end
+	}
+	return out, nil
+}
+
+// readVCall reads ranges, which fit the fs_readv limits, in one call
+func (wfs *WASMFileSystem) readVCall(readvFunc wazeroapi.Function, path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	iovPtr, iovPtrSize, err := writeBytesToMemoryWithBuffer(wfs.module, encodeReadVRequest(ranges), wfs.sharedBuffer)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, iovPtr, iovPtrSize, wfs.sharedBuffer)
+
+	results, err := readvFunc.Call(wfs.ctx, uint64(pathPtr), uint64(iovPtr), uint64(len(ranges)))
+	if err != nil {
+		return nil, fmt.Errorf("fs_readv failed: %w", err)
+	}
+
+	if len(results) < 1 {
+		return nil, fmt.Errorf("fs_readv returned invalid results")
+	}
+
+	// Unpack u64: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+	packed := results[0]
+	bufPtr := uint32(packed & 0xFFFFFFFF)
+	errPtr := uint32((packed >> 32) & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
+			freeWASMMemory(wfs.module, errPtr, 0)
+			return nil, fmt.Errorf("%s", errMsg)
+		}
+		freeWASMMemory(wfs.module, errPtr, 0)
+		return nil, fmt.Errorf("readv failed")
+	}
+
+	if bufPtr == 0 {
+		return nil, fmt.Errorf("fs_readv returned null")
+	}
+
+	buf, ok := readReadVResult(wfs.module, bufPtr)
+	freeWASMMemoryWithBuffer(wfs.module, bufPtr, 0, wfs.sharedBuffer)
+	if !ok {
+		return nil, fmt.Errorf("failed to read fs_readv result")
+	}
+
+	return decodeReadVResult(buf, len(ranges))
+}
+
+// WriteV writes several ranges of path through fs_writev
+// Plugins without the export are written one segment at a time.
+func (wfs *WASMFileSystem) WriteV(path string, segments []filesystem.WriteSegment, flags filesystem.WriteFlag) (int64, error) {
+	writevFunc := wfs.module.ExportedFunction("fs_writev")
+	if writevFunc == nil {
+		var total int64
+		for _, seg := range segments {
+			n, err := wfs.Write(path, seg.Data, seg.Offset, flags)
+			if err != nil {
+				return total, err
+			}
+			total += n
+			if n < int64(len(seg.Data)) {
+				break
+			}
+			flags &^= filesystem.WriteFlagTruncate
+		}
+		return total, nil
+	}
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return 0, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	iov := encodeWriteVRequest(segments)
+	iovPtr, iovPtrSize, err := writeBytesToMemoryWithBuffer(wfs.module, iov, wfs.sharedBuffer)
+	if err != nil {
+		return 0, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, iovPtr, iovPtrSize, wfs.sharedBuffer)
+
+	results, err := writevFunc.Call(wfs.ctx, uint64(pathPtr), uint64(iovPtr), uint64(len(iov)), uint64(flags))
+	if err != nil {
+		return 0, fmt.Errorf("fs_writev failed: %w", err)
+	}
+
+	if len(results) < 1 {
+		return 0, fmt.Errorf("fs_writev returned invalid results")
+	}
+
+	// Packed u64: high 32 bits = bytes written, low 32 bits = error ptr
+	packed := results[0]
+	bytesWritten := uint32(packed >> 32)
+	errPtr := uint32(packed & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
+		freeWASMMemory(wfs.module, errPtr, 0)
+		if ok && errMsg != "" {
+			return 0, fmt.Errorf("writev failed: %s", errMsg)
+		}
+		return 0, fmt.Errorf("writev failed")
+	}
+
+	return int64(bytesWritten), nil
+}
+
+// callFileInfoBinary calls fs_stat_bin/fs_readdir_bin and decodes the binary result
+func (wfs *WASMFileSystem) callFileInfoBinary(fn wazeroapi.Function, name string, path string) ([]filesystem.FileInfo, error) {
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	results, err := fn.Call(wfs.ctx, uint64(pathPtr))
+	if err != nil {
+		return nil, fmt.Errorf("%s failed: %w", name, err)
+	}
+
+	if len(results) < 1 {
+		return nil, fmt.Errorf("%s returned invalid results", name)
+	}
+
+	// Unpack u64: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+	packed := results[0]
+	bufPtr := uint32(packed & 0xFFFFFFFF)
+	errPtr := uint32((packed >> 32) & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
+			freeWASMMemory(wfs.module, errPtr, 0)
+			return nil, fmt.Errorf("%s", errMsg)
+		}
+		freeWASMMemory(wfs.module, errPtr, 0)
+		return nil, fmt.Errorf("%s failed", name)
+	}
+
+	if bufPtr == 0 {
+		return nil, fmt.Errorf("%s returned null", name)
+	}
+
+	buf, ok := readFileInfoBinary(wfs.module, bufPtr)
+	freeWASMMemoryWithBuffer(wfs.module, bufPtr, 0, wfs.sharedBuffer)
+	if !ok {
+		return nil, fmt.Errorf("failed to read %s result", name)
+	}
+
+	return decodeFileInfoBinary(buf)
+}
+
+// readDirPageSize is the number of entries requested per fs_readdir_page call
+const readDirPageSize = 1024
+
+// ReadDirPage lists one page of a directory through fs_readdir_page
+// cursor is the token returned by the previous page ("" for the first one);
+// the returned cursor is "" once the listing is complete.
+func (wfs *WASMFileSystem) ReadDirPage(path string, cursor string, maxEntries int) ([]filesystem.FileInfo, string, error) {
+	pageFunc := wfs.module.ExportedFunction("fs_readdir_page")
+	if pageFunc == nil {
+		return nil, "", fmt.Errorf("fs_readdir_page not implemented")
+	}
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return nil, "", err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	cursorPtr, cursorPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, cursor, wfs.sharedBuffer)
+	if err != nil {
+		return nil, "", err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, cursorPtr, cursorPtrSize, wfs.sharedBuffer)
+
+	results, err := pageFunc.Call(wfs.ctx, uint64(pathPtr), uint64(cursorPtr), uint64(maxEntries))
+	if err != nil {
+		return nil, "", fmt.Errorf("fs_readdir_page failed: %w", err)
+	}
+
+	if len(results) < 1 {
+		return nil, "", fmt.Errorf("fs_readdir_page returned invalid results")
+	}
+
+	// Unpack u64: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+	packed := results[0]
+	bufPtr := uint32(packed & 0xFFFFFFFF)
+	errPtr := uint32((packed >> 32) & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
+			freeWASMMemory(wfs.module, errPtr, 0)
+			return nil, "", fmt.Errorf("%s", errMsg)
+		}
+		freeWASMMemory(wfs.module, errPtr, 0)
+		return nil, "", fmt.Errorf("readdir page failed")
+	}
+
+	if bufPtr == 0 {
+		return nil, "", fmt.Errorf("fs_readdir_page returned null")
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, bufPtr, 0, wfs.sharedBuffer)
+
+	// Buffer layout: u32 cursor_len, cursor bytes, then the binary FileInfo encoding
+	mem := wfs.module.Memory()
+	cursorLen, ok := mem.ReadUint32Le(bufPtr)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page cursor")
+	}
+	nextCursor, ok := mem.Read(bufPtr+4, cursorLen)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page cursor")
+	}
+	next := string(nextCursor)
+
+	buf, ok := readFileInfoBinary(wfs.module, bufPtr+4+cursorLen)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page entries")
+	}
+	infos, err := decodeFileInfoBinary(buf)
+	if err != nil {
+		return nil, "", err
+	}
+
+	return infos, next, nil
+}
+
+// readDirPaged assembles a full listing from fs_readdir_page calls so the
+// plugin never has to materialize the whole directory at once
+func (wfs *WASMFileSystem) readDirPaged(path string) ([]filesystem.FileInfo, error) {
+	var all []filesystem.FileInfo
+	cursor := ""
+	for {
+		infos, next, err := wfs.ReadDirPage(path, cursor, readDirPageSize)
+		if err != nil {
+			return nil, err
+		}
+		all = append(all, infos...)
+		if next == "" {
+			break
+		}
+		if next == cursor {
+			return nil, fmt.Errorf("fs_readdir_page did not advance cursor %q", cursor)
+		}
+		cursor = next
+	}
+	if all == nil {
+		all = []filesystem.FileInfo{}
+	}
+	return all, nil
+}
+
+// nativeReadDirPage reports whether the plugin pages directories itself
+// The SDK's default fs_readdir_page re-lists the directory for every page.
+func (wfs *WASMFileSystem) nativeReadDirPage() bool {
+	fn := wfs.module.ExportedFunction("fs_readdir_page_native")
+	if fn == nil || wfs.module.ExportedFunction("fs_readdir_page") == nil {
+		return false
+	}
+	results, err := fn.Call(wfs.ctx)
+	return err == nil && len(results) > 0 && results[0] != 0
+}
+
 func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
+	// Prefer native paging, then binary, then JSON listings depending on what the plugin exports
+	if wfs.nativeReadDirPage() {
+		return wfs.readDirPaged(path)
+	}
+	if binFunc := wfs.module.ExportedFunction("fs_readdir_bin"); binFunc != nil {
+		return wfs.callFileInfoBinary(binFunc, "fs_readdir_bin", path)
+	}
+
 	readDirFunc := wfs.module.ExportedFunction("fs_readdir")
 	if readDirFunc == nil {
 		return nil, fmt.Errorf("fs_readdir not implemented")
@@ -807,6 +1232,19 @@ func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
 
 func (wfs *WASMFileSystem) Stat(path string) (*filesystem.FileInfo, error) {
 	log.Debugf("WASM Stat called with path: %s", path)
+
+	// Prefer the binary encoding when the plugin provides it
+	if binFunc := wfs.module.ExportedFunction("fs_stat_bin"); binFunc != nil {
+		infos, err := wfs.callFileInfoBinary(binFunc, "fs_stat_bin", path)
+		if err != nil {
+			return nil, err
+		}
+		if len(infos) != 1 {
+			return nil, fmt.Errorf("fs_stat_bin returned %d entries", len(infos))
+		}
+		return &infos[0], nil
+	}
+
 	statFunc := wfs.module.ExportedFunction("fs_stat")
 	if statFunc == nil {
 		return nil, fmt.Errorf("fs_stat not implemented")
@@ -1450,9 +1888,9 @@ func freeWASMMemoryWithBuffer(module wazeroapi.Module, ptr uint32, size uint32,
 		return
 	}
 
-	// Don't free shared buffer memory
+	// Don't free shared buffer memory; input slots are just released
 	if bufInfo != nil && bufInfo.Enabled {
-		if ptr == bufInfo.InputBufferPtr || ptr == bufInfo.OutputBufferPtr {
+		if ptr == bufInfo.OutputBufferPtr || bufInfo.releaseInputSlot(ptr) {
 			return // This is shared buffer memory, don't free
 		}
 	}
@@ -1528,11 +1966,13 @@ func writeStringToMemoryWithBuffer(module wazeroapi.Module, s string, bufInfo *S
 	size = uint32(len(s) + 1) // +1 for null terminator
 	data := append([]byte(s), 0)
 
-	// Try to use shared buffer if available and data fits
+	// Try to use a shared buffer slot if available and data fits
 	if bufInfo != nil && bufInfo.Enabled && size <= bufInfo.BufferSize {
-		mem := module.Memory()
-		if mem.Write(bufInfo.InputBufferPtr, data) {
-			return bufInfo.InputBufferPtr, size, nil
+		if slotPtr, ok := bufInfo.acquireInputSlot(); ok {
+			if module.Memory().Write(slotPtr, data) {
+				return slotPtr, size, nil
+			}
+			bufInfo.releaseInputSlot(slotPtr)
 		}
 	}
 
@@ -1572,11 +2012,13 @@ func writeBytesToMemory(module wazeroapi.Module, data []byte) (ptr uint32, size
 func writeBytesToMemoryWithBuffer(module wazeroapi.Module, data []byte, bufInfo *SharedBufferInfo) (ptr uint32, size uint32, err error) {
 	size = uint32(len(data))
 
-	// Try to use shared buffer if available and data fits
+	// Try to use a shared buffer slot if available and data fits
 	if bufInfo != nil && bufInfo.Enabled && size <= bufInfo.BufferSize {
-		mem := module.Memory()
-		if mem.Write(bufInfo.InputBufferPtr, data) {
-			return bufInfo.InputBufferPtr, size, nil
+		if slotPtr, ok := bufInfo.acquireInputSlot(); ok {
+			if module.Memory().Write(slotPtr, data) {
+				return slotPtr, size, nil
+			}
+			bufInfo.releaseInputSlot(slotPtr)
 		}
 	}
 
@@ -0,0 +1,156 @@
+package api
+
+import (
+	"context"
+	"fmt"
+	"time"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// pluginInitState is what an instance needs to match the last Initialize
+// call: the config it was given and, if the plugin supports it, the state
+// snapshot plugin_export_state returned afterwards.
+type pluginInitState struct {
+	generation uint64
+	configJSON []byte
+	state      []byte // nil = replay plugin_initialize instead
+}
+
+// setInitState records a successful Initialize on instance
+// Every other instance is brought up to date the next time it is acquired.
+func (p *WASMInstancePool) setInitState(instance *WASMModuleInstance, configJSON, state []byte) {
+	p.initMu.Lock()
+	defer p.initMu.Unlock()
+
+	var generation uint64 = 1
+	if p.initState != nil {
+		generation = p.initState.generation + 1
+	}
+	p.initState = &pluginInitState{generation: generation, configJSON: configJSON, state: state}
+	instance.initGeneration = generation
+}
+
+// restoreInitState applies the last Initialize to an instance that has not
+// seen it yet, by importing the state snapshot when there is one and
+// otherwise re-running plugin_initialize with the same config
+// Workers of a threaded plugin need neither.
+func (p *WASMInstancePool) restoreInitState(instance *WASMModuleInstance) error {
+	if p.threads != nil {
+		return nil // workers share the one initialized plugin
+	}
+
+	p.initMu.Lock()
+	st := p.initState
+	p.initMu.Unlock()
+
+	if st == nil || instance.initGeneration == st.generation {
+		return nil
+	}
+
+	start := time.Now()
+	how := "plugin_initialize"
+	if st.state != nil {
+		if err := importPluginState(p.ctx, instance.module, st.state); err != nil {
+			log.Warnf("[Pool %s] %v; falling back to plugin_initialize", p.pluginName, err)
+		} else {
+			how = "plugin_import_state"
+		}
+	}
+	if how == "plugin_initialize" {
+		if err := callPluginInitialize(p.ctx, instance.module, st.configJSON); err != nil {
+			return err
+		}
+	}
+
+	instance.initGeneration = st.generation
+	log.Debugf("[Pool %s] initialized instance via %s in %v", p.pluginName, how, time.Since(start))
+	return nil
+}
+
+// callPluginInitialize passes configJSON to the plugin's plugin_initialize
+// Plugins that do not export it are treated as initialized.
+func callPluginInitialize(ctx context.Context, module wazeroapi.Module, configJSON []byte) error {
+	initFunc := module.ExportedFunction("plugin_initialize")
+	if initFunc == nil {
+		return nil
+	}
+
+	// Write config to WASM memory
+	configPtr, configPtrSize, err := writeStringToMemory(module, string(configJSON))
+	if err != nil {
+		return fmt.Errorf("failed to write config to memory: %w", err)
+	}
+	defer freeWASMMemory(module, configPtr, configPtrSize)
+
+	results, err := initFunc.Call(ctx, uint64(configPtr))
+	if err != nil {
+		return fmt.Errorf("initialize call failed: %w", err)
+	}
+
+	// Check for error return
+	if len(results) > 0 && results[0] != 0 {
+		errPtr := uint32(results[0])
+		if errMsg, ok := readStringFromMemory(module, errPtr); ok {
+			freeWASMMemory(module, errPtr, 0)
+			return fmt.Errorf("initialization failed: %s", errMsg)
+		}
+		freeWASMMemory(module, errPtr, 0)
+		return fmt.Errorf("initialization failed")
+	}
+	return nil
+}
+
+// exportPluginState calls plugin_export_state on an initialized instance
+// Returns nil when the plugin does not export it or has no state to share.
+func exportPluginState(ctx context.Context, module wazeroapi.Module) ([]byte, error) {
+	exportFunc := module.ExportedFunction("plugin_export_state")
+	if exportFunc == nil {
+		return nil, nil
+	}
+	results, err := exportFunc.Call(ctx)
+	if err != nil {
+		return nil, fmt.Errorf("plugin_export_state failed: %w", err)
+	}
+	if len(results) < 1 || results[0] == 0 {
+		return nil, nil
+	}
+
+	// Unpack u64: lower 32 bits = pointer, upper 32 bits = size
+	ptr := uint32(results[0] & 0xFFFFFFFF)
+	size := uint32(results[0] >> 32)
+	defer freeWASMMemory(module, ptr, 0)
+
+	data, ok := module.Memory().Read(ptr, size)
+	if !ok {
+		return nil, fmt.Errorf("failed to read plugin state from memory")
+	}
+	return append([]byte(nil), data...), nil
+}
+
+// importPluginState hands a plugin_export_state snapshot to a fresh instance
+func importPluginState(ctx context.Context, module wazeroapi.Module, state []byte) error {
+	importFunc := module.ExportedFunction("plugin_import_state")
+	if importFunc == nil {
+		return fmt.Errorf("plugin does not export plugin_import_state")
+	}
+
+	statePtr, stateSize, err := writeBytesToMemory(module, state)
+	if err != nil {
+		return fmt.Errorf("failed to write plugin state to memory: %w", err)
+	}
+	defer freeWASMMemory(module, statePtr, stateSize)
+
+	results, err := importFunc.Call(ctx, uint64(statePtr), uint64(stateSize))
+	if err != nil {
+		return fmt.Errorf("plugin_import_state call failed: %w", err)
+	}
+	if len(results) > 0 && results[0] != 0 {
+		errPtr := uint32(results[0])
+		errMsg, _ := readStringFromMemory(module, errPtr)
+		freeWASMMemory(module, errPtr, 0)
+		return fmt.Errorf("plugin_import_state failed: %s", errMsg)
+	}
+	return nil
+}
@@ -0,0 +1,270 @@
+package api
+
+import (
+	"context"
+	"fmt"
+	"sync"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	log "github.com/sirupsen/logrus"
+	"github.com/tetratelabs/wazero"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Threaded plugins (the C++ SDK's make build-wasi-threads) import their linear
+// memory as shared memory from SharedMemoryModule. Their pool instances are
+// workers: further instantiations of the module over that one memory, each
+// with a stack and TLS block of its own carved out of the shared heap. The
+// plugin object, its caches and its handle table exist once, so plugin_new
+// and plugin_initialize run a single time for the whole pool.
+
+// SharedMemoryModule is the module threaded plugins import their memory from
+const SharedMemoryModule = "agfs_memory"
+
+// defaultThreadStackSize is used when a plugin does not export agfs_thread_stack_size
+const defaultThreadStackSize = 64 * 1024
+
+// threadSupport is the state a threaded pool shares between its workers
+type threadSupport struct {
+	memory  wazeroapi.Module // the shared memory every worker imports
+	primary wazeroapi.Module // ran plugin_new; allocates and frees worker blocks
+	mu      sync.Mutex       // the primary serves one call at a time
+
+	stackSize uint32
+	tlsSize   uint32
+	tlsAlign  uint32
+}
+
+// IsSharedMemoryModule reports whether compiled imports its memory from SharedMemoryModule
+func IsSharedMemoryModule(compiled wazero.CompiledModule) bool {
+	_, _, ok := sharedMemoryImport(compiled)
+	return ok
+}
+
+// sharedMemoryImport returns the page limits of the imported shared memory
+func sharedMemoryImport(compiled wazero.CompiledModule) (minPages, maxPages uint32, ok bool) {
+	for _, mem := range compiled.ImportedMemories() {
+		moduleName, _, isImport := mem.Import()
+		if !isImport || moduleName != SharedMemoryModule {
+			continue
+		}
+		maxPages, hasMax := mem.Max()
+		if !hasMax {
+			return 0, 0, false // shared memories always declare a maximum
+		}
+		return mem.Min(), maxPages, true
+	}
+	return 0, 0, false
+}
+
+// InstantiateSharedMemory creates the SharedMemoryModule a threaded plugin imports
+// The runtime must enable the threads feature.
+func InstantiateSharedMemory(ctx context.Context, r wazero.Runtime, compiled wazero.CompiledModule) (wazeroapi.Module, error) {
+	minPages, maxPages, ok := sharedMemoryImport(compiled)
+	if !ok {
+		return nil, fmt.Errorf("module does not import a shared memory from %q", SharedMemoryModule)
+	}
+	memCompiled, err := r.CompileModule(ctx, sharedMemoryModuleBinary(minPages, maxPages))
+	if err != nil {
+		return nil, fmt.Errorf("failed to compile shared memory module: %w", err)
+	}
+	memory, err := r.InstantiateModule(ctx, memCompiled, wazero.NewModuleConfig().WithName(SharedMemoryModule))
+	if err != nil {
+		return nil, fmt.Errorf("failed to instantiate shared memory module: %w", err)
+	}
+	return memory, nil
+}
+
+// sharedMemoryModuleBinary encodes a module that only exports a shared memory as "memory"
+func sharedMemoryModuleBinary(minPages, maxPages uint32) []byte {
+	limits := []byte{0x01, 0x03} // one memory; flags: has maximum, shared
+	limits = appendULEB128(limits, minPages)
+	limits = appendULEB128(limits, maxPages)
+
+	exports := []byte{0x01, 0x06, 'm', 'e', 'm', 'o', 'r', 'y', 0x02, 0x00} // one export: memory 0
+
+	bin := []byte{0x00, 'a', 's', 'm', 0x01, 0x00, 0x00, 0x00}
+	bin = append(bin, 0x05) // memory section
+	bin = appendULEB128(bin, uint32(len(limits)))
+	bin = append(bin, limits...)
+	bin = append(bin, 0x07) // export section
+	bin = appendULEB128(bin, uint32(len(exports)))
+	return append(bin, exports...)
+}
+
+func appendULEB128(b []byte, v uint32) []byte {
+	for v >= 0x80 {
+		b = append(b, byte(v)|0x80)
+		v >>= 7
+	}
+	return append(b, byte(v))
+}
+
+// threadBlockSize is the allocation holding one worker's stack and TLS block
+func threadBlockSize(stackSize, tlsSize, tlsAlign uint32) uint32 {
+	return stackSize + tlsSize + 2*blockAlign(tlsAlign)
+}
+
+// layoutThreadBlock places a worker's stack and TLS block in the allocation at base
+// The stack grows down from stackTop; the TLS block starts right above it.
+func layoutThreadBlock(base, stackSize, tlsSize, tlsAlign uint32) (stackTop, tlsBase uint32) {
+	align := blockAlign(tlsAlign)
+	stackTop = alignUp(base, 16) + stackSize&^15
+	tlsBase = alignUp(stackTop, align)
+	return stackTop, tlsBase
+}
+
+func blockAlign(tlsAlign uint32) uint32 {
+	if tlsAlign < 16 {
+		return 16 // the stack pointer's own alignment
+	}
+	return tlsAlign
+}
+
+func alignUp(v, align uint32) uint32 {
+	return (v + align - 1) &^ (align - 1)
+}
+
+// NewWASMThreadedInstancePool creates a pool whose instances are workers of primary
+// primary must already have run plugin_new over memory; the pool owns both
+// modules from here on and closes them in Close.
+func NewWASMThreadedInstancePool(ctx context.Context, runtime wazero.Runtime, compiledModule wazero.CompiledModule,
+	memory, primary wazeroapi.Module, pluginName string, config PoolConfig, hostFS filesystem.FileSystem) *WASMInstancePool {
+
+	ts := &threadSupport{
+		memory:    memory,
+		primary:   primary,
+		stackSize: defaultThreadStackSize,
+	}
+	if fn := primary.ExportedFunction("agfs_thread_stack_size"); fn != nil {
+		if results, err := fn.Call(ctx); err == nil && len(results) > 0 && results[0] > 0 {
+			ts.stackSize = uint32(results[0])
+		}
+	}
+	if g := primary.ExportedGlobal("__tls_size"); g != nil {
+		ts.tlsSize = uint32(g.Get())
+	}
+	if g := primary.ExportedGlobal("__tls_align"); g != nil {
+		ts.tlsAlign = uint32(g.Get())
+	}
+
+	// HTTP resources belong to the shared plugin, whichever worker opened them
+	ShareHostHTTPState(primary, memory)
+
+	pool := NewWASMInstancePool(ctx, runtime, compiledModule, pluginName, config, hostFS)
+	pool.threads = ts
+
+	log.Infof("WASM pool for %s runs threaded workers over shared memory (stack=%d, tls=%d)",
+		pluginName, ts.stackSize, ts.tlsSize)
+	return pool
+}
+
+// createWorker instantiates the module again over the shared memory
+// plugin_new is not called: the worker reaches the plugin the primary created.
+func (p *WASMInstancePool) createWorker() (*WASMModuleInstance, error) {
+	ts := p.threads
+	config := wazero.NewModuleConfig().
+		WithSysNanotime().
+		WithSysWalltime()
+	module, err := p.runtime.InstantiateModule(p.ctx, p.compiledModule, config)
+	if err != nil {
+		return nil, fmt.Errorf("failed to instantiate WASM worker: %w", err)
+	}
+
+	block, err := ts.attach(p.ctx, module)
+	if err != nil {
+		module.Close(p.ctx)
+		return nil, err
+	}
+
+	ShareHostHTTPState(module, ts.memory)
+
+	sharedBuffer := initializeSharedBuffer(module, p.ctx)
+	instance := &WASMModuleInstance{
+		module:       module,
+		createdAt:    time.Now(),
+		sharedBuffer: sharedBuffer,
+		threadBlock:  block,
+		id:           p.nextInstanceID.Add(1),
+		fileSystem: &WASMFileSystem{
+			ctx:    p.ctx,
+			module: module,
+		},
+	}
+	instance.fileSystem.sharedBuffer = &instance.sharedBuffer
+	return instance, nil
+}
+
+// attach gives a new worker its own stack and TLS block
+// Returns: The block's address, to free when the worker goes away
+func (ts *threadSupport) attach(ctx context.Context, worker wazeroapi.Module) (uint32, error) {
+	sp, ok := worker.ExportedGlobal("__stack_pointer").(wazeroapi.MutableGlobal)
+	if !ok {
+		return 0, fmt.Errorf("threaded WASM module must export a mutable __stack_pointer")
+	}
+	initTLS := worker.ExportedFunction("__wasm_init_tls")
+	if ts.tlsSize > 0 && initTLS == nil {
+		return 0, fmt.Errorf("threaded WASM module must export __wasm_init_tls")
+	}
+
+	block, err := ts.alloc(ctx, threadBlockSize(ts.stackSize, ts.tlsSize, ts.tlsAlign))
+	if err != nil {
+		return 0, err
+	}
+	stackTop, tlsBase := layoutThreadBlock(block, ts.stackSize, ts.tlsSize, ts.tlsAlign)
+	sp.Set(uint64(stackTop))
+	if ts.tlsSize > 0 {
+		if _, err := initTLS.Call(ctx, uint64(tlsBase)); err != nil {
+			ts.free(block)
+			return 0, fmt.Errorf("failed to initialize worker TLS: %w", err)
+		}
+	}
+	return block, nil
+}
+
+func (ts *threadSupport) alloc(ctx context.Context, size uint32) (uint32, error) {
+	ts.mu.Lock()
+	defer ts.mu.Unlock()
+
+	malloc := ts.primary.ExportedFunction("malloc")
+	if malloc == nil {
+		return 0, fmt.Errorf("malloc function not found in WASM module")
+	}
+	results, err := malloc.Call(ctx, uint64(size))
+	if err != nil {
+		return 0, fmt.Errorf("malloc failed: %w", err)
+	}
+	if len(results) == 0 || results[0] == 0 {
+		return 0, fmt.Errorf("cannot allocate %d bytes for a WASM worker", size)
+	}
+	return uint32(results[0]), nil
+}
+
+func (ts *threadSupport) free(block uint32) {
+	ts.mu.Lock()
+	defer ts.mu.Unlock()
+	freeWASMMemory(ts.primary, block, 0)
+}
+
+// destroyWorker closes a worker without shutting the shared plugin down
+func (p *WASMInstancePool) destroyWorker(instance *WASMModuleInstance) {
+	p.drainMetrics(instance)
+	UnshareHostHTTPState(instance.module)
+	instance.module.Close(p.ctx)
+	p.threads.free(instance.threadBlock)
+}
+
+// close shuts the plugin down once every worker is gone
+func (ts *threadSupport) close(ctx context.Context) {
+	ts.mu.Lock()
+	defer ts.mu.Unlock()
+
+	if shutdownFunc := ts.primary.ExportedFunction("plugin_shutdown"); shutdownFunc != nil {
+		shutdownFunc.Call(ctx)
+	}
+	UnshareHostHTTPState(ts.primary)
+	ReleaseHostHTTPState(ts.memory)
+	ts.primary.Close(ctx)
+	ts.memory.Close(ctx)
+}
@@ -0,0 +1,96 @@
+package api
+
+import (
+	"bytes"
+	"testing"
+
+	"github.com/tetratelabs/wazero"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+type fakeMemoryDefinition struct {
+	wazeroapi.MemoryDefinition
+	module   string
+	min, max uint32
+	hasMax   bool
+}
+
+func (m fakeMemoryDefinition) Import() (string, string, bool) { return m.module, "memory", true }
+func (m fakeMemoryDefinition) Min() uint32                    { return m.min }
+func (m fakeMemoryDefinition) Max() (uint32, bool)            { return m.max, m.hasMax }
+
+type fakeCompiledModule struct {
+	wazero.CompiledModule
+	memories []wazeroapi.MemoryDefinition
+}
+
+func (c fakeCompiledModule) ImportedMemories() []wazeroapi.MemoryDefinition { return c.memories }
+
+func TestSharedMemoryModuleBinary(t *testing.T) {
+	got := sharedMemoryModuleBinary(17, 4096)
+	want := []byte{
+		0x00, 'a', 's', 'm', 0x01, 0x00, 0x00, 0x00,
+		0x05, 0x05, 0x01, 0x03, 0x11, 0x80, 0x20,
+		0x07, 0x0a, 0x01, 0x06, 'm', 'e', 'm', 'o', 'r', 'y', 0x02, 0x00,
+	}
+	if !bytes.Equal(got, want) {
+		t.Fatalf("unexpected module bytes\n got  %x\n want %x", got, want)
+	}
+}
+
+func TestAppendULEB128(t *testing.T) {
+	cases := map[uint32][]byte{
+		0:          {0x00},
+		127:        {0x7f},
+		128:        {0x80, 0x01},
+		65536:      {0x80, 0x80, 0x04},
+		0xFFFFFFFF: {0xff, 0xff, 0xff, 0xff, 0x0f},
+	}
+	for v, want := range cases {
+		if got := appendULEB128(nil, v); !bytes.Equal(got, want) {
+			t.Errorf("appendULEB128(%d) = %x, want %x", v, got, want)
+		}
+	}
+}
+
+func TestLayoutThreadBlock(t *testing.T) {
+	for _, tc := range []struct{ base, stack, tlsSize, tlsAlign uint32 }{
+		{base: 1032, stack: 65536, tlsSize: 40, tlsAlign: 8},
+		{base: 4099, stack: 65530, tlsSize: 200, tlsAlign: 64},
+		{base: 65536, stack: 65536, tlsSize: 0, tlsAlign: 0},
+	} {
+		size := threadBlockSize(tc.stack, tc.tlsSize, tc.tlsAlign)
+		stackTop, tlsBase := layoutThreadBlock(tc.base, tc.stack, tc.tlsSize, tc.tlsAlign)
+		if stackTop%16 != 0 || stackTop-tc.base < tc.stack-16 {
+			t.Errorf("%+v: bad stack top %d", tc, stackTop)
+		}
+		if tc.tlsAlign > 0 && tlsBase%tc.tlsAlign != 0 {
+			t.Errorf("%+v: TLS base %d not aligned", tc, tlsBase)
+		}
+		if tlsBase < stackTop || tlsBase+tc.tlsSize > tc.base+size {
+			t.Errorf("%+v: TLS block [%d, %d) outside [%d, %d)", tc, tlsBase, tlsBase+tc.tlsSize, stackTop, tc.base+size)
+		}
+	}
+}
+
+func TestIsSharedMemoryModule(t *testing.T) {
+	shared := fakeMemoryDefinition{module: SharedMemoryModule, min: 17, max: 4096, hasMax: true}
+	if !IsSharedMemoryModule(fakeCompiledModule{memories: []wazeroapi.MemoryDefinition{shared}}) {
+		t.Error("expected a shared memory import to be detected")
+	}
+	if minPages, maxPages, _ := sharedMemoryImport(fakeCompiledModule{memories: []wazeroapi.MemoryDefinition{shared}}); minPages != 17 || maxPages != 4096 {
+		t.Errorf("unexpected limits %d..%d", minPages, maxPages)
+	}
+
+	env := fakeMemoryDefinition{module: "env", max: 4096, hasMax: true}
+	if IsSharedMemoryModule(fakeCompiledModule{memories: []wazeroapi.MemoryDefinition{env}}) {
+		t.Error("memory imported from env is not the shared memory")
+	}
+	unbounded := fakeMemoryDefinition{module: SharedMemoryModule}
+	if IsSharedMemoryModule(fakeCompiledModule{memories: []wazeroapi.MemoryDefinition{unbounded}}) {
+		t.Error("a memory without maximum cannot be shared")
+	}
+	if IsSharedMemoryModule(fakeCompiledModule{}) {
+		t.Error("module without memory imports reported as threaded")
+	}
+}
@@ -0,0 +1,81 @@
+package api
+
+import (
+	"time"
+)
+
+// CallSpan describes one PooledWASMFileSystem call and the instance that served it
+type CallSpan struct {
+	Op       string        // Go-side operation: stat, readdir, read, write, handle_read, ...
+	Path     string        // Path within the plugin
+	Instance uint64        // Pool-unique id of the serving instance (0 if none was acquired)
+	Start    time.Time     // When the call asked the pool for an instance
+	Wait     time.Duration // Time spent acquiring the instance (0 for handle calls, whose instance is held)
+	Duration time.Duration // Whole call, including Wait
+	Err      error
+
+	// The plugin's own metrics for this call alone: its fs_* entry points and
+	// the hostfs_*/http_* calls they made. nil unless the plugin was built
+	// with AGFS_ENABLE_METRICS. Threaded pools share one set of counters, so
+	// there it also holds calls that overlapped this one on other workers.
+	Plugin *PluginMetrics
+}
+
+// CallTracer receives a CallSpan after every traced call
+// It runs on the calling goroutine, concurrently for concurrent calls.
+type CallTracer func(CallSpan)
+
+// SetTracer reports every PooledWASMFileSystem call to t; nil stops tracing
+// Idle instances are drained first so earlier calls are not attributed to
+// the first traced ones.
+func (p *WASMInstancePool) SetTracer(t CallTracer) {
+	if t == nil {
+		p.tracer.Store(nil)
+		return
+	}
+	p.CollectMetrics()
+	p.tracer.Store(&t)
+}
+
+// executeOp runs fn like Execute and reports the call to the tracer, if any
+func (p *WASMInstancePool) executeOp(op, path string, fn func(*WASMFileSystem) error) error {
+	tracer := p.tracer.Load()
+	if tracer == nil {
+		return p.Execute(func(instance *WASMModuleInstance) error {
+			return fn(instance.fileSystem)
+		})
+	}
+
+	span := CallSpan{Op: op, Path: path, Start: time.Now()}
+	instance, err := p.Acquire()
+	span.Wait = time.Since(span.Start)
+	if err != nil {
+		span.Duration = span.Wait
+		span.Err = err
+		(*tracer)(span)
+		return err
+	}
+	defer p.Release(instance)
+	return p.traceCall(tracer, span, instance, fn)
+}
+
+// executeHeld runs fn on an instance the caller already holds, such as the
+// one bound to a file handle, and reports the call with no Wait
+func (p *WASMInstancePool) executeHeld(op, path string, instance *WASMModuleInstance, fn func(*WASMFileSystem) error) error {
+	tracer := p.tracer.Load()
+	if tracer == nil {
+		return fn(instance.fileSystem)
+	}
+	return p.traceCall(tracer, CallSpan{Op: op, Path: path, Start: time.Now()}, instance, fn)
+}
+
+func (p *WASMInstancePool) traceCall(tracer *CallTracer, span CallSpan, instance *WASMModuleInstance, fn func(*WASMFileSystem) error) error {
+	span.Instance = instance.id
+	span.Err = fn(instance.fileSystem)
+	span.Duration = time.Since(span.Start)
+	// Still held, so the counters hold this call and nothing else
+	span.Plugin = p.drainMetrics(instance)
+
+	(*tracer)(span)
+	return span.Err
+}
@@ -0,0 +1,64 @@
+package api
+
+import (
+	"context"
+	"errors"
+	"testing"
+)
+
+// newTracedTestPool returns a pool holding one idle instance that has no plugin metrics
+func newTracedTestPool(t *testing.T) (*WASMInstancePool, *WASMModuleInstance, *[]CallSpan) {
+	pool := NewWASMInstancePool(context.Background(), nil, nil, "trace-test", PoolConfig{MaxInstances: 1}, nil)
+	instance := &WASMModuleInstance{module: noMallocModule{}, id: 7, fileSystem: &WASMFileSystem{}}
+	pool.currentInstances = 1
+	pool.instances <- instance
+
+	var spans []CallSpan
+	pool.SetTracer(func(s CallSpan) { spans = append(spans, s) })
+	return pool, instance, &spans
+}
+
+func TestExecuteOpReleasesOnPanic(t *testing.T) {
+	pool, instance, spans := newTracedTestPool(t)
+
+	func() {
+		defer func() {
+			if recover() == nil {
+				t.Fatalf("expected the call to panic")
+			}
+		}()
+		pool.executeOp("read", "/f", func(*WASMFileSystem) error { panic("plugin trapped") })
+	}()
+
+	select {
+	case got := <-pool.instances:
+		if got != instance {
+			t.Fatalf("pool returned a different instance")
+		}
+	default:
+		t.Fatalf("instance not released after a panicking call")
+	}
+	if len(*spans) != 0 {
+		t.Fatalf("a call that did not finish was traced: %+v", *spans)
+	}
+}
+
+func TestExecuteHeldIsTraced(t *testing.T) {
+	pool, instance, spans := newTracedTestPool(t)
+	held := <-pool.instances
+
+	want := errors.New("short read")
+	if err := pool.executeHeld("handle_read", "/f", held, func(*WASMFileSystem) error { return want }); err != want {
+		t.Fatalf("executeHeld = %v, want %v", err, want)
+	}
+	if len(*spans) != 1 {
+		t.Fatalf("got %d spans, want 1", len(*spans))
+	}
+	span := (*spans)[0]
+	if span.Op != "handle_read" || span.Path != "/f" || span.Instance != instance.id || span.Wait != 0 || span.Err != want {
+		t.Fatalf("unexpected span %+v", span)
+	}
+	if len(pool.instances) != 0 {
+		t.Fatalf("executeHeld released an instance it does not own")
+	}
+}
@@ -13,6 +13,7 @@ import (
 	log "github.com/sirupsen/logrus"
 	"github.com/tetratelabs/wazero"
 	wazeroapi "github.com/tetratelabs/wazero/api"
+	"github.com/tetratelabs/wazero/experimental"
 	"github.com/tetratelabs/wazero/imports/wasi_snapshot_preview1"
 )
 
@@ -78,7 +79,9 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 
 	// Create a new WASM runtime
 	ctx := context.Background()
-	r := wazero.NewRuntime(ctx)
+	// Threads let plugins built with build-wasi-threads share one memory
+	r := wazero.NewRuntimeWithConfig(ctx, wazero.NewRuntimeConfig().
+		WithCoreFeatures(wazeroapi.CoreFeaturesV2|experimental.CoreFeaturesThreads))
 
 	// Instantiate WASI
 	if _, err := wasi_snapshot_preview1.Instantiate(ctx, r); err != nil {
@@ -115,6 +118,11 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 			}).
 			Export("host_fs_write").
 			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr, dataPtr, dataLen uint32, offset int64, flags uint32) uint64 {
+				return api.HostFSWriteAt(ctx, mod, []uint64{uint64(pathPtr), uint64(dataPtr), uint64(dataLen), uint64(offset), uint64(flags)}, fs)[0]
+			}).
+			Export("host_fs_write_at").
+			NewFunctionBuilder().
 			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32) uint64 {
 				return api.HostFSStat(ctx, mod, []uint64{uint64(pathPtr)}, fs)[0]
 			}).
@@ -155,10 +163,65 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 			}).
 			Export("host_fs_chmod").
 			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, srcPtr, dstPtr uint32, srcOffset, dstOffset, length int64, flags, copiedPtr uint32) uint32 {
+				return uint32(api.HostFSCopy(ctx, mod, []uint64{uint64(srcPtr), uint64(dstPtr), uint64(srcOffset), uint64(dstOffset), uint64(length), uint64(flags), uint64(copiedPtr)}, fs)[0])
+			}).
+			Export("host_fs_copy").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32, offset int64, dstLen, dstPtr uint32) uint64 {
+				return api.HostFSMap(ctx, mod, []uint64{uint64(pathPtr), uint64(offset), uint64(dstLen), uint64(dstPtr)}, fs)[0]
+			}).
+			Export("host_fs_map").
+			NewFunctionBuilder().
 			WithFunc(func(ctx context.Context, mod wazeroapi.Module, requestPtr uint32) uint64 {
 				return api.HostHTTPRequest(ctx, mod, []uint64{uint64(requestPtr)})[0]
 			}).
 			Export("host_http_request").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, reqPtr, reqLen, bodyPtr, bodyLen uint32) uint64 {
+				return api.HostHTTPRequestV2(ctx, mod, []uint64{uint64(reqPtr), uint64(reqLen), uint64(bodyPtr), uint64(bodyLen)})[0]
+			}).
+			Export("host_http_request_v2").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, reqPtr, reqLen, bodyPtr, bodyLen uint32) uint64 {
+				return api.HostHTTPStreamOpen(ctx, mod, []uint64{uint64(reqPtr), uint64(reqLen), uint64(bodyPtr), uint64(bodyLen)})[0]
+			}).
+			Export("host_http_stream_open").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID, bufPtr, bufLen uint32) int64 {
+				return int64(api.HostHTTPStreamRead(ctx, mod, []uint64{uint64(streamID), uint64(bufPtr), uint64(bufLen)})[0])
+			}).
+			Export("host_http_stream_read").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID uint32) uint32 {
+				return uint32(api.HostHTTPStreamClose(ctx, mod, []uint64{uint64(streamID)})[0])
+			}).
+			Export("host_http_stream_close").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, configPtr, configLen uint32) uint32 {
+				return uint32(api.HostHTTPSessionOpen(ctx, mod, []uint64{uint64(configPtr), uint64(configLen)})[0])
+			}).
+			Export("host_http_session_open").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, sessionID, reqPtr, reqLen, bodyPtr, bodyLen uint32) uint64 {
+				return api.HostHTTPSessionRequest(ctx, mod, []uint64{uint64(sessionID), uint64(reqPtr), uint64(reqLen), uint64(bodyPtr), uint64(bodyLen)})[0]
+			}).
+			Export("host_http_session_request").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, sessionID uint32) uint32 {
+				return uint32(api.HostHTTPSessionClose(ctx, mod, []uint64{uint64(sessionID)})[0])
+			}).
+			Export("host_http_session_close").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, sessionID, reqPtr, reqLen, bodyPtr, bodyLen uint32) uint32 {
+				return uint32(api.HostHTTPSubmit(ctx, mod, []uint64{uint64(sessionID), uint64(reqPtr), uint64(reqLen), uint64(bodyPtr), uint64(bodyLen)})[0])
+			}).
+			Export("host_http_submit").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, ticketsPtr, count, wait uint32) uint64 {
+				return api.HostHTTPWait(ctx, mod, []uint64{uint64(ticketsPtr), uint64(count), uint64(wait)})[0]
+			}).
+			Export("host_http_wait").
 			Instantiate(ctx)
 	if err != nil {
 		r.Close(ctx)
@@ -172,12 +235,24 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 		return nil, fmt.Errorf("failed to compile WASM module: %w", err)
 	}
 
+	// Threaded plugins import the memory their workers share
+	var sharedMemory wazeroapi.Module
+	if api.IsSharedMemoryModule(compiledModule) {
+		sharedMemory, err = api.InstantiateSharedMemory(ctx, r, compiledModule)
+		if err != nil {
+			r.Close(ctx)
+			return nil, err
+		}
+	}
+
 	// Instantiate the module without filesystem access
 	// WASM plugins are not allowed to access the local filesystem
 	config := wazero.NewModuleConfig().
 		WithName("plugin").
 		WithStdout(os.Stdout). // Enable stdout
-		WithStderr(os.Stderr)  // Enable stderr
+		WithStderr(os.Stderr). // Enable stderr
+		WithSysNanotime().     // Real clocks for time-based caches
+		WithSysWalltime()
 
 	module, err := r.InstantiateModule(ctx, compiledModule, config)
 	if err != nil {
@@ -209,11 +284,16 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 		}
 	}
 
-	// Close the initial module as we'll use the instance pool instead
-	module.Close(ctx)
-
 	// Create instance pool with provided configuration
-	instancePool := api.NewWASMInstancePool(ctx, r, compiledModule, pluginName, poolConfig, fs)
+	// A threaded plugin keeps the initial module, which owns the plugin its
+	// workers share; otherwise it is closed and the pool makes its own.
+	var instancePool *api.WASMInstancePool
+	if sharedMemory != nil {
+		instancePool = api.NewWASMThreadedInstancePool(ctx, r, compiledModule, sharedMemory, module, pluginName, poolConfig, fs)
+	} else {
+		module.Close(ctx)
+		instancePool = api.NewWASMInstancePool(ctx, r, compiledModule, pluginName, poolConfig, fs)
+	}
 
 	// Create WASM plugin wrapper with pool
 	wasmPlugin, err := api.NewWASMPluginWithPool(instancePool, pluginName)
@@ -301,6 +301,45 @@ func TestLocalFSReadWithOffset(t *testing.T) {
 	}
 }
 
+func TestLocalFSCopyRange(t *testing.T) {
+	dir, cleanup := setupTestDir(t)
+	defer cleanup()
+
+	fs := newTestFS(t, dir)
+	_, err := fs.Write("/src.txt", []byte("Hello, World!"), -1, filesystem.WriteFlagCreate)
+	if err != nil {
+		t.Fatalf("Initial write failed: %v", err)
+	}
+
+	// Whole file into a new file
+	n, err := fs.CopyRange("/src.txt", 0, "/dst.txt", 0, -1, filesystem.WriteFlagCreate|filesystem.WriteFlagTruncate)
+	if err != nil || n != 13 {
+		t.Fatalf("CopyRange failed: n=%d err=%v", n, err)
+	}
+	content, err := readIgnoreEOF(fs, "/dst.txt")
+	if err != nil || string(content) != "Hello, World!" {
+		t.Errorf("Content mismatch: got %q (%v)", string(content), err)
+	}
+
+	// A range into the middle, past the end of src
+	n, err = fs.CopyRange("/src.txt", 7, "/dst.txt", 0, 100, filesystem.WriteFlagNone)
+	if err != nil || n != 6 {
+		t.Fatalf("CopyRange failed: n=%d err=%v", n, err)
+	}
+	content, _ = readIgnoreEOF(fs, "/dst.txt")
+	if string(content) != "World! World!" {
+		t.Errorf("Content mismatch: got %q", string(content))
+	}
+
+	// Missing source, existing destination with EXCLUSIVE
+	if _, err := fs.CopyRange("/missing", 0, "/x", 0, -1, filesystem.WriteFlagCreate); err == nil {
+		t.Error("expected error for missing source")
+	}
+	if _, err := fs.CopyRange("/src.txt", 0, "/dst.txt", 0, -1, filesystem.WriteFlagCreate|filesystem.WriteFlagExclusive); err == nil {
+		t.Error("expected error for existing destination with EXCLUSIVE")
+	}
+}
+
 func TestLocalFSMkdir(t *testing.T) {
 	dir, cleanup := setupTestDir(t)
 	defer cleanup()